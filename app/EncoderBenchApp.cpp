@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "streamer/RTMPStreamer.hpp"
+
+// 编码器参数扫描：用合成帧测不同编码器 / preset / 线程模型 / 线程数下的吞吐与
+// 单帧编码延迟（avcodec_send_frame → 出包）。输出封装为 FLV 写到 /dev/null，
+// 写出线程照常运行，与推流时的编码路径一致。
+// 用法: encoder_bench [宽 高 [帧数 [编码器]]]，默认 1280 720 300 libx264
+// 编码器名称可用 encoder_bench list 查看
+
+namespace {
+// 合成帧：斜向移动的渐变 + 移动的噪声块，避免静止画面让编码器走捷径
+void fill_synthetic(AVFrame* frame, int index, uint32_t& seed) {
+    const int w = frame->width, h = frame->height;
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = frame->data[0] + y * frame->linesize[0];
+        for (int x = 0; x < w; ++x) row[x] = static_cast<uint8_t>(x + y + index * 4);
+    }
+    const int box = std::min(w, h) / 4;
+    const int bx = (index * 7) % std::max(1, w - box);
+    const int by = (index * 3) % std::max(1, h - box);
+    for (int y = by; y < by + box; ++y) {
+        uint8_t* row = frame->data[0] + y * frame->linesize[0];
+        for (int x = bx; x < bx + box; ++x) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            row[x] = static_cast<uint8_t>(seed);
+        }
+    }
+    for (int p = 1; p <= 2; ++p) {
+        for (int y = 0; y < h / 2; ++y) {
+            uint8_t* row = frame->data[p] + y * frame->linesize[p];
+            for (int x = 0; x < w / 2; ++x) row[x] = static_cast<uint8_t>(128 + ((x + index) & 31) - 16);
+        }
+    }
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    const size_t k = std::min(values.size() - 1, static_cast<size_t>(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+struct Result {
+    double fps = 0.0;
+    double p50 = 0.0, p95 = 0.0, max = 0.0;
+    size_t in_flight_max = 0;
+};
+
+Result run(int width, int height, int frames, const EncoderConfig& config) {
+    std::vector<double> latencies;
+    latencies.reserve(frames);
+    Result r;
+    PacketWriter<AVPacketPtr>::Options write_options;
+    write_options.max_packets = static_cast<size_t>(frames) + 16;  // 不测丢包
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        RTMPStreamer streamer(width, height, 30, "/dev/null", config, write_options);
+        streamer.SetEncodeLatencyCallback(
+            [&](int64_t, double latency_ms) { latencies.push_back(latency_ms); });
+        uint32_t seed = 2463534242u;
+        for (int i = 0; i < frames; ++i) {
+            AVFramePtr frame = streamer.AcquireFrame();
+            fill_synthetic(frame.get(), i, seed);
+            streamer.EncodeFrame(std::move(frame));
+        }
+        const auto stats = streamer.GetEncodeStats();
+        r.in_flight_max = stats.in_flight_max;
+        // 析构时冲刷编码器中缓存的帧，计入总耗时
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.fps = frames / seconds;
+    r.p50 = percentile(latencies, 0.50);
+    r.p95 = percentile(latencies, 0.95);
+    r.max = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+    return r;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "list") {
+        for (const auto& name : RTMPStreamer::AvailableEncoders()) std::cout << name << std::endl;
+        return 0;
+    }
+    const int width = argc > 2 ? std::atoi(argv[1]) : 1280;
+    const int height = argc > 2 ? std::atoi(argv[2]) : 720;
+    const int frames = argc > 3 ? std::atoi(argv[3]) : 300;
+    const std::string codec = argc > 4 ? argv[4] : "libx264";
+    if (width <= 0 || height <= 0 || width % 2 || height % 2 || frames <= 0) {
+        std::cerr << "用法: encoder_bench [宽 高 [帧数 [编码器]]] | encoder_bench list" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> thread_counts{1, 2, 4};
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    if (cores > 4) thread_counts.push_back(cores);
+    thread_counts.erase(std::remove_if(thread_counts.begin(), thread_counts.end(),
+                                       [&](int t) { return cores > 0 && t > cores; }),
+                        thread_counts.end());
+
+    std::cout << "编码器 " << codec << ", " << width << "x" << height << ", " << frames
+              << " 帧, CPU " << cores << " 核" << std::endl;
+    std::cout << std::left << std::setw(11) << "preset" << std::setw(10) << "threading"
+              << std::setw(8) << "threads" << std::right << std::setw(10) << "fps"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10)
+              << "max ms" << std::setw(11) << "in-flight" << std::endl;
+
+    auto run_row = [&](const char* label, const char* model, int threads,
+                       const EncoderConfig& config) {
+        Result r;
+        try {
+            r = run(width, height, frames, config);
+        } catch (const std::exception& e) {
+            std::cerr << "[EncoderBench] " << e.what() << std::endl;
+            return false;
+        }
+        std::cout << std::left << std::setw(11) << label << std::setw(10) << model
+                  << std::setw(8) << threads << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << r.fps << std::setprecision(2) << std::setw(10) << r.p50
+                  << std::setw(10) << r.p95 << std::setw(10) << r.max << std::setw(11)
+                  << r.in_flight_max << std::endl;
+        return true;
+    };
+
+    for (const char* preset : {"ultrafast", "superfast", "veryfast"}) {
+        for (EncoderThreading threading : {EncoderThreading::Slice, EncoderThreading::Frame}) {
+            for (int threads : thread_counts) {
+                if (threading == EncoderThreading::Frame && threads == 1) continue;
+                EncoderConfig config;
+                config.codec = codec;
+                config.preset = preset;
+                config.threading = threading;
+                config.threads = threads;
+                if (!run_row(preset, threading == EncoderThreading::Slice ? "slice" : "frame",
+                             threads, config)) {
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // 码率控制模式对编码耗时的影响（ultrafast、slice 线程、全部核）
+    std::cout << std::endl;
+    const int all_threads = thread_counts.back();
+    for (RateControl rc : {RateControl::VBV, RateControl::CBR, RateControl::CRF}) {
+        EncoderConfig config;
+        config.codec = codec;
+        config.rate_control = rc;
+        config.threads = all_threads;
+        const char* name = rc == RateControl::VBV ? "vbv" : rc == RateControl::CBR ? "cbr" : "crf";
+        if (!run_row(name, "slice", all_threads, config)) return 1;
+    }
+    return 0;
+}
@@ -1,72 +1,178 @@
 // live_display.cpp
 #include <SDL2/SDL.h>
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
 #include <string>
 #include <vector>
-#include "capture/V4L2Capture.hpp"
+#include "capture/FrameSource.hpp"
+#include "pipeline/Pipeline.hpp"
+#include "processor/FramePool.hpp"
 #include "processor/OpenCVProcessor.hpp"
+#include "queue/FrameRing.hpp"
 
-int main() {
-    const std::string VIDEO_DEVICE = "/dev/video0";
-    const OpenCVProcessor::PixelFormat FMT = OpenCVProcessor::PixelFormat::YUYV;
-    V4L2Capture capture = V4L2Capture(VIDEO_DEVICE);
-    if (!capture.initialize()) {
-        std::cerr << "摄像头初始化失败! 请检查设备权限和格式支持" << std::endl;
-        return -1;
+// 采集线程 → 处理线程 → 渲染线程之间传递的一帧
+struct DisplayFrame {
+    uint64_t seq = 0;
+    // YUYV：原始帧租约，渲染线程直接上传为 YUY2 纹理（GPU 做颜色转换），显示后归还驱动
+    FrameLease raw;
+    // MJPEG：解码得到的原画面（算法原地修改前的拷贝）
+    cv::Mat raw_rgb;
+    cv::Mat processed;  // 算法处理后的 RGB
+};
+
+// 帧源通过环境变量选择，默认 /dev/video0：
+//   VISION_SOURCE=synthetic | synthetic:static | replay:<文件> | <设备路径>
+//   VISION_SOURCE_PACING=realtime | fixed | unpaced
+//   VISION_SOURCE_FPS=<帧率>（合成/回放源，默认 30）
+//   VISION_SOURCE_FRAMES=<帧数>（交付这么多帧后退出）
+//   VISION_CAPTURE_LATEST=1（摄像头低延迟模式：每次只显示最新完成的帧，积压的旧帧直接丢弃）
+static std::unique_ptr<FrameSource> open_source_from_env(FrameSourceOptions& options) {
+    const char* spec_env = std::getenv("VISION_SOURCE");
+    const std::string spec = spec_env ? spec_env : "/dev/video0";
+    if (const char* pacing_env = std::getenv("VISION_SOURCE_PACING")) {
+        if (!parse_pacing(pacing_env, options.pacing)) {
+            std::cerr << "未知的 VISION_SOURCE_PACING: " << pacing_env
+                      << "（可选 realtime / fixed / unpaced）" << std::endl;
+            return nullptr;
+        }
+    }
+    if (const char* fps_env = std::getenv("VISION_SOURCE_FPS")) options.fps = std::atof(fps_env);
+    if (const char* frames_env = std::getenv("VISION_SOURCE_FRAMES")) {
+        options.frame_limit = std::strtoull(frames_env, nullptr, 10);
+    }
+    std::unique_ptr<FrameSource> source;
+    try {
+        source = open_frame_source(spec, options);
+    } catch (const std::exception& e) {
+        std::cerr << "打开帧源 " << spec << " 失败: " << e.what() << std::endl;
+        return nullptr;
     }
-    const int width_ = capture.get_width();
-    const int height_ = capture.get_height();
-    OpenCVProcessor processor = OpenCVProcessor(FMT, width_, height_);
+    if (const char* latest_env = std::getenv("VISION_CAPTURE_LATEST");
+        latest_env && std::string(latest_env) != "0" && !source->set_latest_frame_mode(true)) {
+        std::cerr << "帧源 " << spec << " 不支持 VISION_CAPTURE_LATEST，已忽略" << std::endl;
+    }
+    return source;
+}
 
+// 一个窗口及其渲染器、纹理。纹理格式固定，尺寸与帧相同
+struct DisplayWindow {
+    SDL_Window* window = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    SDL_Texture* texture = nullptr;
 
-    // 初始化 SDL
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL 初始化失败: " << SDL_GetError() << std::endl;
-        return -1;
-    }
-    // 创建双窗口
-    const int window_number = 2;
-    SDL_Window* windows[window_number];
-    SDL_Renderer* renderers[window_number];
-    SDL_Texture* textures[window_number];
-    std::vector<std::string> title = {"原画面", "处理画面"};
-    for(int i = 0; i < window_number; ++i) {
-        windows[i] = SDL_CreateWindow(title[i].c_str(), 
-            SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-            width_, height_, SDL_WINDOW_SHOWN);
-        if (!windows[i]) {
+    bool create(const char* title, int width, int height, Uint32 pixel_format) {
+        window = SDL_CreateWindow(title, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                  width, height, SDL_WINDOW_SHOWN);
+        if (!window) {
             std::cerr << "窗口创建失败: " << SDL_GetError() << std::endl;
-            SDL_Quit();
-            return -1;
+            return false;
         }
-        renderers[i] = SDL_CreateRenderer(windows[i], -1, SDL_RENDERER_ACCELERATED);
-        if (!renderers[i]) {
+        // dummy / offscreen 等无头驱动没有硬件加速渲染器，退回软件渲染
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        if (!renderer) renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
+        if (!renderer) {
             std::cerr << "渲染器创建失败: " << SDL_GetError() << std::endl;
-            SDL_DestroyWindow(windows[i]);
-            SDL_Quit();
-            return -1;
+            return false;
         }
-        textures[i] = SDL_CreateTexture(renderers[i],
-            SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING,
-            width_, height_);
-        if (!textures[i]) {
+        texture = SDL_CreateTexture(renderer, pixel_format, SDL_TEXTUREACCESS_STREAMING,
+                                    width, height);
+        if (!texture) {
             std::cerr << "纹理创建失败: " << SDL_GetError() << std::endl;
-            SDL_DestroyRenderer(renderers[i]);
-            SDL_DestroyWindow(windows[i]);
-            SDL_Quit();
-            return -1;
-        } 
-   }
-    // 主循环
-    bool quit = false;
+            return false;
+        }
+        return true;
+    }
+
+    void present(const void* pixels, int pitch) {
+        SDL_UpdateTexture(texture, nullptr, pixels, pitch);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+        SDL_RenderPresent(renderer);
+    }
+
+    ~DisplayWindow() {
+        if (texture) SDL_DestroyTexture(texture);
+        if (renderer) SDL_DestroyRenderer(renderer);
+        if (window) SDL_DestroyWindow(window);
+    }
+};
+
+// 采集、处理、渲染各在一个线程：
+// - 采集线程（流水线的源）阻塞在帧源上，按采集时钟出帧；
+// - 处理线程每帧只解码一次、运行一次算法；
+// - 渲染线程（主线程，SDL 要求窗口与事件在创建它们的线程中处理）只显示最新处理完的帧，
+//   处理跟不上时中间的帧直接跳过，界面与事件响应不会被采集或处理阻塞。
+// YUYV 的原画面直接上传为 SDL_PIXELFORMAT_YUY2 纹理，不在 CPU 上做颜色转换。
+// 返回进程退出码
+static int run_display(FrameSource& capture, Pacing pacing, OpenCVProcessor::PixelFormat fmt,
+                       const std::string& algorithm) {
+    const bool yuyv = fmt == OpenCVProcessor::PixelFormat::YUYV;
+    const int width = capture.get_width();
+    const int height = capture.get_height();
+    // 创建双窗口
+    DisplayWindow raw_window, processed_window;
+    if (!raw_window.create("原画面", width, height,
+                           yuyv ? SDL_PIXELFORMAT_YUY2 : SDL_PIXELFORMAT_RGB24) ||
+        !processed_window.create("处理画面", width, height, SDL_PIXELFORMAT_RGB24)) {
+        return -1;
+    }
+
+    FramePool& framePool = FramePool::shared();
+    // 处理完的帧交给渲染线程；渲染跟不上时丢弃最旧的，只保留最新的帧
+    BoundedRing<DisplayFrame> display_queue(2, OverflowPolicy::DropOldest);
+    std::atomic<bool> quit{false};
+    std::atomic<bool> source_done{false};
+
+    Pipeline<DisplayFrame> pipeline("capture", [&](DisplayFrame& f) {
+        while (!quit && !capture.finished()) {
+            f.raw = capture.acquire_frame(200);
+            if (f.raw) return true;
+        }
+        source_done = true;
+        return false;
+    });
+    // 处理跟不上采集时丢弃最旧的帧，处理的总是最新画面；
+    // unpaced 帧源用于测吞吐，改为阻塞采集，让处理决定速度而不是大量丢帧
+    const OverflowPolicy policy =
+        pacing == Pacing::Unpaced ? OverflowPolicy::Block : OverflowPolicy::DropOldest;
+    pipeline.add_stage_per_worker({"process", 1, false, 2, policy}, [&] {
+        // OpenCVProcessor 持有中间缓冲区，每个工作线程一份
+        auto processor = std::make_shared<OpenCVProcessor>(fmt, width, height);
+        if (!algorithm.empty()) processor->set_algorithm(algorithm);
+        return [&, processor](DisplayFrame& f) {
+            if (yuyv && f.raw->bytesused < static_cast<size_t>(width) * height * 2) {
+                return false;  // 不完整的帧
+            }
+            // 只解码一次：MJPEG 的原画面是算法修改前的拷贝，YUYV 的原画面直接用租约
+            f.processed = framePool.acquire(height, width, CV_8UC3);
+            if (!processor->Decode2RGB(f.raw->data, f.raw->bytesused, f.processed)) {
+                return false;
+            }
+            if (!yuyv) {
+                f.raw_rgb = framePool.acquire(height, width, CV_8UC3);
+                f.processed.copyTo(f.raw_rgb);
+                f.raw.reset();  // 尽快把缓冲区还给驱动
+            }
+            processor->apply_algorithm(f.processed);
+            display_queue.push(std::move(f));
+            return true;
+        };
+    });
+    pipeline.start();
+
     SDL_Event event;
-    std::vector<uint8_t> frameBuffer;
-    cv::Mat RGBFrame;
+    uint64_t frames = 0;    // 已显示的帧数
+    uint64_t replaced = 0;  // 渲染前就被更新的帧替换、没有显示的帧数
+    const auto started = std::chrono::steady_clock::now();
     while (!quit) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 quit = true;
-            } 
+            }
             // 添加 ESC 按键检测
             else if (event.type == SDL_KEYDOWN) {
                 if (event.key.keysym.sym == SDLK_ESCAPE) {
@@ -74,42 +180,91 @@ int main() {
                 }
             }
         }
-
-        // 捕获帧
-        if (!capture.capture_frame(frameBuffer)) {
-            std::cerr << "帧捕获失败" << std::endl;
-            continue;
+        // 源结束后等流水线处理完剩余的帧，显示最后一帧再退出
+        if (source_done) {
+            pipeline.wait();
+            quit = true;
         }
-
-        // 处理帧
-        if (!processor.Decode2RGB(frameBuffer, RGBFrame)) {
-            std::cerr << "解码失败" << std::endl;
-            continue;
+        // 最多等 10ms，事件处理保持及时；取到帧后跳到队列中最新的一帧
+        DisplayFrame frame;
+        if (!display_queue.pop_for(frame, std::chrono::milliseconds(10))) continue;
+        DisplayFrame newer;
+        while (display_queue.try_pop(newer)) {
+            frame = std::move(newer);
+            ++replaced;
         }
-    
-        // 更新原始窗口
-        SDL_UpdateTexture(textures[0], NULL, RGBFrame.data, RGBFrame.step);
-        SDL_RenderClear(renderers[0]);
-        SDL_RenderCopy(renderers[0], textures[0], NULL, NULL);
-        SDL_RenderPresent(renderers[0]);
+        if (yuyv) {
+            raw_window.present(frame.raw->data, width * 2);
+        } else {
+            raw_window.present(frame.raw_rgb.data, static_cast<int>(frame.raw_rgb.step));
+        }
+        processed_window.present(frame.processed.data, static_cast<int>(frame.processed.step));
+        ++frames;
+    }
+    pipeline.stop();
+    pipeline.wait();
 
-        // 处理并更新处理窗口
-        processor.apply_algorithm(RGBFrame);
-        if (processor.Decode2RGB(frameBuffer, RGBFrame)) {
-            processor.apply_algorithm(RGBFrame);
-            SDL_UpdateTexture(textures[1], NULL, RGBFrame.data, RGBFrame.step);
-            SDL_RenderClear(renderers[1]);
-            SDL_RenderCopy(renderers[1], textures[1], NULL, NULL);
-            SDL_RenderPresent(renderers[1]);
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    for (const auto& s : pipeline.stats()) {
+        std::cout << "[Pipeline] " << s.name << ": " << s.processed << " 帧, 忙碌 " << std::fixed
+                  << std::setprecision(0) << s.utilization * 100 << "%, 单帧 p50 "
+                  << std::setprecision(2) << s.latency_ms.p50 << " ms";
+        if (s.queue_drops) std::cout << ", 处理不及丢弃 " << s.queue_drops;
+        std::cout << std::endl;
+    }
+    if (elapsed > 0) {
+        std::cout << "共显示 " << frames << " 帧，平均 " << std::fixed << std::setprecision(1)
+                  << frames / elapsed << " fps";
+        if (replaced) std::cout << "，渲染不及跳过 " << replaced << " 帧";
+        if (capture.stale_dropped()) {
+            std::cout << "，低延迟模式丢弃旧帧 " << capture.stale_dropped();
         }
+        std::cout << std::endl;
     }
+    return 0;
+}
+
+// 无头测帧率：SDL_VIDEODRIVER=dummy（或 offscreen）VISION_SOURCE=synthetic
+// VISION_SOURCE_PACING=unpaced VISION_SOURCE_FRAMES=<帧数>，没有显示器也能运行
+int main() {
+    // 像素格式通过环境变量 VISION_PIXEL_FORMAT 选择（yuyv / mjpeg），默认 YUYV
+    const char* format_env = std::getenv("VISION_PIXEL_FORMAT");
+    const bool request_mjpeg = format_env && std::string(format_env) == "mjpeg";
+    FrameSourceOptions source_options;
+    std::unique_ptr<FrameSource> capture = open_source_from_env(source_options);
+    if (!capture) return -1;
+    // 处理队列、处理线程与渲染队列中的 YUYV 帧都持有租约，留出余量给驱动继续采集
+    capture->set_buffer_count(8);
+    capture->set_pixel_format(request_mjpeg ? V4L2_PIX_FMT_MJPEG : V4L2_PIX_FMT_YUYV);
+    if (!capture->initialize()) {
+        std::cerr << "帧源初始化失败! 请检查设备权限和格式支持" << std::endl;
+        return -1;
+    }
+    std::cout << "[FrameSource] " << capture->describe() << std::endl;
+    // 回放源的格式与分辨率以文件为准
+    const OpenCVProcessor::PixelFormat FMT = capture->get_pixel_format() == V4L2_PIX_FMT_MJPEG
+                                                 ? OpenCVProcessor::PixelFormat::MJPEG
+                                                 : OpenCVProcessor::PixelFormat::YUYV;
+    // 算法链通过环境变量 VISION_ALGORITHM 按名字选择，未设置时使用默认的 Canny
+    const char* algorithm_env = std::getenv("VISION_ALGORITHM");
+    const std::string ALGORITHM = algorithm_env ? algorithm_env : "";
+    if (!ALGORITHM.empty() && !FilterChain::create(ALGORITHM)) {
+        std::cerr << "未知的算法链: " << ALGORITHM << "，可选:";
+        for (const auto& name : FilterChain::names()) std::cerr << " " << name;
+        std::cerr << std::endl;
+        return -1;
+    }
+    std::cout << "处理算法: " << (ALGORITHM.empty() ? "canny (opencv)" : ALGORITHM) << std::endl;
 
-    // 清理资源
-    for (int i = 0; i < window_number; ++i) {
-        SDL_DestroyTexture(textures[i]);
-        SDL_DestroyRenderer(renderers[i]);
-        SDL_DestroyWindow(windows[i]);
+    // 初始化 SDL
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL 初始化失败: " << SDL_GetError() << std::endl;
+        return -1;
     }
+    std::cout << "[SDL] 视频驱动: " << SDL_GetCurrentVideoDriver() << std::endl;
+    // 窗口在 run_display 返回前销毁，之后才能 SDL_Quit
+    const int ret = run_display(*capture, source_options.pacing, FMT, ALGORITHM);
     SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+    return ret;
+}
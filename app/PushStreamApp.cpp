@@ -1,71 +1,807 @@
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
-#include "capture/V4L2Capture.hpp"
+#include "capture/FrameSource.hpp"
+#include "capture/RawCapture.hpp"
+#include "pipeline/LoadGovernor.hpp"
+#include "pipeline/MetricsExporter.hpp"
+#include "pipeline/Pipeline.hpp"
+#include "pipeline/Tracer.hpp"
+#include "processor/FramePool.hpp"
+#include "processor/MotionGate.hpp"
 #include "processor/OpenCVProcessor.hpp"
 #include "streamer/RTMPStreamer.hpp"
-#include "queue/ThreadSafeQueue.hpp"  // 假设你之前的线程安全队列文件叫这个
+#include "streamer/SegmentRecorder.hpp"
+#include "streamer/SimulcastStreamer.hpp"
+
+static std::atomic<bool> g_running{true};
+static std::atomic<bool> g_event{false};
+
+static void handle_signal(int) { g_running = false; }
+// kill -USR1 <pid> 触发一次事件录像
+static void handle_event(int) { g_event = true; }
+
+// 在流水线各阶段之间流动的一帧
+struct StreamFrame {
+    uint64_t seq = 0;
+    FrameLease raw;       // 采集得到的驱动缓冲区，解码后立即归还
+    // 驱动帧序号与采集时间，raw 归还后仍随帧传到编码器
+    uint32_t sequence = 0;
+    int64_t capture_ns = 0;
+    cv::Mat rgb;          // 解码/算法处理后的 RGB 帧（池化内存）
+    AVFramePtr yuv;       // 送入编码器的 YUV420P 帧（池化内存）
+    // 运动检测判定为静止：跳过解码/算法/转换，编码阶段重复上一次的输出
+    bool repeat = false;
+    // 运动检测判定为变化的帧的编号；静止帧带着它所沿用的那个变化帧的编号
+    uint64_t gate_epoch = 0;
+};
+
+// 作用域内的耗时计入运动检测的 CPU 统计：变化帧的处理耗时，或静止帧仍然产生的开销。
+// gate 为空（未开启运动检测）时什么也不做
+class MotionCost {
+public:
+    explicit MotionCost(MotionGate* gate, bool overhead = false)
+        : gate_(gate), overhead_(overhead),
+          start_(gate ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+    ~MotionCost() {
+        if (!gate_) return;
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+        overhead_ ? gate_->record_overhead(ns) : gate_->record_processing(ns);
+    }
+    MotionCost(const MotionCost&) = delete;
+    MotionCost& operator=(const MotionCost&) = delete;
+
+private:
+    MotionGate* gate_;
+    bool overhead_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+static void print_stats(const std::vector<Pipeline<StreamFrame>::StageStats>& stats) {
+    std::cout << "[Pipeline]";
+    for (const auto& s : stats) {
+        std::cout << " " << s.name << "(x" << s.workers << "): "
+                  << s.processed << " 帧, 忙碌 " << std::fixed << std::setprecision(0)
+                  << s.utilization * 100 << "%, 队列 " << s.queue_depth << "/"
+                  << s.queue_high_water;
+        if (s.queue_drops) std::cout << ", 溢出 " << s.queue_drops;
+        if (s.reorder_pending) std::cout << ", 待重排 " << s.reorder_pending;
+        std::cout << ";";
+    }
+    std::cout << std::endl;
+}
+
+// stale 为低延迟模式下在采集时就丢弃的旧帧，已包含在 skipped 中（驱动序号跳号）
+static void print_skipped(uint64_t skipped, uint64_t stale) {
+    std::cout << "[Pipeline] 未送达编码器的采集帧 " << skipped;
+    if (stale) std::cout << "（其中低延迟模式丢弃的旧帧 " << stale << "）";
+    std::cout << std::endl;
+}
+
+static void print_writer_stats(const PacketWriter<AVPacketPtr>::Stats& s) {
+    std::cout << "[RTMPStreamer] 已发送 " << s.written << " 包, 队列 " << s.queue_depth
+              << "/" << s.queue_high_water << " (" << s.queue_bytes / 1024 << " KiB), 发送 "
+              << std::fixed << std::setprecision(1) << s.send_ms_avg << "/" << s.send_ms_max
+              << " ms (平均/最大), 排队 " << s.queue_ms_avg << "/" << s.queue_ms_max << " ms";
+    if (s.dropped_packets) {
+        std::cout << ", 丢弃 " << s.dropped_packets << " 包 / " << s.dropped_gops << " GOP";
+    }
+    if (s.write_errors) std::cout << ", 写出失败 " << s.write_errors;
+    std::cout << std::endl;
+}
+
+// 采集→包写出延迟（最近 1024 帧）
+static void print_capture_latency(const std::string& tag, const LatencyWindow::Summary& s) {
+    if (!s.window) return;
+    std::cout << tag << " 采集→写出 " << std::fixed << std::setprecision(1) << "p50 " << s.p50
+              << " / p90 " << s.p90 << " / p99 " << s.p99 << " / max " << s.max << " ms"
+              << std::endl;
+}
+
+static void print_recorder_stats(const SegmentRecorder::Stats& s) {
+    std::cout << "[SegmentRecorder] 缓冲 " << std::fixed << std::setprecision(1)
+              << s.ring_seconds << " s / " << s.ring_packets << " 包 (" << s.ring_bytes / 1024
+              << " KiB), " << (s.recording ? "录制中" : "空闲") << ", 事件 " << s.events
+              << ", 分段 " << s.segments << ", 已写 " << s.bytes_written / 1024 << " KiB";
+    if (s.queue.dropped_packets) std::cout << ", 丢弃 " << s.queue.dropped_packets << " 包";
+    if (s.write_errors) std::cout << ", 写出失败 " << s.write_errors;
+    std::cout << std::endl;
+}
+
+static void print_motion_stats(const MotionGate& gate) {
+    const auto s = gate.stats();
+    std::cout << "[MotionGate] 检测 " << s.frames << " 帧, 静止跳过 " << s.static_frames
+              << " 帧 (" << std::fixed << std::setprecision(0)
+              << (s.frames ? 100.0 * s.static_frames / s.frames : 0.0) << "%), 强制刷新 "
+              << s.refreshes << ", 检测 " << std::setprecision(2) << s.detect_ms_avg
+              << " ms/帧, 处理 " << s.process_ms_avg << " ms/帧, 节省 CPU 约 "
+              << std::setprecision(1) << s.cpu_saved_ms / 1000.0 << " s" << std::endl;
+}
+
+static void print_output_stats(const RTMPStreamer* streamer,
+                               const SimulcastStreamer* simulcast,
+                               const SegmentRecorder* recorder) {
+    if (recorder) print_recorder_stats(recorder->GetStats());
+    if (streamer) {
+        const auto e = streamer->GetEncodeStats();
+        std::cout << "[RTMPStreamer] 编码 " << e.frames << " 帧, 延迟 " << std::fixed
+                  << std::setprecision(2) << e.latency_ms_avg << "/" << e.latency_ms_max
+                  << " ms (平均/最大), 编码器缓存 " << e.in_flight_max << " 帧";
+        if (e.repeated || e.repeat_skipped) {
+            std::cout << ", 静止重复 " << e.repeated << " 帧 / 跳过 " << e.repeat_skipped << " 帧";
+        }
+        std::cout << std::endl;
+        print_writer_stats(streamer->GetWriterStats());
+        print_capture_latency("[RTMPStreamer]", streamer->GetCaptureLatency());
+    }
+    if (!simulcast) return;
+    for (const auto& rung : simulcast->GetStats()) {
+        std::cout << "[SimulcastStreamer] " << rung.name << " " << rung.frames << " 帧 (重复 "
+                  << rung.repeated << "), 缩放 "
+                  << std::fixed << std::setprecision(2) << rung.scale_ms_avg << " ms, 编码 "
+                  << rung.encode_ms_avg << " ms, 队列 " << rung.queue_depth << std::endl;
+        print_writer_stats(rung.writer);
+        print_capture_latency("[SimulcastStreamer] " + rung.name, rung.capture_latency);
+    }
+}
+
+static void print_governor_stats(const LoadGovernor& governor) {
+    const auto s = governor.stats();
+    std::cout << "[LoadGovernor] 级别 " << LoadGovernor::level_name(s.level) << ", 负载 "
+              << std::fixed << std::setprecision(2) << s.load;
+    if (!s.bottleneck.empty()) std::cout << " (" << s.bottleneck << ")";
+    std::cout << ", 切换 " << s.transitions << " 次, 停留";
+    for (int i = 0; i < LoadGovernor::kLevelCount; ++i) {
+        std::cout << " " << LoadGovernor::level_name(static_cast<LoadGovernor::Level>(i)) << " "
+                  << std::setprecision(1) << s.level_seconds[i] << " s";
+    }
+    std::cout << std::endl;
+}
+
+// 流水线统计转换为 LoadGovernor 的输入。源阶段的忙碌时间主要是阻塞等待驱动，不参与
+static std::vector<LoadGovernor::StageSample> governor_samples(
+    const std::vector<Pipeline<StreamFrame>::StageStats>& stats) {
+    std::vector<LoadGovernor::StageSample> samples;
+    for (size_t i = 1; i < stats.size(); ++i) {
+        samples.push_back({stats[i].name, stats[i].workers, stats[i].busy_ms, stats[i].processed});
+    }
+    return samples;
+}
+
+// 各路推流的写出指标；同一指标的所有样本必须连续，因此按指标而不是按输出循环
+struct OutputMetrics {
+    std::string labels;  // 例如 output="720p"
+    PacketWriter<AVPacketPtr>::Stats writer;
+    LatencyWindow::Summary capture_latency;
+};
+
+static void collect_writer_metrics(MetricsText& m, const std::vector<OutputMetrics>& outputs) {
+    for (const auto& o : outputs) {
+        m.counter("vision_packets_written_total", "Packets written to the output",
+                  o.writer.written, o.labels);
+    }
+    for (const auto& o : outputs) {
+        m.counter("vision_packets_dropped_total", "Packets dropped by GOP-aware backpressure",
+                  o.writer.dropped_packets, o.labels);
+    }
+    for (const auto& o : outputs) {
+        m.gauge("vision_writer_queue_depth", "Packets waiting in the writer queue",
+                o.writer.queue_depth, o.labels);
+    }
+    for (const auto& o : outputs) {
+        m.summary("vision_capture_to_write_ms", "Capture to packet written latency (ms)",
+                  o.capture_latency, o.labels);
+    }
+}
+
+// 帧源通过环境变量选择，默认 /dev/video0：
+//   VISION_SOURCE=synthetic | synthetic:static | replay:<文件> | <设备路径>
+//   （replay 可以是裸转储，也可以是 VISION_CAPTURE_RECORD 录制的文件）
+//   VISION_SOURCE_PACING=realtime | fixed | unpaced（unpaced 用于测最大吞吐）
+//   VISION_SOURCE_FPS=<帧率>（合成/回放源，默认 30）
+//   VISION_SOURCE_FRAMES=<帧数>（交付这么多帧后结束；回放源不足时循环）
+//   VISION_CAPTURE_LATEST=1（摄像头低延迟模式：每次只取最新完成的帧，积压的旧帧直接丢弃）
+static std::unique_ptr<FrameSource> open_source_from_env(FrameSourceOptions& options) {
+    const char* spec_env = std::getenv("VISION_SOURCE");
+    const std::string spec = spec_env ? spec_env : "/dev/video0";
+    if (const char* pacing_env = std::getenv("VISION_SOURCE_PACING")) {
+        if (!parse_pacing(pacing_env, options.pacing)) {
+            std::cerr << "未知的 VISION_SOURCE_PACING: " << pacing_env
+                      << "（可选 realtime / fixed / unpaced）" << std::endl;
+            return nullptr;
+        }
+    }
+    if (const char* fps_env = std::getenv("VISION_SOURCE_FPS")) options.fps = std::atof(fps_env);
+    if (const char* frames_env = std::getenv("VISION_SOURCE_FRAMES")) {
+        options.frame_limit = std::strtoull(frames_env, nullptr, 10);
+    }
+    std::unique_ptr<FrameSource> source;
+    try {
+        source = open_frame_source(spec, options);
+    } catch (const std::exception& e) {
+        std::cerr << "打开帧源 " << spec << " 失败: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (const char* latest_env = std::getenv("VISION_CAPTURE_LATEST");
+        latest_env && std::string(latest_env) != "0" && !source->set_latest_frame_mode(true)) {
+        std::cerr << "帧源 " << spec << " 不支持 VISION_CAPTURE_LATEST，已忽略" << std::endl;
+    }
+    return source;
+}
 
 int main() {
-    const std::string VIDEO_DEVICE = "/dev/video0";
-    const OpenCVProcessor::PixelFormat FMT = OpenCVProcessor::PixelFormat::YUYV;
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+    std::signal(SIGUSR1, handle_event);
+
+    // 像素格式通过环境变量 VISION_PIXEL_FORMAT 选择（yuyv / mjpeg），默认 YUYV；
+    // 1080p 下大多数 USB 摄像头只有 MJPEG 能跑满帧率
+    const char* format_env = std::getenv("VISION_PIXEL_FORMAT");
+    const bool request_mjpeg = format_env && std::string(format_env) == "mjpeg";
+    // 解码与算法阶段的并行工作线程数
+    const unsigned DECODE_WORKERS = 2;
+    const unsigned ALGORITHM_WORKERS = 2;
+    // YUV 直通：YUYV 直接拆分、MJPEG 直接解码为编码器的 YUV420P，算法只在 Y 平面上运行，
+    // 省去 →RGB 与 RGB→YUV420P 两次整帧转换
+    const bool YUV_DIRECT = true;
+    // 算法链通过环境变量 VISION_ALGORITHM 按名字选择，未设置时使用默认的 Canny
+    const char* algorithm_env = std::getenv("VISION_ALGORITHM");
+    const std::string ALGORITHM = algorithm_env ? algorithm_env : "";
+    if (!ALGORITHM.empty() && !FilterChain::create(ALGORITHM)) {
+        std::cerr << "未知的算法链: " << ALGORITHM << "，可选:";
+        for (const auto& name : FilterChain::names()) std::cerr << " " << name;
+        std::cerr << std::endl;
+        return -1;
+    }
 
-    V4L2Capture capture(VIDEO_DEVICE);
-    if (!capture.initialize()) {
-        std::cerr << "摄像头初始化失败! 请检查设备权限和格式支持" << std::endl;
+    FrameSourceOptions source_options;
+    std::unique_ptr<FrameSource> capture = open_source_from_env(source_options);
+    if (!capture) return -1;
+    // 流水线中同时在途的原始帧最多为解码队列容量 + 解码线程数，
+    // 再留出余量给驱动继续采集
+    capture->set_buffer_count(8);
+    capture->set_pixel_format(request_mjpeg ? V4L2_PIX_FMT_MJPEG : V4L2_PIX_FMT_YUYV);
+    if (!capture->initialize()) {
+        std::cerr << "帧源初始化失败! 请检查设备权限和格式支持" << std::endl;
         return -1;
     }
+    std::cout << "[FrameSource] " << capture->describe() << std::endl;
 
-    const int width  = capture.get_width();
-    const int height = capture.get_height();
-    OpenCVProcessor processor(FMT, width, height);
+    // 回放源的格式与分辨率以文件为准
+    const OpenCVProcessor::PixelFormat FMT = capture->get_pixel_format() == V4L2_PIX_FMT_MJPEG
+                                                 ? OpenCVProcessor::PixelFormat::MJPEG
+                                                 : OpenCVProcessor::PixelFormat::YUYV;
+    const int width  = capture->get_width();
+    const int height = capture->get_height();
 
     // 推流器初始化
-    char output_url[] = "rtmp://192.168.217.130/live/stream";
-    RTMPStreamer streamer(width, height, 30, output_url);
-    std::cout << "[RTMPStreamer] 初始化完成，开始推流到: " << output_url << std::endl;
-
-    // 线程安全帧队列
-    ThreadSafeQueue<cv::Mat> frameQueue;
-
-    // --- 推流线程 ---
-    std::thread streaming_thread([&]() {
-        while (true) {
-            cv::Mat frame;
-            if (frameQueue.pop(frame)) {  // 阻塞直到取出一帧
-                streamer.PushFrame(frame);
+    // VISION_OUTPUT 可改为本地文件（例如 /dev/null，无头测吞吐时不依赖推流服务器）
+    const char* output_env = std::getenv("VISION_OUTPUT");
+    const std::string output_url = output_env ? output_env : "rtmp://192.168.217.130/live/stream";
+    // 设置 VISION_SIMULCAST=<地址前缀> 时同时推 1080p/720p/360p 多路
+    // （只保留不高于采集分辨率的级别），各路地址为 <前缀>_720p 等
+    // 录像器先于推流器声明：推流器析构时冲刷编码器，仍可能把包交给录像器
+    std::unique_ptr<SegmentRecorder> recorder;
+    std::unique_ptr<RTMPStreamer> streamer;
+    std::unique_ptr<SimulcastStreamer> simulcast;
+    if (const char* simulcast_prefix = std::getenv("VISION_SIMULCAST")) {
+        simulcast = std::make_unique<SimulcastStreamer>(
+            width, height, 30, SimulcastStreamer::DefaultLadder(simulcast_prefix, width, height));
+        std::cout << "[SimulcastStreamer] 初始化完成" << std::endl;
+    } else {
+        // 编码器可通过环境变量调整：VISION_ENCODER（编码器名称）、
+        // VISION_ENCODER_THREADS（0 为按核数自动）、VISION_ENCODER_THREADING（slice / frame）
+        EncoderConfig encoder_config;
+        if (const char* codec_env = std::getenv("VISION_ENCODER")) encoder_config.codec = codec_env;
+        if (const char* threads_env = std::getenv("VISION_ENCODER_THREADS")) {
+            encoder_config.threads = std::atoi(threads_env);
+        }
+        if (const char* threading_env = std::getenv("VISION_ENCODER_THREADING")) {
+            encoder_config.threading = std::string(threading_env) == "frame"
+                                           ? EncoderThreading::Frame
+                                           : EncoderThreading::Slice;
+        }
+        // VISION_ENCODER_REPEAT_MS：画面静止时重复帧的心跳间隔（见 VISION_MOTION_GATE）
+        if (const char* repeat_env = std::getenv("VISION_ENCODER_REPEAT_MS")) {
+            encoder_config.repeat_interval_ms = std::atoi(repeat_env);
+        }
+        streamer = std::make_unique<RTMPStreamer>(width, height, 30, output_url.c_str(),
+                                                  encoder_config);
+        std::cout << "[RTMPStreamer] 初始化完成，开始推流到: " << output_url << std::endl;
+    }
+
+    // 设置 VISION_RECORD_DIR 时把编码包旁路到本地录像（多路输出时录最高一级），不重新编码：
+    // 默认只缓冲事件前 10 秒，收到 SIGUSR1 时写出缓冲并继续录 10 秒；
+    // VISION_RECORD_MODE=continuous 持续录制，=hls / mp4 选择封装（默认 fMP4）
+    if (const char* record_dir = std::getenv("VISION_RECORD_DIR")) {
+        const char* mode_env = std::getenv("VISION_RECORD_MODE");
+        const std::string mode = mode_env ? mode_env : "";
+        RecorderConfig record_config;
+        record_config.output_dir = record_dir;
+        record_config.continuous = mode.find("continuous") != std::string::npos;
+        if (mode.find("hls") != std::string::npos) {
+            record_config.format = RecordFormat::HLS;
+            record_config.segment_seconds = 6.0;
+        } else if (mode.find("mp4") != std::string::npos &&
+                   mode.find("fmp4") == std::string::npos) {
+            record_config.format = RecordFormat::MP4;
+        }
+        RTMPStreamer& source = simulcast ? simulcast->GetRungStreamer(0) : *streamer;
+        recorder = std::make_unique<SegmentRecorder>(source.GetCodecParameters(),
+                                                     source.GetPacketTimeBase(), record_config);
+        source.SetRecorder(recorder.get());
+        std::cout << "[SegmentRecorder] 录像目录: " << record_dir
+                  << (record_config.continuous ? "（持续录制）" : "（SIGUSR1 触发）") << std::endl;
+    }
+
+    // 设置 VISION_CAPTURE_RECORD=<文件> 时把采集到的原始帧无损录下来，
+    // 之后可用 VISION_SOURCE=replay:<文件> 按原始时间回放复现问题
+    std::unique_ptr<RawCaptureWriter> capture_recorder;
+    if (const char* capture_record = std::getenv("VISION_CAPTURE_RECORD")) {
+        try {
+            capture_recorder = std::make_unique<RawCaptureWriter>(
+                capture_record, capture->get_pixel_format(), width, height);
+            std::cout << "[RawCaptureWriter] 原始帧录制到 " << capture_record << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // 设置 VISION_MOTION_GATE=1 时在采集线程中做静止检测（YUYV 直接读亮度，MJPEG 按 1/8 解码亮度），
+    // 静止帧跳过解码、算法与颜色转换，编码器只发重复帧或不编码：
+    //   VISION_MOTION_THRESHOLD=<块均值亮度差，默认 6>
+    //   VISION_MOTION_MIN_AREA=<变化块比例，默认 0.002>
+    //   VISION_MOTION_REFRESH=<连续静止多少帧后强制处理一帧，默认 300>
+    //   VISION_MOTION_REGIONS / VISION_MOTION_IGNORE=x,y,w,h;...（只检测 / 忽略的区域）
+    std::unique_ptr<MotionGate> motion_gate;
+    if (const char* gate_env = std::getenv("VISION_MOTION_GATE");
+        gate_env && std::string(gate_env) != "0") {
+        MotionGate::Options gate_options;
+        if (const char* v = std::getenv("VISION_MOTION_THRESHOLD")) {
+            gate_options.threshold = std::atoi(v);
+        }
+        if (const char* v = std::getenv("VISION_MOTION_MIN_AREA")) {
+            gate_options.min_changed = std::atof(v);
+        }
+        if (const char* v = std::getenv("VISION_MOTION_REFRESH")) {
+            gate_options.refresh_frames = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        }
+        motion_gate = std::make_unique<MotionGate>(width, height, gate_options);
+        std::vector<MotionRegion> regions;
+        for (const char* name : {"VISION_MOTION_REGIONS", "VISION_MOTION_IGNORE"}) {
+            const char* v = std::getenv(name);
+            if (!v) continue;
+            if (!parse_motion_regions(v, regions)) {
+                std::cerr << "无法解析 " << name << "=" << v << "（格式 x,y,w,h;x,y,w,h）" << std::endl;
+                return -1;
+            }
+            if (std::string(name) == "VISION_MOTION_REGIONS") {
+                motion_gate->set_regions(regions);
+            } else {
+                motion_gate->set_ignore_regions(regions);
             }
         }
+        std::cout << "[MotionGate] 已启用，缩略图 " << motion_gate->thumb_width() << "x"
+                  << motion_gate->thumb_height() << "，阈值 " << gate_options.threshold << std::endl;
+    }
+    // 设置 VISION_GOVERNOR=1 时按帧期限分级降载（见 LoadGovernor），负载回落后逐级恢复：
+    //   VISION_GOVERNOR_FPS=<目标帧率，默认 30>
+    //   VISION_GOVERNOR_SKIP=<跳帧级别下每 N 帧处理一帧，默认 2；编码降级时每 2N 帧一帧>
+    //   VISION_GOVERNOR_BITRATE=<编码降级时的码率比例，默认 0.5，与帧率减半对应>
+    //   VISION_GOVERNOR_MAX_LEVEL=<最高级别 0-3，默认 3>
+    std::unique_ptr<LoadGovernor> governor;
+    unsigned governor_skip = 2;
+    double governor_bitrate = 0.5;
+    if (const char* governor_env = std::getenv("VISION_GOVERNOR");
+        governor_env && std::string(governor_env) != "0") {
+        LoadGovernor::Options governor_options;
+        if (const char* v = std::getenv("VISION_GOVERNOR_FPS")) {
+            governor_options.target_fps = std::atof(v);
+        }
+        if (const char* v = std::getenv("VISION_GOVERNOR_MAX_LEVEL")) {
+            governor_options.max_level = std::atoi(v);
+        }
+        if (const char* v = std::getenv("VISION_GOVERNOR_SKIP")) {
+            governor_skip = std::max(1ul, std::strtoul(v, nullptr, 10));
+        }
+        if (const char* v = std::getenv("VISION_GOVERNOR_BITRATE")) governor_bitrate = std::atof(v);
+        // 编码降级靠降帧率减负载；CRF 且不限 maxrate 时没有码率可降，只降帧率
+        const bool bitrate_scalable =
+            simulcast ? simulcast->SupportsBitRateScale() : streamer->SupportsBitRateScale();
+        if (!bitrate_scalable &&
+            governor_options.max_level >= static_cast<int>(LoadGovernor::Level::EncoderReduced)) {
+            std::cout << "[LoadGovernor] CRF 模式未设置码率上限，编码降级只降低帧率" << std::endl;
+        }
+        governor = std::make_unique<LoadGovernor>(governor_options);
+        std::cout << "[LoadGovernor] 已启用，目标 " << governor->options().target_fps
+                  << " fps，最高级别 "
+                  << LoadGovernor::level_name(
+                         static_cast<LoadGovernor::Level>(governor->options().max_level))
+                  << std::endl;
+    }
+    // 降分辨率级别起算法在 1/2 尺寸上运行
+    auto algorithm_pyramid_level = [&] {
+        return governor && governor->level() >= LoadGovernor::Level::ReducedResolution ? 1 : 0;
+    };
+    // 跳帧级别的帧计数，只在采集线程中访问
+    uint64_t governor_frame = 0;
+
+    // MJPEG 的检测用亮度，只在采集线程中访问
+    JpegDecoder motion_decoder;
+    cv::Mat motion_luma;
+
+    FramePool& framePool = FramePool::shared();
+
+    // 编码阶段看到的驱动序号，只在编码线程中访问；skipped_frames 由主线程读取
+    uint32_t last_sequence = 0;
+    bool has_sequence = false;
+    // 运动检测的变化帧编号：gate_epoch 只在采集线程中访问，
+    // encoded_epoch / invalidated_epoch 只在编码线程中访问
+    uint64_t gate_epoch = 0;
+    uint64_t encoded_epoch = 0, invalidated_epoch = 0;
+    std::atomic<uint64_t> skipped_frames{0};
+
+    // 有限长度的帧源（回放、VISION_SOURCE_FRAMES）交付完毕后置位，主循环随之退出
+    std::atomic<bool> source_done{false};
+    // 采集阶段：阻塞在驱动上，由摄像头帧率驱动节奏
+    Pipeline<StreamFrame> pipeline("capture", [&](StreamFrame& f) {
+        while (g_running && !capture->finished()) {
+            f.raw = capture->acquire_frame(200);
+            if (f.raw) {
+                // 只拷贝进内存块，写盘在录制器自己的线程中进行；写盘跟不上时丢录制帧而不是阻塞采集
+                if (capture_recorder) capture_recorder->append(*f.raw);
+                f.sequence = f.raw->sequence;
+                f.capture_ns = f.raw->capture_ns;
+                f.gate_epoch = gate_epoch;
+                // 跳帧级别：每 governor_skip 帧只处理一帧，编码降级时间隔再加倍，
+                // 其余按静止帧重复上一次的输出（重复帧基本不占编码器）。
+                // 跳过的帧不经过运动检测，检测的参考帧仍是真正处理过的帧
+                const auto level = governor ? governor->level() : LoadGovernor::Level::Full;
+                const uint64_t skip_stride = level >= LoadGovernor::Level::EncoderReduced ? governor_skip * 2
+                                             : level >= LoadGovernor::Level::FrameSkip    ? governor_skip
+                                                                                          : 1;
+                if (skip_stride > 1 && governor_frame++ % skip_stride != 0) {
+                    f.repeat = true;
+                    f.raw.reset();
+                    return true;
+                }
+                if (motion_gate) {
+                    MotionGate::Decision decision;
+                    if (FMT == OpenCVProcessor::PixelFormat::YUYV) {
+                        if (f.raw->bytesused >= static_cast<size_t>(width) * height * 2) {
+                            decision = motion_gate->analyze_yuyv(f.raw->data, width * 2);
+                        }
+                    } else if (motion_decoder.decode_gray(f.raw->data, f.raw->bytesused, motion_luma,
+                                                          JpegDecoder::Scale::Eighth)) {
+                        decision = motion_gate->analyze(motion_luma.data,
+                                                        static_cast<int>(motion_luma.step), 1,
+                                                        motion_luma.cols, motion_luma.rows);
+                    }
+                    f.repeat = !decision.changed;
+                    if (f.repeat) {
+                        f.raw.reset();  // 静止帧不再需要原始数据
+                    } else {
+                        f.gate_epoch = ++gate_epoch;
+                    }
+                }
+                return true;
+            }
+        }
+        source_done = true;
+        return false;
     });
-    std::cout << "[RTMPStreamer] 推流线程创建成功！"<< std::endl;
 
-    std::vector<uint8_t> frameBuffer;
-    cv::Mat RGBFrame;
+    // 采集跟不上下游时丢弃最旧的帧，保证推出去的总是最新画面；
+    // unpaced 帧源用于测吞吐，改为阻塞采集，让下游决定速度而不是大量丢帧
+    const Pipeline<StreamFrame>::StageOptions first_stage_queue = {
+        "", DECODE_WORKERS, false, 2,
+        source_options.pacing == Pacing::Unpaced ? OverflowPolicy::Block
+                                                 : OverflowPolicy::DropOldest};
+    if (YUV_DIRECT) {
+        auto convert = first_stage_queue;
+        convert.name = "convert";
+        pipeline
+            .add_stage_per_worker(convert, [&]() -> Pipeline<StreamFrame>::StageFn {
+                if (FMT == OpenCVProcessor::PixelFormat::MJPEG) {
+                    // JpegDecoder 持有解码句柄，每个工作线程一份
+                    auto decoder = std::make_shared<JpegDecoder>();
+                    return [&, decoder](StreamFrame& f) {
+                        if (f.repeat) return true;
+                        MotionCost cost(motion_gate.get());
+                        f.yuv = simulcast
+                            ? simulcast->ConvertFromMJPEG(*decoder, f.raw->data, f.raw->bytesused)
+                            : streamer->ConvertFromMJPEG(*decoder, f.raw->data, f.raw->bytesused);
+                        f.raw.reset();  // 尽快把缓冲区还给驱动
+                        return static_cast<bool>(f.yuv);
+                    };
+                }
+                return [&](StreamFrame& f) {
+                    if (f.repeat) return true;
+                    MotionCost cost(motion_gate.get());
+                    if (f.raw->bytesused < static_cast<size_t>(width) * height * 2) {
+                        return false;  // 不完整的帧
+                    }
+                    f.yuv = simulcast ? simulcast->ConvertFromYUYV(f.raw->data, width * 2)
+                                      : streamer->ConvertFromYUYV(f.raw->data, width * 2);
+                    f.raw.reset();  // 尽快把缓冲区还给驱动
+                    return static_cast<bool>(f.yuv);
+                };
+            })
+            .add_stage_per_worker({"algorithm", ALGORITHM_WORKERS}, [&] {
+                auto processor = std::make_shared<OpenCVProcessor>(FMT, width, height);
+                if (!ALGORITHM.empty()) processor->set_algorithm(ALGORITHM);
+                return [&, processor](StreamFrame& f) {
+                    if (f.repeat) return true;
+                    MotionCost cost(motion_gate.get());
+                    // 直接在 AVFrame 的平面上建 Mat 头，原地处理
+                    AVFrame* yuv = f.yuv.get();
+                    cv::Mat y(yuv->height, yuv->width, CV_8UC1, yuv->data[0], yuv->linesize[0]);
+                    cv::Mat u((yuv->height + 1) / 2, yuv->width / 2, CV_8UC1,
+                              yuv->data[1], yuv->linesize[1]);
+                    cv::Mat v((yuv->height + 1) / 2, yuv->width / 2, CV_8UC1,
+                              yuv->data[2], yuv->linesize[2]);
+                    processor->set_pyramid_level(algorithm_pyramid_level());
+                    processor->apply_algorithm_luma(y, u, v);
+                    return true;
+                };
+            });
+    } else {
+        auto decode = first_stage_queue;
+        decode.name = "decode";
+        pipeline
+            .add_stage_per_worker(decode, [&] {
+                // OpenCVProcessor 持有中间缓冲区，每个工作线程一份
+                auto processor = std::make_shared<OpenCVProcessor>(FMT, width, height);
+                return [&, processor](StreamFrame& f) {
+                    if (f.repeat) return true;
+                    MotionCost cost(motion_gate.get());
+                    f.rgb = framePool.acquire(height, width, CV_8UC3);
+                    bool ok = processor->Decode2RGB(f.raw->data, f.raw->bytesused, f.rgb);
+                    f.raw.reset();  // 尽快把缓冲区还给驱动
+                    return ok;
+                };
+            })
+            .add_stage_per_worker({"algorithm", ALGORITHM_WORKERS}, [&] {
+                auto processor = std::make_shared<OpenCVProcessor>(FMT, width, height);
+                if (!ALGORITHM.empty()) processor->set_algorithm(ALGORITHM);
+                return [&, processor](StreamFrame& f) {
+                    if (f.repeat) return true;
+                    MotionCost cost(motion_gate.get());
+                    processor->set_pyramid_level(algorithm_pyramid_level());
+                    processor->apply_algorithm(f.rgb);
+                    return true;
+                };
+            })
+            .add_stage({"convert", 1}, [&](StreamFrame& f) {
+                if (f.repeat) return true;
+                MotionCost cost(motion_gate.get());
+                f.yuv = simulcast ? simulcast->ConvertFrame(f.rgb) : streamer->ConvertFrame(f.rgb);
+                f.rgb.release();
+                return static_cast<bool>(f.yuv);
+            });
+    }
+    pipeline
+        // 编码必须按采集顺序进行
+        .add_stage({"encode", 1, true}, [&](StreamFrame& f) {
+            // 驱动序号跳号 = 驱动丢帧 + 流水线丢帧，PTS 中对应位置留下空隙
+            if (has_sequence) {
+                // 按 uint32 取差，序号回绕时不会误算
+                skipped_frames += static_cast<uint32_t>(f.sequence - last_sequence - 1);
+            }
+            last_sequence = f.sequence;
+            has_sequence = true;
+            // 静止帧：编码器重复上一帧或不编码，这部分开销从节省的 CPU 中扣除
+            if (f.repeat) {
+                // 沿用的变化帧没有到达编码器（解码/转换失败，或在队列中被丢弃）：
+                // 编码器重复的是更早的画面，而运动检测的参考已经更新。
+                // 让运动检测丢弃参考，下一帧重新处理
+                if (motion_gate && f.gate_epoch != encoded_epoch &&
+                    f.gate_epoch != invalidated_epoch) {
+                    motion_gate->invalidate_reference();
+                    invalidated_epoch = f.gate_epoch;
+                }
+                MotionCost cost(motion_gate.get(), true);
+                if (simulcast) {
+                    simulcast->RepeatFrame(f.capture_ns);
+                } else {
+                    streamer->RepeatFrame(f.capture_ns);
+                }
+                return true;
+            }
+            encoded_epoch = f.gate_epoch;
+            MotionCost cost(motion_gate.get());
+            if (simulcast) {
+                simulcast->PushFrame(std::move(f.yuv), f.capture_ns);
+            } else {
+                streamer->EncodeFrame(std::move(f.yuv), f.capture_ns);
+            }
+            return true;
+        });
+
+    // 设置 VISION_TRACE=<文件> 时记录每帧各阶段的 span，退出时写出 Chrome trace JSON
+    const char* trace_path = std::getenv("VISION_TRACE");
+    if (trace_path) Tracer::instance().enable();
+
+    // 设置 VISION_METRICS_FILE=<文件> 和/或 VISION_METRICS_PORT=<端口> 时导出 Prometheus 指标
+    std::unique_ptr<MetricsExporter> metrics;
+    const char* metrics_file = std::getenv("VISION_METRICS_FILE");
+    const char* metrics_port = std::getenv("VISION_METRICS_PORT");
+    if (metrics_file || metrics_port) {
+        MetricsExporter::Options metrics_options;
+        if (metrics_file) metrics_options.file_path = metrics_file;
+        if (metrics_port) metrics_options.http_port = std::atoi(metrics_port);
+        // fps 由相邻两次采集之间编码阶段处理的帧数计算，只在导出线程中访问
+        auto last_frames = std::make_shared<uint64_t>(0);
+        auto last_time = std::make_shared<std::chrono::steady_clock::time_point>(
+            std::chrono::steady_clock::now());
+        metrics = std::make_unique<MetricsExporter>(
+            [&, last_frames, last_time](MetricsText& m) {
+                const auto stages = pipeline.stats();
+                for (const auto& st : stages) {
+                    m.counter("vision_stage_frames_total", "Frames processed by stage",
+                              st.processed, "stage=\"" + st.name + "\"");
+                }
+                for (const auto& st : stages) {
+                    m.counter("vision_stage_dropped_total", "Frames dropped by stage function",
+                              st.dropped, "stage=\"" + st.name + "\"");
+                }
+                for (const auto& st : stages) {
+                    m.counter("vision_stage_queue_drops_total", "Frames dropped by queue overflow",
+                              st.queue_drops, "stage=\"" + st.name + "\"");
+                }
+                for (const auto& st : stages) {
+                    m.gauge("vision_stage_queue_depth", "Frames waiting in the stage input queue",
+                            st.queue_depth, "stage=\"" + st.name + "\"");
+                }
+                for (const auto& st : stages) {
+                    m.gauge("vision_stage_utilization", "Stage busy fraction", st.utilization,
+                            "stage=\"" + st.name + "\"");
+                }
+                for (const auto& st : stages) {
+                    m.summary("vision_stage_latency_ms", "Per-frame stage time (ms)",
+                              st.latency_ms, "stage=\"" + st.name + "\"");
+                }
+                const auto now = std::chrono::steady_clock::now();
+                const uint64_t frames = stages.back().processed;
+                const double seconds = std::chrono::duration<double>(now - *last_time).count();
+                if (seconds > 0) m.gauge("vision_fps", "Encoded frames per second",
+                                         (frames - *last_frames) / seconds);
+                *last_frames = frames;
+                *last_time = now;
+                m.counter("vision_capture_skipped_total",
+                          "Captured frames that never reached the encoder", skipped_frames.load());
+                m.counter("vision_capture_stale_dropped_total",
+                          "Older ready frames discarded by latest-frame capture",
+                          capture->stale_dropped());
+                if (motion_gate) {
+                    const auto ms = motion_gate->stats();
+                    m.counter("vision_motion_frames_total", "Frames checked by the motion gate",
+                              ms.frames);
+                    m.counter("vision_motion_static_frames_total",
+                              "Static frames that skipped decode, algorithm and conversion",
+                              ms.static_frames);
+                    m.gauge("vision_motion_cpu_saved_seconds",
+                            "Estimated CPU time saved by skipping static frames",
+                            ms.cpu_saved_ms / 1000.0);
+                }
+                if (governor) {
+                    const auto gs = governor->stats();
+                    m.gauge("vision_governor_level", "Current load-shedding level (0 = full quality)",
+                            static_cast<int>(gs.level));
+                    m.gauge("vision_governor_load",
+                            "Per-frame cost of the busiest stage relative to the frame deadline",
+                            gs.load);
+                    m.counter("vision_governor_transitions_total", "Load-shedding level changes",
+                              gs.transitions);
+                    for (int i = 0; i < LoadGovernor::kLevelCount; ++i) {
+                        m.counter("vision_governor_level_seconds_total",
+                                  "Time spent at each load-shedding level", gs.level_seconds[i],
+                                  std::string("level=\"") +
+                                      LoadGovernor::level_name(static_cast<LoadGovernor::Level>(i)) +
+                                      "\"");
+                    }
+                }
+                std::vector<OutputMetrics> outputs;
+                if (streamer) {
+                    outputs.push_back({"output=\"main\"", streamer->GetWriterStats(),
+                                       streamer->GetCaptureLatency()});
+                }
+                if (simulcast) {
+                    for (const auto& rung : simulcast->GetStats()) {
+                        outputs.push_back(
+                            {"output=\"" + rung.name + "\"", rung.writer, rung.capture_latency});
+                    }
+                }
+                collect_writer_metrics(m, outputs);
+            },
+            metrics_options);
+        std::cout << "[MetricsExporter] 已启用"
+                  << (metrics_file ? std::string("，文件 ") + metrics_file : "")
+                  << (metrics_port ? std::string("，http://127.0.0.1:") + metrics_port + "/metrics"
+                                   : "")
+                  << std::endl;
+    }
 
-    const auto frame_interval = std::chrono::milliseconds(1000 / 30);
-    while (true) {
-        auto t0 = std::chrono::steady_clock::now();
+    pipeline.start();
+    std::cout << "[Pipeline] 流水线启动完成！算法: "
+              << (ALGORITHM.empty() ? "canny (opencv)" : ALGORITHM) << std::endl;
 
-        if (!capture.capture_frame(frameBuffer)) {
-            std::cerr << "帧捕获失败\n";
-            continue;
+    const auto started = std::chrono::steady_clock::now();
+    auto last_report = started;
+    while (g_running && !source_done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (g_event.exchange(false) && recorder) {
+            recorder->Trigger();
+            std::cout << "[SegmentRecorder] 事件触发" << std::endl;
         }
-        // std::cout << "[V4L2Capture] 捕获到图像数据！"<< std::endl;
-        if (!processor.Decode2RGB(frameBuffer, RGBFrame)) {
-            std::cerr << "解码失败\n";
-            continue;
+        if (governor && governor->update(governor_samples(pipeline.stats()))) {
+            const auto level = governor->level();
+            // 编码降级的帧率在采集阶段按级别减半；码率随之同比例下调。
+            // 默认的 ultrafast 已是最快的 preset，换 preset 还需要重开编码器
+            const double bitrate_scale =
+                level >= LoadGovernor::Level::EncoderReduced ? governor_bitrate : 1.0;
+            if (simulcast) {
+                simulcast->SetBitRateScale(bitrate_scale);
+            } else {
+                streamer->SetBitRateScale(bitrate_scale);
+            }
+            const auto gs = governor->stats();
+            std::cout << "[LoadGovernor] 负载 " << std::fixed << std::setprecision(2) << gs.load
+                      << " (" << gs.bottleneck << ")，切换到 " << LoadGovernor::level_name(level)
+                      << std::endl;
         }
-        processor.apply_algorithm(RGBFrame);
-        // std::cout << "[OpenCVProcessor] 图像处理完成!"<< std::endl;
-        // 将RGB帧放入队列
-        frameQueue.push(RGBFrame.clone());  // clone防止异步数据冲突
-
-        auto dt = std::chrono::steady_clock::now() - t0;
-        if (dt < frame_interval) {
-            std::this_thread::sleep_for(frame_interval - dt);
+        if (std::chrono::steady_clock::now() - last_report >= std::chrono::seconds(5)) {
+            print_stats(pipeline.stats());
+            print_skipped(skipped_frames, capture->stale_dropped());
+            if (motion_gate) print_motion_stats(*motion_gate);
+            if (governor) print_governor_stats(*governor);
+            print_output_stats(streamer.get(), simulcast.get(), recorder.get());
+            last_report = std::chrono::steady_clock::now();
         }
     }
 
-    streaming_thread.join();
+    pipeline.stop();
+    pipeline.wait();
+    const auto stage_stats = pipeline.stats();
+    print_stats(stage_stats);
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (elapsed > 0) {
+        std::cout << "[Pipeline] 共编码 " << stage_stats.back().processed << " 帧，用时 "
+                  << std::fixed << std::setprecision(2) << elapsed << " s，平均 "
+                  << stage_stats.back().processed / elapsed << " fps" << std::endl;
+    }
+    print_skipped(skipped_frames, capture->stale_dropped());
+    if (motion_gate) print_motion_stats(*motion_gate);
+    if (governor) print_governor_stats(*governor);
+    if (capture_recorder) {
+        capture_recorder->close();
+        const auto rs = capture_recorder->stats();
+        std::cout << "[RawCaptureWriter] 录制 " << rs.frames << " 帧, 丢弃 " << rs.dropped
+                  << " 帧, 写入 " << rs.bytes_written / (1024 * 1024) << " MiB / " << rs.writes
+                  << " 次" << std::endl;
+    }
+    // 先排空编码器，延迟帧的包也要进入录像，再写完录像队列并关闭当前分段
+    if (simulcast) simulcast->Stop();
+    if (streamer) streamer->Flush();
+    if (recorder) recorder->Stop();
+    print_output_stats(streamer.get(), simulcast.get(), recorder.get());
+    metrics.reset();
+    if (trace_path && Tracer::instance().write_chrome_trace(trace_path)) {
+        std::cout << "[Tracer] trace 已写入 " << trace_path << std::endl;
+    }
+    auto pool_stats = framePool.stats();
+    std::cout << "[FramePool] 命中 " << pool_stats.hits << " 次，未命中 "
+              << pool_stats.misses << " 次" << std::endl;
     return 0;
 }
@@ -0,0 +1,66 @@
+#include "AllocCounter.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+namespace {
+std::atomic<bool> g_enabled{false};
+std::atomic<uint64_t> g_count{0};
+
+inline void note_alloc() {
+    if (g_enabled.load(std::memory_order_relaxed)) g_count.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace
+
+#if defined(__GLIBC__)
+// glibc 导出的原始实现；这里不覆盖 free，释放仍由 glibc 完成
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    note_alloc();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    note_alloc();
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    note_alloc();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    note_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    note_alloc();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    note_alloc();
+    void* p = __libc_memalign(alignment, size);
+    if (!p && size != 0) return ENOMEM;
+    *out = p;
+    return 0;
+}
+}  // extern "C"
+
+bool AllocCounter::supported() { return true; }
+#else
+bool AllocCounter::supported() { return false; }
+#endif
+
+uint64_t AllocCounter::count() { return g_count.load(std::memory_order_relaxed); }
+
+void AllocCounter::enable(bool on) { g_enabled.store(on, std::memory_order_relaxed); }
@@ -0,0 +1,40 @@
+#pragma once
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+// 统计堆分配次数（malloc / calloc / realloc / posix_memalign 等）。
+// glibc 下在可执行文件中覆盖分配函数，OpenCV（fastMalloc）、FFmpeg（av_malloc）
+// 与 operator new 的分配都会被计入；其他平台 supported() 为 false，不输出计数。
+// 计数是全进程的：编码器、写出线程等在测量期间的分配也算在内
+class AllocCounter {
+public:
+    static bool supported();
+    static uint64_t count();
+    // 只在 enable 期间计数，其他基准不付出原子操作的开销
+    static void enable(bool on);
+};
+
+// 放在基准循环前：从构造到析构之间的分配次数按迭代平均，
+// 写入 state.counters["allocs_per_frame"]
+class AllocScope {
+public:
+    explicit AllocScope(benchmark::State& state) : state_(state) {
+        AllocCounter::enable(true);
+        begin_ = AllocCounter::count();
+    }
+    ~AllocScope() {
+        const uint64_t allocs = AllocCounter::count() - begin_;
+        AllocCounter::enable(false);
+        if (AllocCounter::supported()) {
+            state_.counters["allocs_per_frame"] =
+                benchmark::Counter(static_cast<double>(allocs), benchmark::Counter::kAvgIterations);
+        }
+    }
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    benchmark::State& state_;
+    uint64_t begin_ = 0;
+};
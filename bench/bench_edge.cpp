@@ -0,0 +1,110 @@
+// 边缘检测路径对比：现有 RGB→GRAY→Canny→RGB 与直接读取亮度的融合内核
+#include <benchmark/benchmark.h>
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "processor/EdgeKernel.hpp"
+#include "processor/OpenCVProcessor.hpp"
+#include "processor/TileScheduler.hpp"
+
+namespace {
+
+// 合成一帧带有矩形和渐变的 YUYV 图像，保证有足够多的边缘
+std::vector<uint8_t> make_yuyv(int width, int height) {
+    std::vector<uint8_t> yuyv(static_cast<size_t>(width) * height * 2);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t luma = static_cast<uint8_t>((x + y) & 0x7F);
+            if (((x / 64) + (y / 64)) % 2 == 0) luma += 100;
+            uint8_t* p = &yuyv[(static_cast<size_t>(y) * width + x) * 2];
+            p[0] = luma;
+            p[1] = (x & 1) ? 120 : 136;
+        }
+    }
+    return yuyv;
+}
+
+// 现有路径：YUYV→RGB 解码，再 apply_algorithm（RGB→GRAY→Canny→RGB）
+void BM_EdgeRgbPath(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    auto yuyv = make_yuyv(width, height);
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::YUYV, width, height);
+    cv::Mat rgb;
+    for (auto _ : state) {
+        processor.Decode2RGB(yuyv.data(), yuyv.size(), rgb);
+        processor.apply_algorithm(rgb);
+        benchmark::DoNotOptimize(rgb.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 融合路径：直接从 YUYV 读取亮度，输出单通道边缘图
+void BM_EdgeFusedYuyv(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    auto yuyv = make_yuyv(width, height);
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::YUYV, width, height);
+    cv::Mat edges;
+    for (auto _ : state) {
+        processor.Decode2Edges(yuyv.data(), yuyv.size(), edges);
+        benchmark::DoNotOptimize(edges.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 推流路径：在编码器的 Y 平面上原地运行
+void BM_EdgeFusedLumaPlane(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    auto yuyv = make_yuyv(width, height);
+    std::vector<uint8_t> luma(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < luma.size(); ++i) luma[i] = yuyv[i * 2];
+    std::vector<uint8_t> plane(luma.size());
+    EdgeKernel kernel;
+    for (auto _ : state) {
+        // 每次迭代恢复原始亮度，否则第二次起输入已是边缘图
+        plane = luma;
+        kernel.detect(plane.data(), width, 1, width, height, plane.data(), width);
+        benchmark::DoNotOptimize(plane.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 分块并行：range(2) 为线程数，用于观察 1 → N 核的扩展性
+void BM_EdgeTiled(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    auto yuyv = make_yuyv(width, height);
+    TileScheduler scheduler(static_cast<unsigned>(state.range(2)));
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::YUYV, width, height);
+    processor.set_tile_scheduler(&scheduler);
+    cv::Mat edges;
+    for (auto _ : state) {
+        processor.Decode2Edges(yuyv.data(), yuyv.size(), edges);
+        benchmark::DoNotOptimize(edges.data);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void TiledArgs(benchmark::internal::Benchmark* b) {
+    const int max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (auto [w, h] : {std::pair{1280, 720}, std::pair{1920, 1080}}) {
+        for (int t = 1; t < max_threads; t *= 2) b->Args({w, h, t});
+        b->Args({w, h, max_threads});
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_EdgeRgbPath)->Args({1280, 720})->Args({1920, 1080})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeFusedYuyv)->Args({1280, 720})->Args({1920, 1080})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeFusedLumaPlane)->Args({1280, 720})->Args({1920, 1080})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeTiled)->Apply(TiledArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,56 @@
+// 算法链：编译期融合的一次遍历 vs 每个算子各遍历一次
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "processor/FilterChain.hpp"
+
+namespace {
+
+std::vector<uint8_t> make_luma(int width, int height) {
+    std::vector<uint8_t> luma(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < luma.size(); ++i) luma[i] = static_cast<uint8_t>(i * 7 ^ (i >> 9));
+    return luma;
+}
+
+void run_chain(benchmark::State& state, FilterChain& chain) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    auto luma = make_luma(width, height);
+    LumaPlane plane{luma.data(), width, width, height};
+    for (auto _ : state) {
+        chain.apply(plane);
+        benchmark::DoNotOptimize(luma.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(luma.size()));
+}
+
+void BM_PixelOpsFused(benchmark::State& state) {
+    FilterChain chain;
+    chain.then(fuse(Contrast(1.3f, -20), Gamma(0.8f), Posterize(6), Invert()));
+    run_chain(state, chain);
+}
+
+void BM_PixelOpsSeparate(benchmark::State& state) {
+    FilterChain chain;
+    chain.then(fuse(Contrast(1.3f, -20)))
+        .then(fuse(Gamma(0.8f)))
+        .then(fuse(Posterize(6)))
+        .then(fuse(Invert()));
+    run_chain(state, chain);
+}
+
+void BM_NamedChain(benchmark::State& state, const char* name) {
+    auto chain = FilterChain::create(name);
+    run_chain(state, *chain);
+}
+
+}  // namespace
+
+BENCHMARK(BM_PixelOpsFused)->Args({1280, 720})->Args({1920, 1080});
+BENCHMARK(BM_PixelOpsSeparate)->Args({1280, 720})->Args({1920, 1080});
+BENCHMARK_CAPTURE(BM_NamedChain, denoise_edges, "denoise-edges")
+    ->Args({1920, 1080})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_NamedChain, heatmap, "heatmap")
+    ->Args({1920, 1080})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,220 @@
+// 逐帧热路径：Decode2RGB（YUYV / MJPEG）、apply_algorithm、sws_scale 颜色转换与编码，
+// 以及静止画面的代价：运动检测与编码重复帧（RepeatFrame），
+// 合成帧覆盖 480p / 720p / 1080p / 4K。每项报告 items/s（帧/秒）、bytes/s（输入字节）
+// 与 allocs_per_frame（见 AllocCounter.hpp）。
+// 基准名与参数名固定（例如 BM_Decode2RGB_YUYV/width:1920/height:1080），
+// 不同提交的 JSON 结果可以直接对比：
+//   vision_bench --benchmark_filter=Decode2RGB --benchmark_out=after.json --benchmark_out_format=json
+//   compare.py benchmarks before.json after.json   （Google Benchmark 的 tools/compare.py）
+// 设置 VISION_ALGORITHM 时 apply_algorithm 使用对应的算法链（与应用程序一致）
+#include <benchmark/benchmark.h>
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "AllocCounter.hpp"
+#include "processor/MotionGate.hpp"
+#include "processor/OpenCVProcessor.hpp"
+#include "streamer/RTMPStreamer.hpp"
+
+namespace {
+
+// 合成 RGB 画面：渐变背景 + 棋盘格 + 圆，保证解码与边缘检测都有足够的细节
+cv::Mat make_rgb(int width, int height) {
+    cv::Mat rgb(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        auto* row = rgb.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            const bool cell = ((x / 64) + (y / 64)) % 2 == 0;
+            row[x] = {static_cast<uint8_t>(x * 255 / width), static_cast<uint8_t>(cell ? 200 : 60),
+                      static_cast<uint8_t>(y * 255 / height)};
+        }
+    }
+    cv::circle(rgb, {width / 2, height / 2}, height / 4, {220, 160, 40}, -1);
+    return rgb;
+}
+
+std::vector<uint8_t> make_yuyv(const cv::Mat& rgb) {
+    cv::Mat yuv;
+    cv::cvtColor(rgb, yuv, cv::COLOR_RGB2YUV);
+    std::vector<uint8_t> yuyv(static_cast<size_t>(rgb.cols) * rgb.rows * 2);
+    for (int y = 0; y < rgb.rows; ++y) {
+        const auto* src = yuv.ptr<cv::Vec3b>(y);
+        uint8_t* dst = &yuyv[static_cast<size_t>(y) * rgb.cols * 2];
+        for (int x = 0; x < rgb.cols; x += 2) {
+            dst[x * 2 + 0] = src[x][0];
+            dst[x * 2 + 1] = static_cast<uint8_t>((src[x][1] + src[x + 1][1]) / 2);
+            dst[x * 2 + 2] = src[x + 1][0];
+            dst[x * 2 + 3] = static_cast<uint8_t>((src[x][2] + src[x + 1][2]) / 2);
+        }
+    }
+    return yuyv;
+}
+
+std::vector<uint8_t> make_mjpeg(const cv::Mat& rgb) {
+    cv::Mat bgr;
+    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+    std::vector<uint8_t> jpeg;
+    cv::imencode(".jpg", bgr, jpeg, {cv::IMWRITE_JPEG_QUALITY, 85});
+    return jpeg;
+}
+
+int frame_width(const benchmark::State& state) { return static_cast<int>(state.range(0)); }
+int frame_height(const benchmark::State& state) { return static_cast<int>(state.range(1)); }
+
+void report(benchmark::State& state, size_t bytes_per_frame) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes_per_frame));
+}
+
+void BM_Decode2RGB_YUYV(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    const auto yuyv = make_yuyv(make_rgb(width, height));
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::YUYV, width, height);
+    cv::Mat rgb;
+    processor.Decode2RGB(yuyv.data(), yuyv.size(), rgb);  // 预热：输出 Mat 的首次分配不计入
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            processor.Decode2RGB(yuyv.data(), yuyv.size(), rgb);
+            benchmark::DoNotOptimize(rgb.data);
+        }
+    }
+    report(state, yuyv.size());
+}
+
+void BM_Decode2RGB_MJPEG(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    const auto jpeg = make_mjpeg(make_rgb(width, height));
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::MJPEG, width, height);
+    cv::Mat rgb;
+    processor.Decode2RGB(jpeg.data(), jpeg.size(), rgb);
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            processor.Decode2RGB(jpeg.data(), jpeg.size(), rgb);
+            benchmark::DoNotOptimize(rgb.data);
+        }
+    }
+    report(state, jpeg.size());
+}
+
+void BM_ApplyAlgorithm(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    const cv::Mat source = make_rgb(width, height);
+    OpenCVProcessor processor(OpenCVProcessor::PixelFormat::YUYV, width, height);
+    if (const char* name = std::getenv("VISION_ALGORITHM"); name && !processor.set_algorithm(name)) {
+        state.SkipWithError("未知的 VISION_ALGORITHM");
+        return;
+    }
+    cv::Mat frame = source.clone();
+    processor.apply_algorithm(frame);
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            // 算法原地修改帧，每次迭代恢复输入（不计时，尺寸不变时 copyTo 不分配）
+            state.PauseTiming();
+            source.copyTo(frame);
+            state.ResumeTiming();
+            processor.apply_algorithm(frame);
+            benchmark::DoNotOptimize(frame.data);
+        }
+    }
+    report(state, source.total() * source.elemSize());
+}
+
+// RGB24 → YUV420P（RTMPStreamer::ConvertFrame 中的 sws_scale），输出帧来自帧池
+void BM_SwsScaleRgbToYuv420p(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    const cv::Mat rgb = make_rgb(width, height);
+    RTMPStreamer streamer(width, height, 30, "/dev/null");
+    streamer.ConvertFrame(rgb);
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            AVFramePtr frame = streamer.ConvertFrame(rgb);
+            benchmark::DoNotOptimize(frame.get());
+        }
+    }
+    report(state, rgb.total() * rgb.elemSize());
+}
+
+// 编码步骤（RTMPStreamer::EncodeFrame，默认 EncoderConfig），输出封装为 FLV 写到 /dev/null。
+// 每帧在基准外从预先转换好的帧拷贝，画面逐帧变化，编码器不会走静止画面的捷径
+void BM_EncodeFrame(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    PacketWriter<AVPacketPtr>::Options write_options;
+    write_options.max_packets = 4096;  // 不测写出丢包
+    RTMPStreamer streamer(width, height, 30, "/dev/null", {}, write_options);
+
+    std::vector<AVFramePtr> sources;
+    cv::Mat rgb = make_rgb(width, height);
+    for (int i = 0; i < 8; ++i) {
+        cv::rectangle(rgb, {i * width / 16, height / 8}, {i * width / 16 + width / 8, height / 3},
+                      {static_cast<double>(i * 30), 80, 200}, -1);
+        sources.push_back(streamer.ConvertFrame(rgb));
+    }
+    const size_t yuv_bytes = static_cast<size_t>(width) * height * 3 / 2;
+
+    size_t i = 0;
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            state.PauseTiming();
+            AVFramePtr frame = streamer.AcquireFrame();
+            av_frame_copy(frame.get(), sources[i++ % sources.size()].get());
+            state.ResumeTiming();
+            streamer.EncodeFrame(std::move(frame));
+        }
+    }
+    report(state, yuv_bytes);
+}
+
+// 静止画面上的运动检测（MotionGate::analyze_yuyv），每帧都判定为静止
+void BM_MotionGateYUYV(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    const auto yuyv = make_yuyv(make_rgb(width, height));
+    MotionGate gate(width, height);
+    gate.analyze_yuyv(yuyv.data(), width * 2);
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(gate.analyze_yuyv(yuyv.data(), width * 2).changed);
+        }
+    }
+    report(state, yuyv.size());
+}
+
+// 编码重复帧（repeat_interval_ms = 0：每次都把上一帧再编一次），与 BM_EncodeFrame 对比
+void BM_RepeatFrame(benchmark::State& state) {
+    const int width = frame_width(state), height = frame_height(state);
+    PacketWriter<AVPacketPtr>::Options write_options;
+    write_options.max_packets = 4096;
+    EncoderConfig config;
+    config.repeat_interval_ms = 0;
+    RTMPStreamer streamer(width, height, 30, "/dev/null", config, write_options);
+    streamer.EncodeFrame(streamer.ConvertFrame(make_rgb(width, height)));
+    {
+        AllocScope allocs(state);
+        for (auto _ : state) streamer.RepeatFrame();
+    }
+    report(state, static_cast<size_t>(width) * height * 3 / 2);
+}
+
+// 480p / 720p / 1080p / 4K
+void Resolutions(benchmark::internal::Benchmark* b) {
+    b->Args({640, 480})->Args({1280, 720})->Args({1920, 1080})->Args({3840, 2160});
+    b->ArgNames({"width", "height"})->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(BM_Decode2RGB_YUYV)->Apply(Resolutions);
+BENCHMARK(BM_Decode2RGB_MJPEG)->Apply(Resolutions);
+BENCHMARK(BM_ApplyAlgorithm)->Apply(Resolutions);
+BENCHMARK(BM_SwsScaleRgbToYuv420p)->Apply(Resolutions);
+BENCHMARK(BM_EncodeFrame)->Apply(Resolutions);
+BENCHMARK(BM_MotionGateYUYV)->Apply(Resolutions);
+BENCHMARK(BM_RepeatFrame)->Apply(Resolutions);
@@ -0,0 +1,133 @@
+// MJPEG 解码对比：cv::imdecode(BGR) + cvtColor 与 TurboJPEG 直接输出 RGB / YUV420P / DCT 缩放。
+// 设置 VISION_JPEG_DIR 指向录制的摄像头 JPEG 帧目录（*.jpg）时使用真实数据，
+// 否则用合成画面编码出 720p / 1080p 的测试帧
+#include <benchmark/benchmark.h>
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "processor/JpegDecoder.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using JpegFrames = std::vector<std::vector<uint8_t>>;
+
+JpegFrames load_recorded(const std::string& dir) {
+    JpegFrames frames;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        const auto ext = entry.path().extension().string();
+        if (ext == ".jpg" || ext == ".jpeg") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& path : files) {
+        std::ifstream in(path, std::ios::binary);
+        frames.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    return frames;
+}
+
+JpegFrames synthesize(int width, int height) {
+    JpegFrames frames;
+    cv::Mat bgr(height, width, CV_8UC3);
+    for (int i = 0; i < 8; ++i) {
+        cv::randu(bgr, cv::Scalar::all(0), cv::Scalar::all(64));
+        cv::circle(bgr, {width / 2 + i * 10, height / 2}, height / 4, {40, 160, 220}, -1);
+        cv::rectangle(bgr, {width / 8, height / 8}, {width / 3, height / 2}, {200, 80, 30}, -1);
+        std::vector<uint8_t> jpeg;
+        cv::imencode(".jpg", bgr, jpeg, {cv::IMWRITE_JPEG_QUALITY, 85});
+        frames.push_back(std::move(jpeg));
+    }
+    return frames;
+}
+
+// state.range(0) 为 0 时使用录制帧，否则为合成帧的高度（宽度按 16:9）
+const JpegFrames& frames_for(const benchmark::State& state) {
+    static JpegFrames recorded = [] {
+        const char* dir = std::getenv("VISION_JPEG_DIR");
+        return dir ? load_recorded(dir) : JpegFrames{};
+    }();
+    static JpegFrames f720 = synthesize(1280, 720);
+    static JpegFrames f1080 = synthesize(1920, 1080);
+    if (state.range(0) == 0) return recorded;
+    return state.range(0) == 720 ? f720 : f1080;
+}
+
+template <typename Fn>
+void run(benchmark::State& state, Fn&& decode) {
+    const auto& frames = frames_for(state);
+    if (frames.empty()) {
+        state.SkipWithError("没有录制帧（设置 VISION_JPEG_DIR）");
+        return;
+    }
+    size_t i = 0, bytes = 0;
+    for (auto _ : state) {
+        const auto& jpeg = frames[i++ % frames.size()];
+        bytes += jpeg.size();
+        decode(jpeg);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+// 现有路径：imdecode 到 BGR，再 cvtColor 到 RGB
+void BM_ImdecodeBgrToRgb(benchmark::State& state) {
+    cv::Mat bgr, rgb;
+    run(state, [&](const std::vector<uint8_t>& jpeg) {
+        cv::imdecode(jpeg, cv::IMREAD_COLOR, &bgr);
+        cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+        benchmark::DoNotOptimize(rgb.data);
+    });
+}
+
+void BM_JpegDecodeRgb(benchmark::State& state) {
+    JpegDecoder decoder;
+    const auto scale = static_cast<JpegDecoder::Scale>(state.range(1));
+    cv::Mat rgb;
+    run(state, [&](const std::vector<uint8_t>& jpeg) {
+        decoder.decode_rgb(jpeg.data(), jpeg.size(), rgb, scale);
+        benchmark::DoNotOptimize(rgb.data);
+    });
+}
+
+void BM_JpegDecodeYuv420p(benchmark::State& state) {
+    JpegDecoder decoder;
+    const auto& frames = frames_for(state);
+    int width = 0, height = 0;
+    if (frames.empty() || !decoder.read_header(frames[0].data(), frames[0].size(), width, height)) {
+        state.SkipWithError("没有可用的 JPEG 帧");
+        return;
+    }
+    std::vector<uint8_t> y(static_cast<size_t>(width) * height);
+    std::vector<uint8_t> u(static_cast<size_t>(width / 2) * ((height + 1) / 2)), v(u.size());
+    Yuv420pPlanes planes{y.data(), width, u.data(), width / 2, v.data(), width / 2};
+    run(state, [&](const std::vector<uint8_t>& jpeg) {
+        decoder.decode_yuv420p(jpeg.data(), jpeg.size(), planes, width, height);
+        benchmark::DoNotOptimize(y.data());
+    });
+}
+
+void JpegArgs(benchmark::internal::Benchmark* b, bool scales) {
+    for (int source : {0, 720, 1080}) {
+        if (!scales) {
+            b->Args({source, 1});
+            continue;
+        }
+        for (int scale : {1, 2, 4, 8}) b->Args({source, scale});
+    }
+    b->ArgNames({"height", "scale"})->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ImdecodeBgrToRgb)->Apply([](benchmark::internal::Benchmark* b) { JpegArgs(b, false); });
+BENCHMARK(BM_JpegDecodeRgb)->Apply([](benchmark::internal::Benchmark* b) { JpegArgs(b, true); });
+BENCHMARK(BM_JpegDecodeYuv420p)->Apply([](benchmark::internal::Benchmark* b) { JpegArgs(b, false); });
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "capture/V4L2Capture.hpp"
+
+// 多摄像头采集引擎：把多个 V4L2Capture 的 fd 注册到少量 epoll 事件循环中，
+// 哪个设备就绪就从哪个设备取帧，并分发给该摄像头的回调。
+// 取代“每个摄像头一个线程 + select + usleep 重试”的做法。
+class CaptureEngine {
+public:
+    // 回调在事件循环线程中执行，应尽快返回（例如把租约放进队列）；
+    // 回调里长时间持有租约会占用驱动缓冲区
+    using FrameCallback = std::function<void(int camera_id, FrameLease frame)>;
+
+    // 单个设备的采集统计
+    struct DeviceStats {
+        uint64_t frames = 0;          // 已分发的帧数
+        uint64_t errors = 0;          // DQBUF/设备错误次数
+        uint64_t driver_drops = 0;    // 根据驱动 sequence 跳号推算的丢帧数
+        double fps = 0.0;             // 由平滑后的帧间隔换算
+        double interval_ms = 0.0;     // 平滑后的取帧间隔
+        double jitter_ms = 0.0;       // 取帧间隔抖动（RFC 3550 式平滑平均偏差）
+    };
+
+    // loop_count: 事件循环（线程）数量，摄像头按注册顺序轮流分配到各循环
+    explicit CaptureEngine(unsigned loop_count = 1);
+    ~CaptureEngine();
+    CaptureEngine(const CaptureEngine&) = delete;
+    CaptureEngine& operator=(const CaptureEngine&) = delete;
+
+    // 注册一个已 initialize() 的摄像头，返回 camera_id；必须在 start() 之前调用。
+    // capture 的生命周期由调用方负责，需长于引擎运行期
+    int add_camera(V4L2Capture& capture, FrameCallback callback);
+    bool start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    unsigned camera_count() const { return static_cast<unsigned>(cameras_.size()); }
+    DeviceStats get_stats(int camera_id) const;
+    // 摄像头是否仍在监听。设备报告 EPOLLERR/EPOLLHUP 或 DQBUF 返回 ENODEV（被拔出）时
+    // 引擎会把它移出 epoll 并置为 false，不再分发帧；调用方可 stop() 后重新
+    // initialize() 该设备再 start()（start() 会按当前 fd 重新注册所有摄像头）
+    bool is_alive(int camera_id) const;
+
+private:
+    struct Camera {
+        V4L2Capture* capture = nullptr;
+        FrameCallback callback;
+        unsigned loop = 0;
+        // 统计量只由所属事件循环线程写入，其他线程读取
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> driver_drops{0};
+        std::atomic<double> interval_ms{0.0};
+        std::atomic<double> jitter_ms{0.0};
+        std::atomic<bool> alive{false};
+        // 以下仅事件循环线程访问
+        int64_t last_dequeue_ns = 0;
+        uint32_t last_sequence = 0;
+        bool has_sequence = false;
+    };
+    struct Loop {
+        int epoll_fd = -1;
+        int wake_fd = -1;  // eventfd，stop() 时用于唤醒 epoll_wait
+        std::thread thread;
+    };
+
+    void run_loop(Loop& loop);
+    // fd 就绪后取空该设备所有已完成的帧
+    void drain_camera(Loop& loop, int camera_id);
+    // 设备失效：移出 epoll，避免持续触发
+    void drop_camera(Loop& loop, int camera_id, const char* reason);
+
+    std::vector<std::unique_ptr<Camera>> cameras_;
+    std::vector<Loop> loops_;
+    std::atomic<bool> running_{false};
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include <linux/videodev2.h>
+
+// 驱动缓冲区中一帧数据的只读视图：data 直接指向 mmap 映射的内存，不做拷贝。
+// 合成源与回放源也用同一个结构交付帧（data 指向源自己的内存）
+struct V4L2FrameView {
+    const uint8_t* data = nullptr;  // 指向 mapped_buffers_[index]（或用户缓冲区）
+    size_t bytesused = 0;           // 本帧有效字节数（buf.bytesused）
+    uint32_t index = 0;             // 驱动缓冲区编号
+    uint32_t sequence = 0;          // 驱动帧序号，不连续说明驱动侧丢帧
+    timeval timestamp{};            // 驱动采集时间戳（buf.timestamp）
+    // 采集时间，CLOCK_MONOTONIC 纳秒（与 std::chrono::steady_clock 同一时钟）。
+    // 取自驱动时间戳；驱动时间戳不是单调时钟或为 0 时退回 DQBUF 时刻
+    int64_t capture_ns = 0;
+};
+
+// 帧租约：最后一个持有者释放时才把缓冲区重新入队（VIDIOC_QBUF）。
+// 注意：V4L2Capture 的租约不能比它活得更久，析构前应释放全部租约
+//（合成源与回放源的租约可以比源活得更久）。
+using FrameLease = std::shared_ptr<const V4L2FrameView>;
+
+// 帧源的出帧节奏
+enum class Pacing {
+    RealTime,   // 按源的时钟出帧；消费者跟不上时像摄像头一样跳过帧（sequence 跳号）
+    FixedRate,  // 按固定帧率出帧，但从不跳帧：消费者慢时整体变慢
+    Unpaced,    // 不等待，尽快出帧，用于测量流水线的最大吞吐
+};
+
+// "realtime" / "fixed" / "unpaced"，未知名字返回 false
+bool parse_pacing(const std::string& name, Pacing& pacing);
+const char* pacing_name(Pacing pacing);
+
+// 帧来源接口：V4L2Capture（摄像头）、SyntheticSource（合成画面）、
+// ReplaySource（原始 YUYV/MJPEG 转储回放）。
+// 后两者不需要摄像头，应用与测试可以在构建机/CI 上无头运行并测量吞吐。
+// 同一个帧源上的 acquire_frame 不应被多个线程并发调用
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // 以下两项需在 initialize() 之前调用
+    // 像素格式（V4L2_PIX_FMT_YUYV / V4L2_PIX_FMT_MJPEG）
+    virtual void set_pixel_format(uint32_t fourcc) = 0;
+    // 可同时借出的帧数（驱动缓冲区数量）；全部被下游持有时取帧会等待
+    virtual void set_buffer_count(unsigned count) = 0;
+
+    virtual bool initialize(unsigned width = 1280, unsigned height = 720) = 0;
+    // 实际生效的格式与分辨率（initialize() 之后有效，可能与请求值不同）
+    virtual uint32_t get_pixel_format() const = 0;
+    virtual unsigned get_width() const = 0;
+    virtual unsigned get_height() const = 0;
+
+    // 零拷贝取帧：等待最多 timeout_ms 毫秒，失败、超时或已结束时返回空租约
+    virtual FrameLease acquire_frame(int timeout_ms = 2000) = 0;
+    // 低延迟取帧：每次 acquire_frame 把已完成的帧全部取出，只交付最新的一帧，
+    // 更早的立即归还给源并计入 stale_dropped()。消费者偶尔变慢时不再从最旧的帧开始追赶，
+    // 采集到显示的延迟不会随积压的缓冲区数增长。
+    // 不支持的源返回 false（合成/回放源的 RealTime 节奏本来就会跳过错过的帧）
+    virtual bool set_latest_frame_mode(bool enabled) { return !enabled; }
+    // 低延迟模式下因有更新的帧而丢弃的帧数，可在其他线程读取
+    virtual uint64_t stale_dropped() const { return 0; }
+    // 有限长度的源（回放、设定了帧数的合成源）已交付全部帧；摄像头始终为 false
+    virtual bool finished() const { return false; }
+    // 日志用的简短描述
+    virtual std::string describe() const = 0;
+
+    // 读取一帧并拷贝到 buffer 中（兼容旧接口）。
+    // info 不为空时填入帧序号与时间戳（info->data 置空，像素只在 buffer 中）
+    bool capture_frame(std::vector<uint8_t>& buffer, V4L2FrameView* info = nullptr);
+};
+
+// 合成源与回放源共用的出帧节奏控制。
+// RealTime 与 FixedRate 按 fps 排定第 i 帧的出帧时刻 start + i / fps；
+// RealTime 在落后超过一帧时跳过错过的帧号，Unpaced 不等待
+class FramePacer {
+public:
+    // 第 i 帧相对第一帧的出帧时刻（纳秒），必须单调不减
+    using Timeline = std::function<int64_t(uint64_t)>;
+
+    FramePacer(Pacing pacing = Pacing::RealTime, double fps = 30.0);
+
+    // RealTime 模式按给定时间线出帧（例如录制时的采集时间），代替固定帧间隔
+    void set_timeline(Timeline timeline);
+
+    // 取下一帧的帧号，并等待到它的出帧时刻（steady_clock 纳秒，写入 due_ns）。
+    // 出帧时刻晚于 deadline 时等到 deadline 后返回 false，帧号不被消耗
+    bool next(std::chrono::steady_clock::time_point deadline, uint64_t& index, int64_t& due_ns);
+    // RealTime 模式下因落后而跳过的帧数
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+    Pacing pacing() const { return pacing_; }
+
+private:
+    Pacing pacing_;
+    int64_t period_ns_;
+    int64_t start_ns_ = -1;  // 第一次取帧的时刻
+    uint64_t next_ = 0;
+    Timeline timeline_;
+    std::atomic<uint64_t> skipped_{0};  // 其他线程可读
+};
+
+// 合成源与回放源用来模拟驱动的固定缓冲区数：最多同时借出 count 个槽位，
+// 租约释放时归还。以 shared_ptr 持有，租约可以比帧源活得更久
+class LeaseSlots {
+public:
+    explicit LeaseSlots(unsigned count);
+
+    // 取一个空闲槽位，全部借出时等到 deadline，超时返回 -1
+    int acquire(std::chrono::steady_clock::time_point deadline);
+    void release(unsigned index);
+    unsigned leased() const;
+    unsigned count() const { return static_cast<unsigned>(busy_.size()); }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<bool> busy_;
+    unsigned leased_ = 0;
+};
+
+// 应用选择帧源时的公共参数
+struct FrameSourceOptions {
+    Pacing pacing = Pacing::RealTime;
+    double fps = 30.0;
+    // 交付的总帧数：0 表示源的自然长度（合成源无限，回放源播放一遍）；
+    // 回放源大于文件帧数时循环播放
+    uint64_t frame_limit = 0;
+};
+
+// 按描述创建帧源：
+//   "synthetic"         合成的移动画面
+//   "synthetic:static"  静止画面（每帧内容相同）
+//   "replay:<文件>"     回放原始转储（YUYV 逐帧拼接，或 MJPEG 逐个 JPEG 拼接）
+//   其他                视为 V4L2 设备路径，例如 /dev/video0（打开失败时抛出 std::runtime_error）
+std::unique_ptr<FrameSource> open_frame_source(const std::string& spec,
+                                               const FrameSourceOptions& options = {});
@@ -0,0 +1,176 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture/FrameSource.hpp"
+
+// 无损录制摄像头原始数据（YUYV/MJPEG 负载原样保存）的文件格式，用于复现线上性能问题：
+//
+//   [文件头 4096 字节][帧记录 ...][帧索引]
+//   帧记录 = 64 字节记录头 + 负载，按 64 字节对齐（负载地址满足 SIMD 对齐）
+//   帧索引 = 每帧 24 字节（偏移、长度、驱动序号、采集时间），第 i 帧的位置 O(1) 可得
+//
+// 文件头记录格式、分辨率、帧数与索引位置；写完时才置 finalized。
+// 进程中途退出时没有索引，读取端按记录头顺序扫描重建（直到第一个无效记录）。
+// 所有整数为小端序。
+struct RawCaptureHeader {
+    char magic[8];           // "VSRAWCAP"
+    uint32_t version;        // kRawCaptureVersion
+    uint32_t header_bytes;   // 第一条帧记录的偏移（4096）
+    uint32_t fourcc;         // V4L2_PIX_FMT_YUYV / V4L2_PIX_FMT_MJPEG
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;          // kRawCaptureFinalized
+    uint64_t frame_count;    // finalized 时有效
+    uint64_t index_offset;   // finalized 时有效
+    uint64_t data_end;       // 最后一条帧记录之后的偏移
+};
+
+struct RawFrameRecord {
+    uint32_t magic;          // kRawFrameMagic
+    uint32_t bytes;          // 负载长度
+    uint32_t sequence;       // 驱动帧序号
+    uint32_t reserved;
+    int64_t capture_ns;      // 采集时间（CLOCK_MONOTONIC 纳秒）
+    uint8_t padding[40];     // 记录头补齐到 64 字节
+};
+
+struct RawIndexEntry {
+    uint64_t offset;         // 负载在文件中的偏移
+    uint32_t bytes;
+    uint32_t sequence;
+    int64_t capture_ns;
+};
+
+constexpr uint32_t kRawCaptureVersion = 1;
+constexpr uint32_t kRawCaptureFinalized = 1u << 0;
+constexpr uint32_t kRawFrameMagic = 0x4D524656;  // "VFRM"
+constexpr size_t kRawCaptureHeaderBytes = 4096;
+constexpr size_t kRawRecordAlign = 64;
+static_assert(sizeof(RawFrameRecord) == 64, "帧记录头必须是 64 字节");
+static_assert(sizeof(RawIndexEntry) == 24, "索引项必须是 24 字节");
+
+// 追加写入端。append() 只把帧拷贝进当前的大块缓冲区（不做系统调用），
+// 块写满后交给写出线程一次 pwrite，磁盘上是连续的大块顺序写。
+// 文件按 preallocate_bytes 逐段 fallocate 预分配，减少元数据更新与碎片，close() 时释放多余部分。
+// 写出线程落后、没有空闲块时丢弃新帧并计数，从不阻塞采集线程。
+// append() 只能在一个线程中调用
+class RawCaptureWriter {
+public:
+    struct Options {
+        uint64_t preallocate_bytes = 1ull << 30;  // 每次预分配的长度
+        size_t chunk_bytes = 32u << 20;           // 每次 pwrite 的块大小（单帧更大时按帧扩大）
+        unsigned chunks = 4;                      // 块的总数（含正在填充的一块）
+    };
+    struct Stats {
+        uint64_t frames = 0;         // 已写入（或在块中等待写入）的帧数
+        uint64_t dropped = 0;        // 没有空闲块而丢弃的帧数
+        uint64_t bytes_written = 0;  // 已落到文件的字节数
+        uint64_t writes = 0;         // pwrite 次数
+    };
+
+    // 创建（覆盖）文件并写入未完成的文件头；失败时抛出 std::runtime_error
+    RawCaptureWriter(const std::string& path, uint32_t fourcc, unsigned width, unsigned height,
+                     Options options);
+    RawCaptureWriter(const std::string& path, uint32_t fourcc, unsigned width, unsigned height)
+        : RawCaptureWriter(path, fourcc, width, height, Options{}) {}
+    ~RawCaptureWriter();
+    RawCaptureWriter(const RawCaptureWriter&) = delete;
+    RawCaptureWriter& operator=(const RawCaptureWriter&) = delete;
+
+    // 追加一帧（拷贝 frame.data 的 bytesused 字节）；被丢弃时返回 false
+    bool append(const V4L2FrameView& frame);
+    // 写完剩余数据、索引与文件头并关闭文件；可重复调用
+    bool close();
+    Stats stats() const;
+
+private:
+    struct Chunk {
+        std::vector<uint8_t> data;
+        size_t used = 0;
+        uint64_t file_offset = 0;
+    };
+
+    // 把当前块交给写出线程；没有当前块时什么也不做
+    void submit_current();
+    void run_writer();
+    bool write_all(const uint8_t* data, size_t size, uint64_t offset);
+    void ensure_allocated(uint64_t end);
+
+    std::string path_;
+    Options options_;
+    int fd_ = -1;
+    RawCaptureHeader header_{};
+
+    // 以下只在调用 append 的线程访问
+    std::unique_ptr<Chunk> current_;
+    uint64_t next_offset_ = kRawCaptureHeaderBytes;
+    std::vector<RawIndexEntry> index_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Chunk>> free_chunks_;
+    std::deque<std::unique_ptr<Chunk>> pending_;
+    bool stopping_ = false;
+    bool write_failed_ = false;
+    std::thread writer_;
+    uint64_t allocated_ = 0;  // 只在写出线程访问
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> writes_{0};
+    bool closed_ = false;
+};
+
+// 读取端：整个文件 mmap 只读映射，frame(i) 直接返回映射内的指针（零拷贝），索引同样在映射中
+class RawCaptureReader {
+public:
+    struct Frame {
+        const uint8_t* data = nullptr;
+        size_t bytes = 0;
+        uint32_t sequence = 0;
+        int64_t capture_ns = 0;
+    };
+
+    // 文件无法打开或不是本格式时抛出 std::runtime_error
+    explicit RawCaptureReader(const std::string& path);
+    ~RawCaptureReader();
+    RawCaptureReader(const RawCaptureReader&) = delete;
+    RawCaptureReader& operator=(const RawCaptureReader&) = delete;
+
+    // 文件是否以本格式的 magic 开头（只读前 8 个字节）
+    static bool probe(const std::string& path);
+
+    uint32_t fourcc() const { return header_.fourcc; }
+    unsigned width() const { return header_.width; }
+    unsigned height() const { return header_.height; }
+    size_t frame_count() const { return count_; }
+    // false 表示录制未正常结束，索引是扫描记录头重建的
+    bool finalized() const { return (header_.flags & kRawCaptureFinalized) != 0; }
+
+    // O(1) 随机访问，i 必须小于 frame_count()
+    Frame frame(size_t i) const;
+    // 第一个 capture_ns >= t 的帧号（二分查找），全部早于 t 时返回 frame_count()
+    size_t seek_time(int64_t capture_ns) const;
+
+private:
+    const RawIndexEntry& entry(size_t i) const {
+        return index_ ? index_[i] : rebuilt_index_[i];
+    }
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    RawCaptureHeader header_{};
+    const RawIndexEntry* index_ = nullptr;     // finalized 时指向映射中的索引
+    std::vector<RawIndexEntry> rebuilt_index_;  // 否则为扫描重建的索引
+    size_t count_ = 0;
+};
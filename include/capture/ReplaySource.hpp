@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "capture/FrameSource.hpp"
+#include "capture/RawCapture.hpp"
+
+// 回放原始转储（例如 v4l2-ctl --stream-to 的输出）：
+// - YUYV：逐帧拼接，每帧 width * height * 2 字节，分辨率由 initialize() 给出；
+// - MJPEG：逐个 JPEG 拼接，按 SOI/EOI 标记切分，分辨率取自第一帧；
+// - RawCaptureWriter 录制的文件（RawCapture.hpp）：格式、分辨率、驱动序号与采集时间都取自文件。
+// 格式由文件内容判断（以 FF D8 FF 开头为 MJPEG），与 set_pixel_format 不一致时以文件为准。
+// 文件整个 mmap 只读映射，租约直接指向映射内存（零拷贝），映射在最后一个租约释放后才解除。
+// 裸转储不带时间戳，RealTime / FixedRate 都按 options.fps 出帧；
+// 录制文件在 RealTime 下按录制时的帧间隔出帧（循环时首尾间隔取平均帧间隔），FixedRate 仍按 fps
+class ReplaySource : public FrameSource {
+public:
+    explicit ReplaySource(std::string path, FrameSourceOptions options = {});
+
+    void set_pixel_format(uint32_t fourcc) override { pixel_format_ = fourcc; }
+    void set_buffer_count(unsigned count) override { buffer_count_ = count ? count : 1; }
+    // 文件不存在、为空或不足一帧时返回 false
+    bool initialize(unsigned width = 1280, unsigned height = 720) override;
+    uint32_t get_pixel_format() const override { return pixel_format_; }
+    unsigned get_width() const override { return width_; }
+    unsigned get_height() const override { return height_; }
+
+    FrameLease acquire_frame(int timeout_ms = 2000) override;
+    bool finished() const override { return finished_.load(std::memory_order_relaxed); }
+    std::string describe() const override;
+
+    // 文件中的帧数
+    size_t frame_count() const { return raw_ ? raw_->frame_count() : frames_.size(); }
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    uint64_t skipped() const { return pacer_.skipped(); }
+    unsigned get_leased_count() const { return slots_ ? slots_->leased() : 0; }
+
+private:
+    // 只读映射，析构时 munmap
+    struct Mapping {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        ~Mapping();
+    };
+
+    // 按 SOI (FF D8 FF) 切分 MJPEG 流，只接受以 EOI (FF D9) 结尾的完整 JPEG
+    void index_mjpeg();
+    // 打开 RawCaptureWriter 录制的文件
+    bool initialize_recording();
+
+    std::string path_;
+    FrameSourceOptions options_;
+    uint32_t pixel_format_ = V4L2_PIX_FMT_YUYV;
+    unsigned buffer_count_ = 4;
+    unsigned width_ = 0, height_ = 0;
+
+    std::shared_ptr<const Mapping> mapping_;
+    std::vector<std::pair<size_t, size_t>> frames_;  // 每帧的偏移与长度
+    std::shared_ptr<const RawCaptureReader> raw_;     // 录制文件（此时不用 mapping_/frames_）
+    uint32_t sequence_span_ = 0;                      // 录制文件循环一遍驱动序号的增量
+    std::shared_ptr<LeaseSlots> slots_;
+    FramePacer pacer_;
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<bool> finished_{false};
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "capture/FrameSource.hpp"
+
+// 合成帧源：任意分辨率的 YUYV 或 MJPEG 移动画面（渐变 + 棋盘格，逐帧水平滚动）。
+// YUYV 每帧按行从预先生成的两倍宽图案中拷贝，开销接近 memcpy，不会成为被测瓶颈；
+// MJPEG 在 initialize() 时预先编码一个循环周期的帧，取帧时零拷贝交付。
+// motion 为 false 时每帧内容完全相同（用于静止场景）
+class SyntheticSource : public FrameSource {
+public:
+    explicit SyntheticSource(FrameSourceOptions options = {}, bool motion = true);
+
+    void set_pixel_format(uint32_t fourcc) override { pixel_format_ = fourcc; }
+    void set_buffer_count(unsigned count) override { buffer_count_ = count ? count : 1; }
+    // width 必须为偶数（YUYV 两个像素共用一组色度）
+    bool initialize(unsigned width = 1280, unsigned height = 720) override;
+    uint32_t get_pixel_format() const override { return pixel_format_; }
+    unsigned get_width() const override { return width_; }
+    unsigned get_height() const override { return height_; }
+
+    FrameLease acquire_frame(int timeout_ms = 2000) override;
+    bool finished() const override { return finished_.load(std::memory_order_relaxed); }
+    std::string describe() const override;
+
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    // RealTime 模式下消费者跟不上而跳过的帧数
+    uint64_t skipped() const { return pacer_.skipped(); }
+    unsigned get_leased_count() const { return slots_ ? slots_->leased() : 0; }
+
+    // 生成第 index 帧的 YUYV 数据到 dst（stride = width * 2），供测试与基准直接使用
+    void render_yuyv(uint64_t index, uint8_t* dst) const;
+
+private:
+    // MJPEG 循环周期的帧数；静止画面只编码一帧
+    static constexpr unsigned kJpegCycle = 30;
+
+    FrameSourceOptions options_;
+    bool motion_;
+    uint32_t pixel_format_ = V4L2_PIX_FMT_YUYV;
+    unsigned buffer_count_ = 4;
+    unsigned width_ = 0, height_ = 0;
+
+    // 两倍宽的 YUYV 图案，第 i 帧从第 (i * 4) % width 列开始截取
+    std::vector<uint8_t> pattern_;
+    // YUYV：每个槽位一块帧缓冲区；租约持有 shared_ptr，可以比源活得更久
+    std::shared_ptr<std::vector<std::vector<uint8_t>>> yuyv_buffers_;
+    std::shared_ptr<const std::vector<std::vector<uint8_t>>> jpeg_frames_;
+    std::shared_ptr<LeaseSlots> slots_;
+    FramePacer pacer_;
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<bool> finished_{false};
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 应用自己持有的一组页对齐缓冲区，供 V4L2_MEMORY_USERPTR 模式使用。
+// 驱动直接把图像写进这些内存，同一块内存随后可以直接作为 cv::Mat
+// 或 AVFrame 的数据指针（页对齐同时满足 SIMD/FFmpeg 的对齐要求），无需拷贝。
+// 缓冲池必须比使用它的 V4L2Capture 活得更久。
+class UserBufferPool {
+public:
+    // count: 缓冲区个数；buffer_size: 每个缓冲区至少需要的字节数（会向上取整到页大小）
+    UserBufferPool(unsigned count, size_t buffer_size);
+    ~UserBufferPool();
+    UserBufferPool(const UserBufferPool&) = delete;
+    UserBufferPool& operator=(const UserBufferPool&) = delete;
+
+    unsigned count() const { return static_cast<unsigned>(buffers_.size()); }
+    // 每个缓冲区的实际长度（页对齐后）
+    size_t buffer_size() const { return buffer_size_; }
+    uint8_t* data(unsigned index) const { return buffers_[index]; }
+
+private:
+    size_t buffer_size_ = 0;
+    std::vector<uint8_t*> buffers_;
+};
@@ -1,34 +1,112 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
+#include <sys/time.h>
 #include <linux/videodev2.h>
 
+#include "capture/FrameSource.hpp"
+#include "capture/UserBufferPool.hpp"
+
 // 对底层 Linux 视频接口进行抽象，方便上层逻辑调用
-class V4L2Capture {
+class V4L2Capture : public FrameSource {
 public:
+    // 缓冲区内存来源：驱动分配后 mmap 映射，或由应用提供（USERPTR）
+    enum class MemoryMode { MMAP, USERPTR };
+
     explicit V4L2Capture(const std::string& device = "/dev/video0");
-    ~V4L2Capture();
+    ~V4L2Capture() override;
+    V4L2Capture(const V4L2Capture&) = delete;
+    V4L2Capture& operator=(const V4L2Capture&) = delete;
     // 用于执行：
     // 设置格式（调用 set_format()）；
     // 设置缓冲区并映射（调用 init_mmap()）；
     // 开启视频采集流（一般需 VIDIOC_STREAMON）
-    bool initialize(unsigned width = 1280, unsigned height = 720);
-    // 从摄像头中读取一帧数据，并保存到 buffer 中
-    bool capture_frame(std::vector<uint8_t>& buffer);
-    unsigned get_width() const { return width_; }
-    unsigned get_height() const { return height_; }
-    
+    bool initialize(unsigned width = 1280, unsigned height = 720) override;
+    // 设置向驱动申请的缓冲区数量，需在 initialize() 之前调用。
+    // 下游持有租约越久，需要的缓冲区越多，否则驱动无空闲缓冲区可写。
+    void set_buffer_count(unsigned count) override { requested_buffers_ = count; }
+    // 选择缓冲区内存模式，需在 initialize() 之前调用。
+    // USERPTR 模式下 pool 为空时按驱动报告的 sizeimage 自动创建缓冲池；
+    // 驱动不支持 USERPTR 时 initialize() 会自动退回 MMAP。
+    void set_memory_mode(MemoryMode mode,
+                         std::shared_ptr<UserBufferPool> pool = nullptr);
+    // 选择像素格式（V4L2_PIX_FMT_YUYV / V4L2_PIX_FMT_MJPEG 等），需在 initialize() 之前调用。
+    // 大多数 USB 摄像头在 1080p 下只有 MJPEG 能跑满帧率
+    void set_pixel_format(uint32_t fourcc) override { pixel_format_ = fourcc; }
+    uint32_t get_pixel_format() const override { return pixel_format_; }
+    // 实际生效的内存模式（initialize() 之后有效）
+    MemoryMode get_memory_mode() const { return memory_mode_; }
+    // 零拷贝取帧：等待最多 timeout_ms 毫秒，失败返回空租约
+    FrameLease acquire_frame(int timeout_ms = 2000) override;
+    // 低延迟模式（见 FrameSource::set_latest_frame_mode）：poll 唤醒后连续 DQBUF 直到 EAGAIN，
+    // 只保留序号最新的一帧，其余缓冲区立即 QBUF 回驱动。缓冲区数越多，慢消费者
+    // 越容易积压，stale_dropped() 持续增长说明可以减少 set_buffer_count
+    bool set_latest_frame_mode(bool enabled) override {
+        latest_frame_ = enabled;
+        return true;
+    }
+    uint64_t stale_dropped() const override {
+        return stale_dropped_.load(std::memory_order_relaxed);
+    }
+    // 非阻塞取帧：没有已完成的帧时立即返回空租约，供 epoll 等事件循环在 fd 可读后调用。
+    // error 非空时写入结果：成功为 0，没有已完成的帧为 EAGAIN，其余为 DQBUF 的 errno。
+    // 调用方应使用该值而不是事后读取 errno（中间的回调可能已改写 errno）
+    FrameLease try_acquire_frame(int* error = nullptr);
+    // 设备文件描述符，用于注册到 epoll/poll
+    int get_fd() const { return fd_; }
+    // capture_frame()（拷贝整帧的旧接口）由 FrameSource 基于 acquire_frame 实现
+    unsigned get_width() const override { return width_; }
+    unsigned get_height() const override { return height_; }
+    std::string describe() const override;
+    // 驱动实际分配的缓冲区数量（可能与请求值不同）
+    unsigned get_buffer_count() const {
+        return static_cast<unsigned>(mapped_buffers_.size());
+    }
+    // 当前被下游持有、尚未归还给驱动的缓冲区数量
+    unsigned get_leased_count() const;
+
 private:
+    // 租约释放时需要访问的共享状态；V4L2Capture 析构后租约不再 QBUF
+    struct LeaseState {
+        int fd = -1;
+        v4l2_memory memory = V4L2_MEMORY_MMAP;
+        // USERPTR 模式下 QBUF 需要带上缓冲区地址与长度，初始化后只读
+        std::vector<void*> user_ptrs;
+        std::vector<size_t> user_lengths;
+        std::atomic<unsigned> leased{0};
+    };
+    // 把 index 号缓冲区重新交给驱动
+    static void requeue(LeaseState& state, uint32_t index);
+
+    std::string device_;  // 设备路径，日志用
     // 摄像头设备文件描述符
     int fd_ = -1;
     unsigned width_ = 0;
     unsigned height_ = 0;
+    unsigned requested_buffers_ = 4;
+    uint32_t pixel_format_ = V4L2_PIX_FMT_YUYV;
+    // 驱动报告的单帧最大字节数（VIDIOC_S_FMT 返回的 sizeimage）
+    size_t size_image_ = 0;
+    MemoryMode memory_mode_ = MemoryMode::MMAP;
+    bool latest_frame_ = false;
+    std::atomic<uint64_t> stale_dropped_{0};
+    std::shared_ptr<UserBufferPool> user_pool_;
+    std::shared_ptr<LeaseState> lease_state_;
     // 存储映射缓冲区地址列表，通常使用 mmap() 映射 V4L2 的缓冲区
     // 用于存取图像数据，而不必每次都 read()，性能更高
+    // USERPTR 模式下保存的是用户缓冲池中的地址（析构时不 munmap）
     std::vector<void*> mapped_buffers_;
     // 添加每个 mmap buffer 的长度
-    std::vector<size_t> buffer_lengths_;  
+    std::vector<size_t> buffer_lengths_;
     // 配置缓存方式为 mmap（即使用 VIDIOC_REQBUFS 请求缓冲区，VIDIOC_QUERYBUF 查询每个缓冲区信息，然后用 mmap 映射）
     bool init_mmap();
+    // 配置缓存方式为 USERPTR：驱动直接写入 user_pool_ 中的缓冲区。
+    // 驱动拒绝 USERPTR 时返回 false 且不改变任何状态
+    bool init_userptr();
+    // 把全部缓冲区入队并开启采集流
+    bool start_streaming();
     bool set_format(unsigned width, unsigned height);
-};
\ No newline at end of file
+};
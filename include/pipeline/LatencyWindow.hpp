@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 滚动窗口延迟统计：只保留最近 capacity 个样本（环形覆盖），查询时在窗口内
+// 计算分位数，反映的是最近一段时间而不是整个运行期的延迟分布。
+// add() 无锁，每帧都调用也不会让多个工作线程在同一把锁上排队；summary() 复制并
+// 排序窗口，适合周期性上报时调用。summary() 与并发的 add() 之间不同步，
+// 窗口中个别样本可能是刚被覆盖前的旧值，对分位数统计没有影响。线程安全。
+class LatencyWindow {
+public:
+    struct Summary {
+        uint64_t count = 0;   // 累计样本数（含已滑出窗口的）
+        double sum = 0.0;     // 累计样本总和（含已滑出窗口的）
+        size_t window = 0;    // 当前窗口内的样本数
+        double avg = 0.0;     // 以下均为窗口内统计
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    explicit LatencyWindow(size_t capacity = 1024)
+        : capacity_(std::max<size_t>(1, capacity)),
+          samples_(new std::atomic<double>[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            samples_[i].store(0.0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(double value) {
+        // 先占一个槽位再写入，多个写者各写各的槽
+        const uint64_t n = count_.fetch_add(1, std::memory_order_relaxed);
+        samples_[n % capacity_].store(value, std::memory_order_relaxed);
+        double sum = sum_.load(std::memory_order_relaxed);
+        while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+        }
+    }
+
+    Summary summary() const {
+        Summary s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum = sum_.load(std::memory_order_relaxed);
+        std::vector<double> sorted(static_cast<size_t>(std::min<uint64_t>(s.count, capacity_)));
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            sorted[i] = samples_[i].load(std::memory_order_relaxed);
+        }
+        s.window = sorted.size();
+        if (sorted.empty()) return s;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double v : sorted) total += v;
+        s.avg = total / sorted.size();
+        s.p50 = percentile(sorted, 0.50);
+        s.p90 = percentile(sorted, 0.90);
+        s.p99 = percentile(sorted, 0.99);
+        s.max = sorted.back();
+        return s;
+    }
+
+private:
+    // 最近秩法：不小于 p 比例样本的最小值
+    static double percentile(const std::vector<double>& sorted, double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    const size_t capacity_;
+    std::unique_ptr<std::atomic<double>[]> samples_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<double> sum_{0.0};
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 过载时的分级降载：周期性比较各阶段的单帧耗时与帧期限（1 / target_fps），
+// 最忙的阶段持续超出期限时升一级，持续空闲时降一级。各级逐级叠加：
+//   ReducedResolution  算法在缩小的亮度上运行，结果放大回原尺寸（见 OpenCVProcessor::set_pyramid_level）
+//   FrameSkip          只处理每 N 帧中的一帧，其余帧按静止帧重复上一次的输出
+//   EncoderReduced     跳帧间隔再加倍，送入编码器的帧率减半；码率同比例下调
+//                      （见 RTMPStreamer::SetBitRateScale），单帧质量大致不变。
+//                      只降码率不减少编码的 CPU 开销，因此这一级必须同时降帧率
+// 降级后负载下降是预期的，恢复阈值远低于降级阈值；恢复后很快又过载时
+// 下一次恢复需要等待的时间加倍，避免在两级之间来回抖动。
+//
+// update() 由同一个线程周期调用；level() 可以在任意线程读取，stats() 线程安全
+class LoadGovernor {
+public:
+    enum class Level { Full = 0, ReducedResolution, FrameSkip, EncoderReduced };
+    static constexpr int kLevelCount = 4;
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double target_fps = 30.0;
+        double degrade_load = 0.95;    // 单帧耗时 / (工作线程数 x 帧期限) 超过它算过载
+        double recover_load = 0.6;     // 低于它算空闲
+        double degrade_seconds = 1.0;  // 持续过载这么久才升级
+        double recover_seconds = 5.0;  // 持续空闲这么久才降级（抖动时按倍数延长，最多 8 倍）
+        int max_level = 3;             // 最高允许的级别
+    };
+
+    // 某个阶段从启动以来的累计值，例如 Pipeline::StageStats 中的对应字段
+    struct StageSample {
+        std::string name;
+        unsigned workers = 1;
+        double busy_ms = 0.0;
+        uint64_t processed = 0;
+    };
+
+    struct Stats {
+        Level level = Level::Full;
+        double load = 0.0;           // 最近一次 update 时最忙阶段的负载
+        std::string bottleneck;      // 最忙阶段的名字
+        uint64_t transitions = 0;    // 级别变化次数（升、降都算）
+        std::array<double, kLevelCount> level_seconds{};  // 在各级别停留的累计时间
+    };
+
+    explicit LoadGovernor(Options options);
+    LoadGovernor() : LoadGovernor(Options{}) {}
+
+    // 输入各阶段的累计统计（不要包含阻塞等待输入的源阶段），返回本次是否改变了级别。
+    // 与上一次调用之间没有新处理的帧的阶段不参与判断
+    bool update(const std::vector<StageSample>& stages, Clock::time_point now = Clock::now());
+
+    Level level() const { return level_.load(std::memory_order_relaxed); }
+    Stats stats() const;
+    const Options& options() const { return options_; }
+
+    static const char* level_name(Level level);
+
+private:
+    void change_level(Level level, Clock::time_point now);
+
+    Options options_;
+    std::atomic<Level> level_{Level::Full};
+
+    // 以下只在调用 update 的线程访问
+    std::vector<StageSample> previous_;
+    bool started_ = false;
+    Clock::time_point last_update_;
+    Clock::time_point over_since_, under_since_;
+    bool over_ = false, under_ = false;
+    Clock::time_point last_recovery_;
+    bool recovered_ = false;
+    double recover_backoff_ = 1.0;
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "pipeline/LatencyWindow.hpp"
+
+// Prometheus 文本格式（text/plain; version=0.0.4）的构造器。
+// 同一个指标名的所有样本必须连续写出，HELP/TYPE 只在第一次出现时写。
+// labels 为已格式化的标签，例如 stage="encode"
+class MetricsText {
+public:
+    void counter(const std::string& name, const std::string& help, double value,
+                 const std::string& labels = "");
+    void gauge(const std::string& name, const std::string& help, double value,
+               const std::string& labels = "");
+    // 滚动窗口分位数（0.5 / 0.9 / 0.99）与累计的 _sum / _count，
+    // 后两者可用于 rate(x_sum) / rate(x_count) 求区间平均值
+    void summary(const std::string& name, const std::string& help,
+                 const LatencyWindow::Summary& s, const std::string& labels = "");
+
+    const std::string& str() const { return out_; }
+
+private:
+    void declare(const std::string& name, const std::string& help, const char* type);
+    void sample(const std::string& name, const std::string& labels, double value);
+
+    std::set<std::string> declared_;
+    std::string out_;
+};
+
+// 周期性导出运行指标：
+// - file_path 非空时每 interval_s 秒写一次文件（先写临时文件再 rename，
+//   node_exporter 的 textfile collector 不会读到半个文件）；
+// - http_port 非 0 时在 127.0.0.1 上提供 GET /metrics（只监听回环地址）。
+// collector 在导出线程中调用，其中读取的统计必须是线程安全的。
+class MetricsExporter {
+public:
+    using Collector = std::function<void(MetricsText&)>;
+
+    struct Options {
+        std::string file_path;
+        int http_port = 0;
+        double interval_s = 5.0;
+    };
+
+    // 端口监听失败时抛出 std::runtime_error
+    MetricsExporter(Collector collector, Options options);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    std::string render() const;
+    bool write_file() const;
+    // 实际监听的端口（http_port 为 0 时返回 0）
+    int port() const { return port_; }
+
+private:
+    void run();
+    void serve_client(int fd) const;
+
+    Collector collector_;
+    Options options_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
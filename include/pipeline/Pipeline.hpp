@@ -0,0 +1,299 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pipeline/LatencyWindow.hpp"
+#include "pipeline/Tracer.hpp"
+#include "queue/FrameRing.hpp"
+
+// 多阶段流水线执行器：capture → decode → algorithm → convert → encode → mux。
+// 每个阶段是一个节点，拥有自己的工作线程数，阶段之间用有界 MPMC 环形队列连接。
+// 源头为每帧分配递增的序号，并行阶段会打乱顺序，标记为 ordered 的阶段在执行前
+// 按序号重新排序（编码器必须按顺序收帧）。
+//
+// T 需要可默认构造、可无异常移动，并包含 uint64_t seq 成员。
+template <typename T>
+class Pipeline {
+public:
+    // 源函数：填充一帧，返回 false 表示源结束（例如收到退出信号）
+    using SourceFn = std::function<bool(T&)>;
+    // 阶段函数：处理一帧，返回 false 表示丢弃该帧（不再交给后续阶段）
+    using StageFn = std::function<bool(T&)>;
+    // 为每个工作线程创建一份独立的阶段函数，便于持有线程私有状态
+    using StageFactory = std::function<StageFn()>;
+
+    struct StageOptions {
+        std::string name;
+        unsigned workers = 1;
+        // 执行前按序号重排；只能有一个工作线程
+        bool ordered = false;
+        // 本阶段输入队列容量
+        size_t queue_capacity = 4;
+        OverflowPolicy policy = OverflowPolicy::Block;
+    };
+
+    struct StageStats {
+        std::string name;
+        unsigned workers = 0;
+        uint64_t processed = 0;      // 成功处理的帧数
+        uint64_t dropped = 0;        // 阶段函数返回 false 的帧数
+        double busy_ms = 0.0;        // 所有工作线程累计的忙碌时间
+        double utilization = 0.0;    // busy / (运行时长 * 工作线程数)
+        size_t queue_depth = 0;      // 输入队列当前长度
+        size_t queue_high_water = 0;
+        uint64_t queue_drops = 0;    // 输入队列溢出丢弃的帧数
+        size_t reorder_pending = 0;  // 重排缓冲中等待的帧数
+        LatencyWindow::Summary latency_ms;  // 最近 512 帧单帧处理耗时
+    };
+
+    // source_name: 源阶段在统计中的名字，例如 "capture"
+    Pipeline(std::string source_name, SourceFn source)
+        : source_(std::move(source)) {
+        source_stage_.options.name = std::move(source_name);
+    }
+
+    ~Pipeline() {
+        stop();
+        wait();
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // 所有工作线程共享同一个 fn；workers > 1 时 fn 必须线程安全
+    Pipeline& add_stage(StageOptions options, StageFn fn) {
+        return add_stage_per_worker(std::move(options),
+                                    [fn = std::move(fn)] { return fn; });
+    }
+
+    Pipeline& add_stage_per_worker(StageOptions options, StageFactory factory) {
+        if (started_) {
+            throw std::runtime_error("Pipeline 启动后不能再添加阶段");
+        }
+        if (options.workers == 0) options.workers = 1;
+        if (options.ordered && options.workers != 1) {
+            throw std::invalid_argument("ordered 阶段只能有一个工作线程: " +
+                                        options.name);
+        }
+        auto stage = std::make_unique<Stage>();
+        stage->input = std::make_unique<MpmcRing<Envelope>>(
+            options.queue_capacity, options.policy);
+        stage->options = std::move(options);
+        stage->factory = std::move(factory);
+        stages_.push_back(std::move(stage));
+        return *this;
+    }
+
+    void start() {
+        if (started_ || stages_.empty()) return;
+        started_ = true;
+        start_time_ = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < stages_.size(); ++i) {
+            Stage& stage = *stages_[i];
+            stage.live_workers = stage.options.workers;
+            // 重排窗口：上游所有队列和工作线程最多能容纳的帧数。队列溢出丢弃的帧
+            // 会以空信封补位（见 deliver），窗口只是兜底：超过后直接跳过缺失的序号
+            stage.reorder_window = 1;
+            for (size_t j = 0; j <= i; ++j) {
+                stage.reorder_window += stages_[j]->options.queue_capacity +
+                                        stages_[j]->options.workers;
+            }
+            for (unsigned w = 0; w < stage.options.workers; ++w) {
+                stage.threads.emplace_back(&Pipeline::run_stage, this, i,
+                                           stage.factory());
+            }
+        }
+        source_thread_ = std::thread(&Pipeline::run_source, this);
+    }
+
+    // 请求源停止；已在流水线中的帧会继续处理完
+    void stop() { stopping_ = true; }
+
+    // 等待所有帧处理完、线程退出
+    void wait() {
+        if (source_thread_.joinable()) source_thread_.join();
+        for (auto& stage : stages_) {
+            for (auto& t : stage->threads) {
+                if (t.joinable()) t.join();
+            }
+        }
+    }
+
+    // 第一个元素是源阶段，之后按添加顺序
+    std::vector<StageStats> stats() const {
+        std::vector<StageStats> result;
+        result.push_back(collect(source_stage_));
+        for (const auto& stage : stages_) result.push_back(collect(*stage));
+        return result;
+    }
+
+private:
+    // 队列中流动的信封：被丢弃的帧以“空信封”的形式继续向后传递，
+    // 让 ordered 阶段知道这个序号不会再来
+    struct Envelope {
+        uint64_t seq = 0;
+        bool dropped = false;
+        T item{};
+    };
+
+    struct Stage {
+        StageOptions options;
+        StageFactory factory;
+        std::unique_ptr<MpmcRing<Envelope>> input;
+        std::vector<std::thread> threads;
+        std::atomic<unsigned> live_workers{0};
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<size_t> reorder_pending{0};
+        size_t reorder_window = 0;
+        LatencyWindow latency{512};
+    };
+
+    StageStats collect(const Stage& stage) const {
+        StageStats s;
+        s.name = stage.options.name;
+        s.workers = stage.options.workers;
+        s.processed = stage.processed.load(std::memory_order_relaxed);
+        s.dropped = stage.dropped.load(std::memory_order_relaxed);
+        s.busy_ms = stage.busy_ns.load(std::memory_order_relaxed) / 1e6;
+        if (started_) {
+            double wall_ms = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - start_time_)
+                                 .count();
+            if (wall_ms > 0.0) s.utilization = s.busy_ms / (wall_ms * s.workers);
+        }
+        if (stage.input) {
+            auto qs = stage.input->stats();
+            s.queue_depth = qs.size;
+            s.queue_high_water = qs.high_water;
+            s.queue_drops = qs.dropped;
+        }
+        s.reorder_pending = stage.reorder_pending.load(std::memory_order_relaxed);
+        s.latency_ms = stage.latency.summary();
+        return s;
+    }
+
+    // 计时执行一次阶段函数；追踪开启时同时记录一个以帧序号标记的 span
+    static bool timed_call(Stage& stage, const StageFn& fn, T& item) {
+        const int64_t t0 = Tracer::now_ns();
+        bool ok = fn(item);
+        const int64_t t1 = Tracer::now_ns();
+        const int64_t ns = t1 - t0;
+        if (Tracer::enabled()) {
+            Tracer::instance().record(stage.options.name.c_str(), item.seq, t0, t1);
+        }
+        stage.latency.add(ns / 1e6);
+        stage.busy_ns.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+        (ok ? stage.processed : stage.dropped).fetch_add(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    // 把帧标记为丢弃，尽早释放帧占用的缓冲区，只保留序号
+    static void bury(Envelope& env) {
+        env.dropped = true;
+        env.item = T{};
+    }
+
+    // 放入第 index 个阶段的输入队列。被 DropOldest 挤掉的旧帧（以及
+    // forward_rejected 时被 DropNewest 拒收的这一帧）不经过该阶段，改为空信封
+    // 直接交给再下一个阶段，使序号不出现空洞，下游 ordered 阶段无需等到重排
+    // 窗口溢出才跳过。返回 env 是否已放入本阶段队列
+    bool deliver(size_t index, Envelope& env, bool forward_rejected) {
+        if (index >= stages_.size()) return false;
+        MpmcRing<Envelope>& ring = *stages_[index]->input;
+        const bool pushed = ring.push(std::move(env), [&](Envelope& evicted) {
+            bury(evicted);
+            deliver(index + 1, evicted, true);
+        });
+        if (!pushed && forward_rejected && !ring.closed()) {
+            bury(env);
+            deliver(index + 1, env, true);
+        }
+        return pushed;
+    }
+
+    void run_source() {
+        Tracer::set_thread_name(source_stage_.options.name);
+        uint64_t next_seq = 0;
+        while (!stopping_) {
+            Envelope env;
+            env.item.seq = next_seq;
+            if (!timed_call(source_stage_, source_, env.item)) break;
+            env.seq = next_seq;
+            // DropNewest 时 push 失败不会移走 env，序号留给下一帧，不产生空洞
+            if (deliver(0, env, false)) ++next_seq;
+        }
+        stages_.front()->input->close();
+    }
+
+    void run_stage(size_t index, StageFn fn) {
+        Stage& stage = *stages_[index];
+        Tracer::set_thread_name(stage.options.name);
+        MpmcRing<Envelope>* out =
+            index + 1 < stages_.size() ? stages_[index + 1]->input.get() : nullptr;
+
+        auto process = [&](Envelope& env) {
+            if (!env.dropped && !timed_call(stage, fn, env.item)) {
+                bury(env);
+            }
+            if (out) deliver(index + 1, env, true);
+        };
+
+        Envelope env;
+        if (stage.options.ordered) {
+            std::map<uint64_t, Envelope> pending;
+            // pending 中真实帧的数量。空信封绕过上游队列直接送达，可能远远跑在
+            // 仍在处理中的帧前面，不能计入重排窗口，否则会把在途的帧误判为缺失
+            size_t pending_frames = 0;
+            uint64_t next = 0;
+            auto drain = [&](bool flush) {
+                while (!pending.empty()) {
+                    auto it = pending.begin();
+                    if (it->first != next && !flush &&
+                        pending_frames <= stage.reorder_window) {
+                        break;  // 等待缺失的序号
+                    }
+                    next = it->first + 1;
+                    if (!it->second.dropped) --pending_frames;
+                    process(it->second);
+                    pending.erase(it);
+                }
+                stage.reorder_pending.store(pending.size(), std::memory_order_relaxed);
+            };
+            while (stage.input->pop(env)) {
+                if (env.seq < next) {
+                    // 已被跳过的迟到帧：顺序已无法保证，只能丢弃
+                    stage.dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                if (!env.dropped) ++pending_frames;
+                pending.emplace(env.seq, std::move(env));
+                drain(false);
+            }
+            drain(true);
+        } else {
+            while (stage.input->pop(env)) process(env);
+        }
+
+        // 本阶段最后一个退出的工作线程负责关闭下游队列
+        if (stage.live_workers.fetch_sub(1) == 1 && out) out->close();
+    }
+
+    SourceFn source_;
+    Stage source_stage_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::thread source_thread_;
+    std::atomic<bool> stopping_{false};
+    bool started_ = false;
+    std::chrono::steady_clock::time_point start_time_;
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 每帧各阶段的耗时追踪（dequeue / decode / algorithm / convert / encode / mux），
+// 可导出为 Chrome trace_event JSON（chrome://tracing 或 Perfetto 打开）。
+// - 关闭时（默认）每个埋点只有一次 relaxed 原子读，不取时间、不写内存；
+// - 开启后每个线程写自己的环形缓冲（单写者、无锁），写满后覆盖最旧的事件，
+//   线程只在第一次记录时加锁注册一次缓冲区；
+// - 导出可以与记录并发，正在被覆盖的事件会被丢弃而不是读出半条。
+// 事件名必须是静态生命周期的字符串（字面量或与 Tracer 同寿命的字符串）。
+class Tracer {
+public:
+    struct Event {
+        const char* name = nullptr;
+        uint64_t id = 0;         // 帧序号等，导出到 args.frame
+        int64_t begin_ns = 0;    // steady_clock 纳秒
+        int64_t end_ns = 0;
+        uint32_t tid = 0;        // Tracer 分配的线程编号
+    };
+
+    static Tracer& instance();
+
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+    // 当前线程在 trace 中显示的名字，只保存到线程局部变量，开销可忽略
+    static void set_thread_name(const std::string& name);
+
+    // events_per_thread 只影响之后才开始记录的线程
+    void enable(size_t events_per_thread = 65536);
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+    void record(const char* name, uint64_t id, int64_t begin_ns, int64_t end_ns);
+
+    // 所有线程缓冲区中仍保留的事件，按线程分组、组内按记录顺序
+    std::vector<Event> snapshot() const;
+    // 写出 Chrome trace_event JSON（"X" 完整事件 + 线程名元数据）
+    bool write_chrome_trace(const std::string& path) const;
+    // 清空已记录的事件；只能在没有线程正在记录时调用（例如测试之间）
+    void clear();
+
+private:
+    // 单个事件槽位：字段用 relaxed 原子，导出线程并发读取不构成数据竞争
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> id{0};
+        std::atomic<int64_t> begin_ns{0};
+        std::atomic<int64_t> end_ns{0};
+    };
+    struct ThreadBuffer {
+        uint32_t tid = 0;
+        std::string thread_name;
+        size_t capacity = 0;
+        std::unique_ptr<Slot[]> slots;
+        std::atomic<uint64_t> head{0};  // 已写入的事件总数，release 发布
+    };
+
+    Tracer() = default;
+    ThreadBuffer* local_buffer();
+
+    static std::atomic<bool> enabled_;
+    std::atomic<size_t> capacity_{65536};
+    mutable std::mutex mutex_;  // 只保护 buffers_ 列表
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// RAII 埋点：构造时开始、析构时结束。追踪关闭时不取时间
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, uint64_t id = 0)
+        : name_(Tracer::enabled() ? name : nullptr), id_(id),
+          begin_ns_(name_ ? Tracer::now_ns() : 0) {}
+    ~TraceSpan() {
+        if (name_) Tracer::instance().record(name_, id_, begin_ns_, Tracer::now_ns());
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    uint64_t id_;
+    int64_t begin_ns_;
+};
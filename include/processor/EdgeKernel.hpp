@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TileScheduler;
+
+// 直接在亮度数据上运行的融合边缘检测内核（Canny：3x3 Sobel、L1 梯度、
+// 非极大值抑制、双阈值 + 滞后连接）。
+// 与 apply_algorithm 的 RGB→GRAY→Canny→RGB 相比：
+// - 亮度可以直接从 YUYV（步长 2）或 Y 平面（步长 1）读取，不需要先转灰度；
+// - Sobel 与非极大值抑制在一次逐行扫描中完成，只保留 3 行的梯度缓存；
+// - 输出为单通道 0/255，可以直接写回编码器的 Y 平面（允许与输入同一块内存）。
+// 所有中间缓冲区在对象内复用，分辨率不变时不再分配内存。
+// 同一个 EdgeKernel 不能被多个线程同时使用。
+class EdgeKernel {
+public:
+    // 非极大值抑制需要上下各 1 行幅值，幅值又需要上下各 1 行亮度
+    static constexpr int kHaloRows = 2;
+
+    EdgeKernel(int low_threshold = 100, int high_threshold = 200);
+
+    // src: 亮度数据起点；pixel_step: 相邻像素亮度的字节间隔（YUYV 为 2，Y 平面为 1）
+    // dst: 单通道输出，可以与 src 为同一块 Y 平面
+    // scheduler 非空时按水平条带在多核上执行：Sobel/非极大值抑制与输出分块并行，
+    // 滞后连接跨条带串行完成，结果与整帧执行逐字节一致
+    void detect(const uint8_t* src, int src_stride, int pixel_step, int width,
+                int height, uint8_t* dst, int dst_stride,
+                TileScheduler* scheduler = nullptr);
+
+    void set_thresholds(int low, int high) {
+        low_ = low;
+        high_ = high;
+    }
+
+private:
+    // 每个条带私有的行缓存
+    struct BandScratch {
+        // 亮度行缓存（3 行环形，宽度 + 2）
+        std::vector<uint8_t> luma_rows;
+        // 梯度与幅值行缓存（3 行环形，宽度 + 2，两端为 0）
+        std::vector<int16_t> dx_rows, dy_rows;
+        std::vector<int> mag_rows;
+        // 本条带内的强边缘点，滞后连接的起点
+        std::vector<uint8_t*> strong;
+    };
+
+    void resize(int width, int height, size_t bands);
+    // 计算 [row_begin, row_end) 行的边缘状态，写入 map_
+    void sweep_band(BandScratch& band, const uint8_t* src, int src_stride,
+                    int pixel_step, int row_begin, int row_end);
+    // 把第 row 行亮度（越界时复制边缘行）拷入带左右各 1 像素复制边界的行缓存
+    void load_luma_row(const uint8_t* src, int src_stride, int pixel_step,
+                       int row, uint8_t* out) const;
+    // 计算第 row 行的 Sobel 梯度与 L1 幅值
+    void sobel_row(BandScratch& band, int row);
+    // 对第 row 行做非极大值抑制与双阈值，写入 map_
+    void suppress_row(BandScratch& band, int row);
+    // 从所有强边缘点出发，把 8 邻域内的弱边缘提升为强边缘
+    void hysteresis();
+    void write_rows(uint8_t* dst, int dst_stride, int row_begin, int row_end) const;
+
+    int low_, high_;
+    int width_ = 0, height_ = 0;
+    std::vector<BandScratch> bands_;
+    // 边缘状态图：0 非边缘，1 弱边缘候选，2 强边缘；四周各留 1 像素边框
+    std::vector<uint8_t> map_;
+    std::vector<uint8_t*> stack_;
+};
@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "processor/EdgeKernel.hpp"
+#include "processor/TileScheduler.hpp"
+
+// 可组合的算法链：逐像素算子在编译期融合成一次内存遍历，
+// 邻域算子（模糊、边缘检测等）作为融合屏障单独成为一个阶段。
+// 所有阶段都在单通道亮度平面上原地运行（RGB 输入先转灰度，YUV 输入直接用 Y 平面），
+// 伪彩色只在最后展开为 RGB 时生效。
+//
+//   FilterChain chain;
+//   chain.then(std::make_unique<GaussianStage>())               // 屏障
+//        .then(fuse(Contrast(1.5f, -40), Threshold(128)));     // 一次遍历
+//
+// 链也可以按名字创建：FilterChain::create("denoise-edges")，见 FilterChain::names()。
+
+// 单通道 8 位平面（可以是 cv::Mat、AVFrame 的 Y 平面或 YUYV 之外的任何行存储）
+struct LumaPlane {
+    uint8_t* data = nullptr;
+    int stride = 0;
+    int width = 0;
+    int height = 0;
+
+    uint8_t* row(int r) const { return data + static_cast<size_t>(r) * stride; }
+};
+
+// ---------- 逐像素算子：uint8_t operator()(uint8_t) const ----------
+
+// 二值化：大于 level 为 255，否则为 0
+struct Threshold {
+    static constexpr const char* name = "threshold";
+    explicit Threshold(uint8_t level = 128) : level(level) {}
+    uint8_t operator()(uint8_t v) const { return v > level ? 255 : 0; }
+    uint8_t level;
+};
+
+struct Invert {
+    static constexpr const char* name = "invert";
+    uint8_t operator()(uint8_t v) const { return static_cast<uint8_t>(255 - v); }
+};
+
+// 线性对比度/亮度：v * gain + bias，定点 Q8 计算
+struct Contrast {
+    static constexpr const char* name = "contrast";
+    explicit Contrast(float gain = 1.0f, int bias = 0)
+        : gain_q8(static_cast<int>(std::lround(gain * 256))), bias(bias) {}
+    uint8_t operator()(uint8_t v) const {
+        return static_cast<uint8_t>(std::clamp(((v * gain_q8 + 128) >> 8) + bias, 0, 255));
+    }
+    int gain_q8, bias;
+};
+
+// 非线性算子预先烘焙成查找表
+struct Gamma {
+    static constexpr const char* name = "gamma";
+    explicit Gamma(float gamma = 1.0f) {
+        for (int i = 0; i < 256; ++i) {
+            lut[i] = static_cast<uint8_t>(
+                std::lround(255.0 * std::pow(i / 255.0, 1.0 / gamma)));
+        }
+    }
+    uint8_t operator()(uint8_t v) const { return lut[v]; }
+    std::array<uint8_t, 256> lut{};
+};
+
+// 量化为 levels 个灰阶
+struct Posterize {
+    static constexpr const char* name = "posterize";
+    explicit Posterize(int levels = 4) : step(256 / std::clamp(levels, 2, 256)) {}
+    uint8_t operator()(uint8_t v) const {
+        return static_cast<uint8_t>(std::min(255, (v / step) * step + step / 2));
+    }
+    int step;
+};
+
+// 编译期融合：按顺序依次调用各算子，编译器把整条链内联进同一个像素循环
+template <typename... Ops>
+class FusedPixelOp {
+public:
+    explicit FusedPixelOp(Ops... ops) : ops_(std::move(ops)...) {}
+
+    uint8_t operator()(uint8_t v) const {
+        std::apply([&v](const Ops&... op) { ((v = op(v)), ...); }, ops_);
+        return v;
+    }
+
+    std::string describe() const {
+        std::string s;
+        ((s += (s.empty() ? "" : "+"), s += Ops::name), ...);
+        return s;
+    }
+
+private:
+    std::tuple<Ops...> ops_;
+};
+
+// ---------- 阶段 ----------
+
+class FilterStage {
+public:
+    virtual ~FilterStage() = default;
+    virtual std::string describe() const = 0;
+    // 在平面上原地运行；scheduler 非空时可以按条带并行
+    virtual void apply(const LumaPlane& plane, TileScheduler* scheduler) = 0;
+};
+
+// 融合后的逐像素阶段：无论包含多少个算子，整帧只读写一次
+template <typename... Ops>
+class PixelStage : public FilterStage {
+public:
+    explicit PixelStage(Ops... ops) : op_(std::move(ops)...) {}
+
+    std::string describe() const override { return "[" + op_.describe() + "]"; }
+
+    void apply(const LumaPlane& plane, TileScheduler* scheduler) override {
+        auto run_rows = [&](int row_begin, int row_end) {
+            for (int r = row_begin; r < row_end; ++r) {
+                uint8_t* p = plane.row(r);
+                for (int x = 0; x < plane.width; ++x) p[x] = op_(p[x]);
+            }
+        };
+        if (!scheduler) {
+            run_rows(0, plane.height);
+            return;
+        }
+        scheduler->run(plane.height, 0, [&](const TileScheduler::Tile& tile) {
+            run_rows(tile.row_begin, tile.row_end);
+        });
+    }
+
+private:
+    FusedPixelOp<Ops...> op_;
+};
+
+template <typename... Ops>
+std::unique_ptr<FilterStage> fuse(Ops... ops) {
+    return std::make_unique<PixelStage<Ops...>>(std::move(ops)...);
+}
+
+// 3x3 高斯模糊（[1 2 1] 可分离核），用作降噪；邻域算子，融合屏障
+class GaussianStage : public FilterStage {
+public:
+    std::string describe() const override { return "gaussian3"; }
+    void apply(const LumaPlane& plane, TileScheduler* scheduler) override;
+
+private:
+    void blur_rows(const LumaPlane& plane, int row_begin, int row_end);
+    // 输出先写入 scratch_，全部条带完成后再拷回，避免条带之间读写冲突
+    std::vector<uint8_t> scratch_;
+};
+
+// Canny 边缘检测（EdgeKernel），输出 0/255
+class EdgeStage : public FilterStage {
+public:
+    EdgeStage(int low = 100, int high = 200) : kernel_(low, high) {}
+    std::string describe() const override { return "edges"; }
+    void apply(const LumaPlane& plane, TileScheduler* scheduler) override;
+
+private:
+    EdgeKernel kernel_;
+};
+
+// 把边缘叠加到原画面上：边缘处为白色，其余像素按 dim 调暗
+class EdgeOverlayStage : public FilterStage {
+public:
+    EdgeOverlayStage(float dim = 0.6f, int low = 100, int high = 200)
+        : dim_q8_(static_cast<int>(std::lround(dim * 256))), kernel_(low, high) {}
+    std::string describe() const override { return "edge-overlay"; }
+    void apply(const LumaPlane& plane, TileScheduler* scheduler) override;
+
+private:
+    int dim_q8_;
+    EdgeKernel kernel_;
+    std::vector<uint8_t> edges_;
+};
+
+// 伪彩色查找表，只在 expand_rgb() 时使用
+struct ColorMap {
+    std::array<std::array<uint8_t, 3>, 256> rgb{};
+
+    static ColorMap gray();
+    // 黑 → 红 → 黄 → 白
+    static ColorMap heat();
+};
+
+class FilterChain {
+public:
+    using Factory = std::function<std::unique_ptr<FilterChain>()>;
+
+    FilterChain& then(std::unique_ptr<FilterStage> stage);
+    FilterChain& set_color_map(const ColorMap& map);
+
+    // 依次执行各阶段（原地）
+    void apply(const LumaPlane& plane, TileScheduler* scheduler = nullptr);
+    // 把单通道结果展开为 RGB24；未设置伪彩色时三个通道相同
+    void expand_rgb(const LumaPlane& plane, uint8_t* rgb, int rgb_stride) const;
+    bool has_color_map() const { return color_map_ != nullptr; }
+
+    size_t stage_count() const { return stages_.size(); }
+    // 没有阶段也没有伪彩色（例如 "none"）：链不改变画面，调用方可以直接跳过
+    bool empty() const { return stages_.empty() && !color_map_; }
+    // 例如 "gaussian3 -> [contrast+threshold]"
+    std::string describe() const;
+
+    // 按名字创建注册过的链，未知名字返回 nullptr
+    static std::unique_ptr<FilterChain> create(const std::string& name);
+    // 注册（或覆盖）一条命名链，供应用通过名字选择
+    static void register_chain(const std::string& name, Factory factory);
+    static std::vector<std::string> names();
+
+private:
+    std::vector<std::unique_ptr<FilterStage>> stages_;
+    std::unique_ptr<ColorMap> color_map_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <opencv2/core/mat.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 按字节大小回收整帧内存的 cv::MatAllocator。
+// 同一分辨率/格式的帧大小固定，释放后的内存挂回对应桶中，下次直接复用，
+// 避免每帧数 MB 的 malloc/free 带来的缺页和分配器锁竞争。
+// 内存的归还由 cv::Mat 自身的引用计数驱动：最后一个 Mat 析构时回到池中。
+// 池对象必须比它分配出去的所有 Mat 活得更久，一般直接使用 shared()。
+class FramePool : public cv::MatAllocator {
+public:
+    struct Stats {
+        uint64_t hits = 0;         // 从池中复用
+        uint64_t misses = 0;       // 池中无可用块，新分配
+        uint64_t outstanding = 0;  // 当前被 Mat 持有的块数
+        size_t cached_bytes = 0;   // 空闲块占用的字节数
+    };
+
+    // max_cached_per_size: 每种大小最多缓存的空闲块数，超出直接释放
+    explicit FramePool(size_t max_cached_per_size = 8);
+    ~FramePool() override;
+
+    // 进程级共享池，生命周期覆盖整个程序
+    static FramePool& shared();
+
+    // 返回一个由本池分配内存的 Mat
+    cv::Mat acquire(int rows, int cols, int type);
+    // 让 mat 以后 create() 时从本池取内存（已有数据不受影响）
+    void adopt(cv::Mat& mat) { mat.allocator = this; }
+
+    Stats stats() const;
+    // 释放所有空闲块
+    void trim();
+
+    // cv::MatAllocator 接口
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                           size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessflags,
+                  cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    const size_t max_cached_per_size_;
+    // MatAllocator 的接口是 const 的，池状态因此为 mutable
+    mutable std::mutex mtx_;
+    mutable std::unordered_map<size_t, std::vector<void*>> free_blocks_;
+    mutable size_t cached_bytes_ = 0;
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+    mutable std::atomic<uint64_t> outstanding_{0};
+};
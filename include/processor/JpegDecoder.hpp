@@ -0,0 +1,59 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "processor/YuvConvert.hpp"
+
+// MJPEG 帧解码器，基于 libjpeg-turbo 的 TurboJPEG 接口：
+// - decode_rgb / decode_gray 直接输出 RGB24 / 灰度，不经过中间的 BGR Mat；
+// - decode_yuv420p 直接解码到编码器的 YUV420P 平面（跳过颜色空间转换），
+//   摄像头常见的 4:2:2 色度在垂直方向取平均；
+// - Scale 使用 DCT 域缩放（IDCT 只计算低频系数），1/2、1/4、1/8 解码比全尺寸
+//   解码后再缩小便宜得多，适合预览与分析。
+// 编译时未找到 TurboJPEG（未定义 VISION_HAVE_TURBOJPEG）时退回 cv::imdecode，
+// 接口与结果尺寸保持一致。
+// 每个 JpegDecoder 持有一个解码句柄，不能被多个线程同时使用。
+class JpegDecoder {
+public:
+    enum class Scale { Full = 1, Half = 2, Quarter = 4, Eighth = 8 };
+
+    JpegDecoder();
+    ~JpegDecoder();
+    JpegDecoder(const JpegDecoder&) = delete;
+    JpegDecoder& operator=(const JpegDecoder&) = delete;
+
+    // 是否使用 TurboJPEG（否则为 OpenCV 回退实现）
+    static bool uses_turbojpeg();
+    // DCT 缩放后的边长（向上取整，与 TurboJPEG 的 TJSCALED 一致）
+    static int scaled(int size, Scale scale) {
+        const int s = static_cast<int>(scale);
+        return (size + s - 1) / s;
+    }
+
+    // 只扫描标记段，从 SOFn（SOF0..SOF15，不含 DHT/JPG/DAC）读取宽高，不需要解码句柄
+    static bool parse_sof(const uint8_t* data, size_t size, int& width, int& height);
+    // 只解析文件头，得到原始宽高
+    bool read_header(const uint8_t* data, size_t size, int& width, int& height);
+    // 解码为 RGB24（CV_8UC3），rgb 尺寸不变时不重新分配
+    bool decode_rgb(const uint8_t* data, size_t size, cv::Mat& rgb,
+                    Scale scale = Scale::Full);
+    // 只解码亮度（CV_8UC1），跳过色度上采样与颜色转换
+    bool decode_gray(const uint8_t* data, size_t size, cv::Mat& gray,
+                     Scale scale = Scale::Full);
+    // 全尺寸解码到 YUV420P 平面；width/height 必须与 JPEG 尺寸一致
+    bool decode_yuv420p(const uint8_t* data, size_t size, const Yuv420pPlanes& planes,
+                        int width, int height);
+
+    // 使用快速（精度略低的）整数 IDCT，默认关闭
+    void set_fast_dct(bool enable) { fast_dct_ = enable; }
+
+private:
+    void* handle_ = nullptr;  // tjhandle
+    bool fast_dct_ = false;
+    // 非 4:2:0 的色度先解码到这里，再重采样到 4:2:0
+    std::vector<uint8_t> chroma_scratch_;
+    // 回退实现的中间结果
+    cv::Mat bgr_, i420_;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 源图像坐标下的矩形区域（像素）
+struct MotionRegion {
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+};
+
+// 解析 "x,y,w,h;x,y,w,h"（空字符串得到空列表），格式错误返回 false
+bool parse_motion_regions(const std::string& text, std::vector<MotionRegion>& regions);
+
+// 静止画面检测：把亮度平面按 cell x cell 分块求均值得到缩略图，
+// 与“最后一次判定为变化的帧”（即最后一次真正处理的帧）的缩略图逐块比较。
+// 块均值本身就是低通滤波，传感器噪声基本被平均掉；与上一次处理的帧而不是上一帧比较，
+// 缓慢的渐变累积超过阈值后同样会被发现。
+//
+// 判定为静止时调用方可以跳过解码、算法与颜色转换，沿用上一次处理的输出，
+// 并让编码器发重复帧（见 RTMPStreamer::RepeatFrame）。
+// 连续静止 refresh_frames 帧后强制判定一次变化，限制输出与实际画面的最大差距。
+//
+// 判定为变化的帧在下游失败或被丢弃时，编码器里仍是更早的画面，而参考已经更新：
+// 调用方用 invalidate_reference() 通知，下一次 analyze 重新判定为变化。
+//
+// analyze* 必须按帧顺序在同一个线程中调用；record_*、invalidate_reference 与 stats() 线程安全
+class MotionGate {
+public:
+    struct Options {
+        int cell = 16;                 // 缩略图一个块对应的源像素边长
+        int row_step = 2;              // 每隔几行采样一行（1 为逐行）
+        int threshold = 6;             // 块均值亮度差超过它算变化的块（0-255）
+        double min_changed = 0.002;    // 变化块占关注块的比例超过它才算画面变化
+        unsigned refresh_frames = 300; // 连续静止这么多帧后强制刷新一次，0 表示不强制
+    };
+    struct Decision {
+        bool changed = true;           // false 表示可以沿用上一次的输出
+        bool refresh = false;          // 因 refresh_frames 强制判定为变化
+        double changed_fraction = 0.0; // 变化块占关注块的比例
+    };
+    struct Stats {
+        uint64_t frames = 0;           // 检测过的帧数
+        uint64_t static_frames = 0;    // 判定为静止、跳过处理的帧数
+        uint64_t refreshes = 0;        // 强制刷新次数
+        double detect_ms_avg = 0.0;    // 每帧检测耗时
+        double process_ms_avg = 0.0;   // 每个变化帧的处理耗时（record_processing 累计）
+        // 估算节省的 CPU 时间：静止帧数 x 平均处理耗时 - 全部检测耗时 - 重复帧额外开销
+        double cpu_saved_ms = 0.0;
+    };
+
+    // width/height 为源分辨率（区域坐标以此为准）；cell/row_step 至少为 1
+    MotionGate(unsigned width, unsigned height, Options options);
+    MotionGate(unsigned width, unsigned height) : MotionGate(width, height, Options{}) {}
+
+    // 只在这些区域内检测（空表示整幅画面）
+    void set_regions(const std::vector<MotionRegion>& regions);
+    // 忽略这些区域（例如时间水印、摇动的树），优先于 set_regions
+    void set_ignore_regions(const std::vector<MotionRegion>& regions);
+
+    // 任意步长的亮度平面：step 为相邻像素的字节间隔（YUYV 为 2，灰度为 1）。
+    // 尺寸可以与源分辨率不同（例如 MJPEG 按 1/8 缩放解码的亮度），按比例映射到块
+    Decision analyze(const uint8_t* luma, int stride, int step, int width, int height);
+    // 源分辨率的 YUYV 帧，直接读取其中的 Y 字节
+    Decision analyze_yuyv(const uint8_t* yuyv, int stride) {
+        return analyze(yuyv, stride, 2, static_cast<int>(width_), static_cast<int>(height_));
+    }
+
+    // 最后一个判定为变化的帧没有到达输出：丢弃参考，下一帧按变化处理（可在任意线程调用）
+    void invalidate_reference() { reference_invalid_.store(true, std::memory_order_release); }
+    // 累计一个变化帧在下游的处理耗时（可从多个阶段、多个线程调用，按帧累加）
+    void record_processing(int64_t ns) { process_ns_.fetch_add(ns, std::memory_order_relaxed); }
+    // 累计静止帧仍然产生的开销（例如编码重复帧）
+    void record_overhead(int64_t ns) { overhead_ns_.fetch_add(ns, std::memory_order_relaxed); }
+    Stats stats() const;
+
+    int thumb_width() const { return thumb_w_; }
+    int thumb_height() const { return thumb_h_; }
+
+private:
+    void rebuild_mask();
+    // 输入尺寸变化时重建列/行到块的映射
+    void prepare(int width, int height);
+
+    unsigned width_, height_;
+    Options options_;
+    int thumb_w_, thumb_h_;
+    std::vector<MotionRegion> regions_, ignore_;
+    std::vector<uint8_t> mask_;            // 每块 1 表示关注
+    size_t watched_ = 0;                   // 关注块数
+
+    int input_w_ = 0, input_h_ = 0;
+    std::vector<int> col_begin_;           // 第 bx 块在输入中的起始列，末尾为 input_w_
+    std::vector<int> row_block_;           // 输入第 y 行所属的块行
+    std::vector<uint32_t> counts_;         // 每块的采样数
+    std::vector<uint32_t> sums_;           // 逐帧复用
+    std::vector<uint16_t> current_;        // 当前帧块均值
+    std::vector<uint16_t> reference_;      // 最后一次处理的帧的块均值
+    bool has_reference_ = false;
+    std::atomic<bool> reference_invalid_{false};
+    unsigned static_run_ = 0;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> static_frames_{0};
+    std::atomic<uint64_t> refreshes_{0};
+    std::atomic<int64_t> detect_ns_{0};
+    std::atomic<int64_t> process_ns_{0};
+    std::atomic<int64_t> overhead_ns_{0};
+};
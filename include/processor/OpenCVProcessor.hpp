@@ -1,8 +1,18 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <atomic>
+#include <future>
+#include <memory>
+
+#include "processor/EdgeKernel.hpp"
+#include "processor/FilterChain.hpp"
+#include "processor/JpegDecoder.hpp"
+#include "processor/SnapshotWriter.hpp"
+#include "processor/TileScheduler.hpp"
+
 class OpenCVProcessor {
 public:
     enum class PixelFormat { MJPEG, YUYV };
@@ -14,12 +24,54 @@ public:
 
     // 处理一帧 raw_data
     bool Decode2RGB(const std::vector<uint8_t>& raw_data, cv::Mat& RGBFrame);
-    // 返回保存的文件路径，或空字符串表示失败
+    // 直接解码一段原始数据（例如 FrameLease 指向的驱动缓冲区），不经过 vector 拷贝
+    bool Decode2RGB(const uint8_t* data, size_t size, cv::Mat& RGBFrame);
+    // MJPEG 的 DCT 域缩放解码（1/2、1/4、1/8），用于低分辨率预览与分析；
+    // 影响 Decode2RGB 与 Decode2Edges 的 MJPEG 输出尺寸，YUYV 不受影响
+    void set_decode_scale(JpegDecoder::Scale scale) { decode_scale_ = scale; }
+    // 返回保存的文件路径，或空字符串表示失败。
+    // 在调用线程中同步编码 PNG（720p 数十毫秒），实时流水线中应使用下面的异步版本
     std::string process_and_save(const std::string& output_dir, cv::Mat& RGBFrame);
+    // 异步版本：算法仍在调用线程中原地运行，结果拷贝给 writer 后立即返回，
+    // 编码与写盘在 writer 的工作线程中进行（见 SnapshotWriter）。
+    // future 在文件写出后给出路径，队列已满被放弃或写出失败时为空字符串
+    std::future<std::string> process_and_save(SnapshotWriter& writer, cv::Mat& RGBFrame,
+                                              SnapshotWriter::Callback done = nullptr);
     void apply_algorithm(cv::Mat& frame);
+    // 只需要亮度的算法直接在 YUV420P 平面上原地运行：
+    // luma 为 Y 平面（CV_8UC1，可以是 AVFrame 数据的 Mat 头），
+    // 输出为灰度，色度平面 u/v 填充为 128
+    void apply_algorithm_luma(cv::Mat& luma, cv::Mat& u, cv::Mat& v);
+    // 解码与算法融合：直接从原始数据的亮度得到单通道边缘图（CV_8UC1）。
+    // YUYV 不做任何颜色转换；只有 expand_rgb 为 true 时才展开成 3 通道 RGB
+    bool Decode2Edges(const uint8_t* data, size_t size, cv::Mat& edges,
+                      bool expand_rgb = false);
+    // 启用分块并行：算法按水平条带在 scheduler 的线程池上执行，输出与整帧一致。
+    // scheduler 由调用方持有，可以被多个 OpenCVProcessor 共享；nullptr 恢复单线程
+    void set_tile_scheduler(TileScheduler* scheduler) { tile_scheduler_ = scheduler; }
+    // 按名字选择 apply_algorithm / apply_algorithm_luma 使用的算法链
+    // （见 FilterChain::names()）；未选择时保持默认的 Canny。未知名字返回 false
+    bool set_algorithm(const std::string& name);
+    std::string describe_algorithm() const;
+    // 降级处理（见 LoadGovernor）：level > 0 时 apply_algorithm / apply_algorithm_luma
+    // 在缩小 2^level 倍的亮度上运行算法，再把结果放大回原尺寸。
+    // 算法耗时约为原来的 1/4^level，代价是边缘变粗、细节丢失；level 限制在 0-3
+    void set_pyramid_level(int level) { pyramid_level_ = std::clamp(level, 0, 3); }
+    int pyramid_level() const { return pyramid_level_; }
 
 private:
     PixelFormat    pixel_format_;
     unsigned       width_, height_;
     std::atomic<unsigned>      frame_count_ = 0;
+    std::string checked_dir_;  // process_and_save 已确认存在的输出目录
+    // 逐帧复用的中间结果，尺寸不变时 create() 不会重新分配
+    // （同一个 OpenCVProcessor 不应被多个线程同时调用）
+    cv::Mat gray_, edges_;
+    cv::Mat small_;  // 降级处理时缩小后的亮度
+    int pyramid_level_ = 0;
+    JpegDecoder jpeg_decoder_;
+    JpegDecoder::Scale decode_scale_ = JpegDecoder::Scale::Full;
+    EdgeKernel edge_kernel_;
+    TileScheduler* tile_scheduler_ = nullptr;
+    std::unique_ptr<FilterChain> chain_;
 };
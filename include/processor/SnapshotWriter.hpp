@@ -0,0 +1,123 @@
+#pragma once
+#include <opencv2/core/mat.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 快照文件格式
+enum class SnapshotFormat {
+    PNG,   // 无损，720p 单张编码数十毫秒
+    JPEG,  // 有损，质量可调，编码快得多
+    Raw,   // 不编码，直接写出像素（文件名带尺寸与格式，例如 frame_0001_1280x720_rgb24.raw）
+};
+
+// "png" / "jpeg"（或 "jpg"）/ "raw"，未知名字返回 false
+bool parse_snapshot_format(const std::string& name, SnapshotFormat& format);
+
+// 后台快照写出：调用方只拷贝一次像素（进入 FramePool 的内存）就返回，
+// 编码与写盘在工作线程池中进行，不阻塞实时流水线。
+// - 有界队列：满时按 block_when_full 选择阻塞调用方，或直接放弃这一张（future 得到空路径）；
+// - 输出目录在构造时检查/创建一次，之后不再逐帧访问文件系统元数据；
+// - 每个文件写完立即关闭（打开的文件描述符不随快照数量增长），只记下路径；
+//   累计 fsync_batch 个后由一个工作线程重新打开逐个 fdatasync，再 fsync 一次目录；
+//   flush() 与析构时同步剩余的文件。
+// 输入帧为 RGB（与 OpenCVProcessor 一致），PNG/JPEG 编码前转换为 OpenCV 的 BGR 顺序。
+// submit / flush / stats 线程安全
+class SnapshotWriter {
+public:
+    struct Options {
+        SnapshotFormat format = SnapshotFormat::PNG;
+        int jpeg_quality = 90;      // 0-100
+        int png_compression = 1;    // 0-9，越大越慢、文件越小
+        unsigned workers = 2;
+        size_t queue_capacity = 8;  // 排队等待编码的帧数上限
+        bool block_when_full = false;
+        // 累计写出这么多文件后同步一次；0 表示只在 flush()/析构时对输出目录所在的文件系统 syncfs 一次
+        size_t fsync_batch = 16;
+        std::string prefix = "frame_";
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t written = 0;
+        uint64_t dropped = 0;       // 队列满（非阻塞模式）或已关闭而放弃的帧
+        uint64_t failed = 0;        // 编码或写盘失败
+        uint64_t bytes_written = 0;
+        uint64_t fsyncs = 0;        // 批量同步的次数
+        size_t queue_depth = 0;
+        size_t queue_high_water = 0;
+        double queue_wait_ms_avg = 0.0;  // 入队到工作线程取出
+        double queue_wait_ms_max = 0.0;
+        double encode_ms_avg = 0.0;      // 颜色转换 + 编码
+        double encode_ms_max = 0.0;
+        double write_ms_avg = 0.0;       // 写文件（不含批量同步）
+    };
+
+    // 写出完成（或失败）时在工作线程中调用，失败时 path 为空字符串。
+    // 提交被拒绝（帧格式不支持、队列满或已关闭）时在调用 submit 的线程中立即调用
+    using Callback = std::function<void(const std::string& path)>;
+
+    // 输出目录不存在时创建，失败时抛出 std::runtime_error
+    SnapshotWriter(std::string output_dir, Options options);
+    explicit SnapshotWriter(std::string output_dir)
+        : SnapshotWriter(std::move(output_dir), Options{}) {}
+    // 写完队列中剩余的帧并同步后返回
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // 拷贝 frame（CV_8UC3 RGB，或 CV_8UC1 灰度）并排队写出。文件名在提交时按顺序编号。
+    // 返回的 future 在文件写出后给出路径；done 非空时同时回调
+    std::future<std::string> submit(const cv::Mat& frame, Callback done = nullptr);
+    // 等待已提交的帧全部写出并同步到磁盘
+    void flush();
+
+    Stats stats() const;
+    const std::string& output_dir() const { return output_dir_; }
+
+private:
+    struct Job {
+        cv::Mat frame;
+        std::string path;
+        std::promise<std::string> promise;
+        Callback done;
+        std::chrono::steady_clock::time_point queued_at;
+    };
+
+    void run();
+    // 编码并写出一个文件（写完即关闭），失败返回 false
+    bool write_job(Job& job, std::vector<uint8_t>& encoded, cv::Mat& bgr);
+    // 重新打开 paths 中的文件逐个 fdatasync；whole_fs 时改为对整个文件系统 syncfs。
+    // 有文件需要同步时最后 fsync 一次目录
+    void sync_batch(std::vector<std::string>& paths, bool whole_fs = false);
+    std::string next_path(const cv::Mat& frame);
+
+    const std::string output_dir_;
+    Options options_;
+    int dir_fd_ = -1;  // 同步目录项用
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_, not_full_, idle_;
+    std::deque<Job> queue_;
+    bool stopping_ = false;
+    size_t reserved_ = 0;        // 已通过容量检查、正在拷贝像素的帧数
+    size_t active_ = 0;          // 已取出、尚未写完（含批量同步）的帧数
+    std::vector<std::string> unsynced_;  // 已写出、等待批量同步的文件（fsync_batch 为 0 时不记录）
+    bool unsynced_fs_ = false;           // fsync_batch 为 0 时，flush 前是否写出过文件
+    uint64_t sequence_ = 0;
+
+    Stats stats_;
+    double queue_wait_ms_total_ = 0.0;
+    double encode_ms_total_ = 0.0;
+    double write_ms_total_ = 0.0;
+};
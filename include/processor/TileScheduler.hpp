@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 分块并行调度器：把一帧按行切成若干水平条带，在常驻线程池上并行执行。
+// 每个条带附带 halo 行（上下各 halo 行，裁剪到图像范围内），供 Sobel、高斯等
+// 邻域算子读取相邻条带的输入；条带只写自己的输出行，因此无需加锁。
+// 工作线程在构造时创建、析构时退出，逐帧调用 run() 不会创建线程。
+// 调用 run() 的线程也参与执行；threads 为 1 时所有条带在调用线程内串行完成。
+class TileScheduler {
+public:
+    struct Tile {
+        int index = 0;       // 条带编号，[0, tile_count)
+        int row_begin = 0;   // 输出行范围 [row_begin, row_end)
+        int row_end = 0;
+        int halo_begin = 0;  // 含 halo 的输入行范围 [halo_begin, halo_end)
+        int halo_end = 0;
+    };
+    using TileFn = std::function<void(const Tile&)>;
+
+    // threads: 参与计算的线程总数（含调用线程），0 表示 CPU 核数
+    explicit TileScheduler(unsigned threads = 0);
+    ~TileScheduler();
+
+    TileScheduler(const TileScheduler&) = delete;
+    TileScheduler& operator=(const TileScheduler&) = delete;
+
+    unsigned thread_count() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // 把 [0, height) 切成 tile_count 个条带（0 表示每个线程一个）并行执行 fn，
+    // 阻塞直到所有条带完成。fn 中抛出的第一个异常会在这里重新抛出。
+    // 多个线程同时调用 run() 时依次执行
+    void run(int height, int halo, const TileFn& fn, int tile_count = 0);
+
+    // 按 height / tile_count / halo 计算第 index 个条带的范围
+    static Tile make_tile(int height, int tile_count, int halo, int index);
+
+private:
+    void worker_loop();
+    // 领取并执行条带，直到本轮全部领完
+    void drain();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;  // 串行化并发的 run() 调用
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_, done_cv_;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    // 当前一轮的任务
+    const TileFn* fn_ = nullptr;
+    int height_ = 0, halo_ = 0, tile_count_ = 0;
+    std::atomic<int> next_tile_{0};
+    int remaining_ = 0;  // 本轮未完成的条带数，受 mutex_ 保护
+    int active_ = 0;     // 正在 drain() 中的工作线程数，受 mutex_ 保护
+    std::exception_ptr error_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// YUYV (YUY2, 4:2:2 打包) → YUV420P (I420, 4:2:0 平面) 转换内核。
+// 摄像头已经输出 YUV，推流时直接拆分 Y 平面并对色度做垂直二次采样，
+// 省去 YUYV → RGB24 → YUV420P 两次整帧颜色转换。
+// 色度垂直方向取相邻两行的平均值 (a + b + 1) >> 1，奇数高度的最后一行直接复制；
+// 各 SIMD 实现与标量参考实现逐字节一致。
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// 当前 CPU 支持的最高指令集
+SimdLevel detect_simd_level();
+const char* simd_level_name(SimdLevel level);
+
+// YUV420P 目标平面；u/v 平面尺寸为 (width / 2) x ((height + 1) / 2)
+struct Yuv420pPlanes {
+    uint8_t* y = nullptr;
+    int y_stride = 0;
+    uint8_t* u = nullptr;
+    int u_stride = 0;
+    uint8_t* v = nullptr;
+    int v_stride = 0;
+};
+
+// width 必须为偶数；src_stride 为每行字节数（通常为 width * 2）。
+// level 高于 CPU 实际支持时自动降级
+void yuyv_to_yuv420p(const uint8_t* src, int src_stride, int width, int height,
+                     const Yuv420pPlanes& dst,
+                     SimdLevel level = detect_simd_level());
+
+// 标量参考实现，用于测试与不支持 SIMD 的平台
+void yuyv_to_yuv420p_scalar(const uint8_t* src, int src_stride, int width,
+                            int height, const Yuv420pPlanes& dst);
@@ -0,0 +1,345 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 队列满时的处理策略
+enum class OverflowPolicy {
+    Block,       // 阻塞生产者直到有空位（或超时/关闭）
+    DropOldest,  // 丢弃最旧的一帧，保证队列里总是最新的画面
+    DropNewest,  // 丢弃正要放入的这一帧
+};
+
+enum class RingMode {
+    SPSC,  // 单生产者单消费者：索引推进不需要 CAS
+    MPMC,  // 多生产者多消费者
+};
+
+// 有界无锁环形队列（Vyukov 序号槽算法），取代无界的 ThreadSafeQueue。
+// - 只支持移动语义的 push/pop，避免整帧拷贝；
+// - 快速路径完全无锁，只有在需要阻塞等待时才进入互斥量 + 条件变量；
+// - close() 之后 push 立即失败，pop 取完剩余元素后返回 false，用于干净退出；
+// - 统计入队/出队/丢弃次数和最高水位。
+template <typename T, RingMode Mode = RingMode::MPMC>
+class BoundedRing {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "BoundedRing 要求元素可无异常移动构造");
+    static_assert(std::is_default_constructible_v<T>,
+                  "BoundedRing 丢弃元素时需要默认构造一个临时对象");
+
+public:
+    struct Stats {
+        uint64_t pushed = 0;
+        uint64_t popped = 0;
+        uint64_t dropped = 0;     // 因 DropOldest/DropNewest 丢弃的元素数
+        size_t high_water = 0;    // 观察到的最大队列长度
+        size_t size = 0;          // 当前队列长度（近似值）
+        size_t capacity = 0;
+    };
+
+    // capacity 向上取整到 2 的幂
+    explicit BoundedRing(size_t capacity,
+                         OverflowPolicy policy = OverflowPolicy::Block)
+        : policy_(policy) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_ = new Slot[cap];
+        for (size_t i = 0; i < cap; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        // DropOldest 时生产者也会出队，SPSC 的出队端因此不再是单线程
+        multi_consumer_ = Mode == RingMode::MPMC ||
+                          policy_ == OverflowPolicy::DropOldest;
+    }
+
+    ~BoundedRing() {
+        T discard;
+        while (try_dequeue(discard)) {
+        }
+        delete[] slots_;
+    }
+
+    BoundedRing(const BoundedRing&) = delete;
+    BoundedRing& operator=(const BoundedRing&) = delete;
+
+    // 按构造时的溢出策略放入；返回 false 表示已关闭或该元素被丢弃
+    bool push(T&& value) { return push_until(std::move(value), nullptr, [](T&) {}); }
+
+    // 与 push 相同；DropOldest 挤掉旧元素时先以 on_evict(T&) 交给调用方，
+    // 而不是直接析构，调用方可借此把丢帧告知下游
+    template <typename OnEvict>
+    bool push(T&& value, OnEvict&& on_evict) {
+        return push_until(std::move(value), nullptr, on_evict);
+    }
+
+    // 与 push 相同，但 Block 策略下最多等待 timeout
+    template <typename Rep, typename Period>
+    bool push_for(T&& value, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return push_until(std::move(value), &deadline, [](T&) {});
+    }
+
+    // 从不阻塞也不丢弃：队列满或已关闭时直接返回 false，value 保持不变
+    bool try_push(T&& value) {
+        if (closed_.load(std::memory_order_acquire)) return false;
+        if (!try_enqueue(value)) return false;
+        on_pushed();
+        return true;
+    }
+
+    // 阻塞直到取到一个元素；队列已关闭且为空时返回 false
+    bool pop(T& out) { return pop_until(out, nullptr); }
+
+    template <typename Rep, typename Period>
+    bool pop_for(T& out, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return pop_until(out, &deadline);
+    }
+
+    bool try_pop(T& out) {
+        if (!try_dequeue(out)) return false;
+        on_popped();
+        return true;
+    }
+
+    // 关闭队列并唤醒所有等待者
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mtx_);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // 丢弃队列中所有元素
+    void clear() {
+        T discard;
+        while (try_pop(discard)) {
+        }
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    size_t size() const {
+        size_t tail = tail_.value.load(std::memory_order_acquire);
+        size_t head = head_.value.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    Stats stats() const {
+        Stats s;
+        s.pushed = pushed_.value.load(std::memory_order_relaxed);
+        s.popped = popped_.value.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.high_water = high_water_.load(std::memory_order_relaxed);
+        s.size = size();
+        s.capacity = capacity();
+        return s;
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    // 每个槽独占缓存行，避免相邻槽上的生产者/消费者伪共享
+    struct alignas(kCacheLine) Slot {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+    struct alignas(kCacheLine) PaddedIndex {
+        std::atomic<size_t> value{0};
+    };
+    struct alignas(kCacheLine) PaddedCounter {
+        std::atomic<uint64_t> value{0};
+    };
+
+    bool try_enqueue(T& value) {
+        size_t pos = tail_.value.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if constexpr (Mode == RingMode::SPSC) {
+                    tail_.value.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                } else {
+                    if (tail_.value.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+            } else if (diff < 0) {
+                return false;  // 满
+            } else {
+                pos = tail_.value.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) T(std::move(value));
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_dequeue(T& out) {
+        size_t pos = head_.value.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff =
+                static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (!multi_consumer_) {
+                    head_.value.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+                if (head_.value.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 空
+            } else {
+                pos = head_.value.load(std::memory_order_relaxed);
+            }
+        }
+        T* item = slot->ptr();
+        out = std::move(*item);
+        item->~T();
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename OnEvict>
+    bool push_until(T&& value,
+                    const std::chrono::steady_clock::time_point* deadline,
+                    OnEvict&& on_evict) {
+        while (true) {
+            if (closed_.load(std::memory_order_acquire)) return false;
+            if (try_enqueue(value)) {
+                on_pushed();
+                return true;
+            }
+            switch (policy_) {
+                case OverflowPolicy::DropNewest:
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                case OverflowPolicy::DropOldest: {
+                    T victim;
+                    if (try_dequeue(victim)) {
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        on_evict(victim);
+                    }
+                    continue;
+                }
+                case OverflowPolicy::Block:
+                    if (!wait(not_full_, push_waiters_, deadline,
+                              [this] { return size() < capacity(); })) {
+                        return false;  // 超时
+                    }
+                    continue;
+            }
+        }
+    }
+
+    bool pop_until(T& out,
+                   const std::chrono::steady_clock::time_point* deadline) {
+        while (true) {
+            if (try_dequeue(out)) {
+                on_popped();
+                return true;
+            }
+            // 关闭后仍先把剩余元素取完
+            if (closed_.load(std::memory_order_acquire) && empty()) return false;
+            if (!wait(not_empty_, pop_waiters_, deadline,
+                      [this] { return !empty(); })) {
+                return false;  // 超时
+            }
+        }
+    }
+
+    // 慢速路径：登记等待者后在条件变量上睡眠。
+    // 与 notify() 中的 seq_cst 栅栏配对，避免“检查后、睡眠前”丢失唤醒
+    template <typename Pred>
+    bool wait(std::condition_variable& cv, std::atomic<int>& waiters,
+              const std::chrono::steady_clock::time_point* deadline,
+              Pred ready) {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool ok = true;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            auto pred = [&] {
+                return closed_.load(std::memory_order_acquire) || ready();
+            };
+            if (deadline) {
+                ok = cv.wait_until(lock, *deadline, pred);
+            } else {
+                cv.wait(lock, pred);
+            }
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    void notify(std::condition_variable& cv, std::atomic<int>& waiters) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            cv.notify_all();
+        }
+    }
+
+    void on_pushed() {
+        pushed_.value.fetch_add(1, std::memory_order_relaxed);
+        size_t depth = size();
+        size_t hw = high_water_.load(std::memory_order_relaxed);
+        while (depth > hw && !high_water_.compare_exchange_weak(
+                                 hw, depth, std::memory_order_relaxed)) {
+        }
+        notify(not_empty_, pop_waiters_);
+    }
+
+    void on_popped() {
+        popped_.value.fetch_add(1, std::memory_order_relaxed);
+        notify(not_full_, push_waiters_);
+    }
+
+    Slot* slots_ = nullptr;
+    size_t mask_ = 0;
+    OverflowPolicy policy_;
+    bool multi_consumer_ = true;
+
+    // 生产者端与消费者端的索引、计数各占一个缓存行
+    PaddedIndex tail_;
+    PaddedCounter pushed_;
+    PaddedIndex head_;
+    PaddedCounter popped_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<size_t> high_water_{0};
+    std::atomic<bool> closed_{false};
+
+    // 仅用于阻塞等待的慢速路径
+    std::mutex mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<int> push_waiters_{0};
+    std::atomic<int> pop_waiters_{0};
+};
+
+template <typename T>
+using SpscRing = BoundedRing<T, RingMode::SPSC>;
+
+template <typename T>
+using MpmcRing = BoundedRing<T, RingMode::MPMC>;
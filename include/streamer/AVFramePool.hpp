@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "processor/YuvConvert.hpp"
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+// 持有 AVFrame 所有权的智能指针，析构时 av_frame_free
+struct AVFrameDeleter {
+    void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+};
+using AVFramePtr = std::unique_ptr<AVFrame, AVFrameDeleter>;
+
+// YUV420P AVFrame 的三个平面，供 yuyv_to_yuv420p / JpegDecoder 直接写入
+inline Yuv420pPlanes yuv420p_planes(AVFrame* frame) {
+    Yuv420pPlanes planes;
+    planes.y = frame->data[0];
+    planes.y_stride = frame->linesize[0];
+    planes.u = frame->data[1];
+    planes.u_stride = frame->linesize[1];
+    planes.v = frame->data[2];
+    planes.v_stride = frame->linesize[2];
+    return planes;
+}
+
+// 固定分辨率/像素格式的 AVFrame 数据池，基于 FFmpeg 的 AVBufferPool。
+// acquire() 返回的帧数据来自池中的一整块缓冲区，av_frame_unref/av_frame_free
+// 释放最后一个引用时缓冲区自动回到池中，编码器内部持有的引用同样适用。
+// 池可以先于帧析构：AVBufferPool 会等到最后一块缓冲区归还后才真正释放。
+class AVFramePool {
+public:
+    struct Stats {
+        uint64_t hits = 0;    // 复用池中缓冲区
+        uint64_t misses = 0;  // 池为空，新分配
+    };
+
+    AVFramePool(int width, int height, AVPixelFormat format, int align = 32);
+    ~AVFramePool();
+    AVFramePool(const AVFramePool&) = delete;
+    AVFramePool& operator=(const AVFramePool&) = delete;
+
+    // 返回一帧可写的 AVFrame，失败返回空指针
+    AVFramePtr acquire();
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    AVPixelFormat format() const { return format_; }
+    Stats stats() const;
+
+private:
+    // AVBufferPool 在池空时回调，用于统计未命中次数
+    static AVBufferRef* alloc_buffer(void* opaque, size_t size);
+
+    int width_, height_;
+    AVPixelFormat format_;
+    int align_;
+    int buffer_size_ = 0;
+    AVBufferPool* pool_ = nullptr;
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> misses_{0};
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+// 按时间与字节数限定大小、以关键帧为索引的编码包环形缓冲，用于事件前录像。
+// - 缓冲总是从关键帧开始：关键帧之前到达的包直接丢弃，淘汰时整 GOP 出队，
+//   因此任何时刻取出的内容都可以独立解码；
+// - max_duration：淘汰最旧的 GOP 后剩余内容仍不短于 max_duration 时才淘汰，
+//   所以事件前至少保留 max_duration（最多再多一个 GOP）；
+// - max_bytes：硬上限，超出时淘汰最旧的 GOP；只剩一个 GOP 仍超限时整体清空，
+//   等下一个关键帧重新开始。
+// 时间戳单位由调用方决定（例如编码器 time_base）。不是线程安全的。
+template <typename Packet>
+class PacketRing {
+public:
+    struct Options {
+        int64_t max_duration = 0;  // 0 表示不按时长限制
+        size_t max_bytes = 0;      // 0 表示不按字节限制
+    };
+
+    struct Entry {
+        Packet packet;
+        int64_t timestamp;
+        bool keyframe;
+        size_t bytes;
+    };
+
+    PacketRing() = default;
+    explicit PacketRing(Options options) : options_(options) {}
+
+    void set_options(Options options) {
+        options_ = options;
+        evict();
+    }
+
+    void push(Packet&& packet, int64_t timestamp, bool keyframe, size_t bytes) {
+        if (keyframe) {
+            gop_sizes_.push_back(0);
+        } else if (gop_sizes_.empty()) {
+            return;  // 还没有关键帧，无法解码
+        }
+        entries_.push_back({std::move(packet), timestamp, keyframe, bytes});
+        ++gop_sizes_.back();
+        bytes_ += bytes;
+        evict();
+    }
+
+    // 从最旧的关键帧开始按顺序访问所有包
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& e : entries_) fn(e);
+    }
+
+    void clear() {
+        entries_.clear();
+        gop_sizes_.clear();
+        bytes_ = 0;
+    }
+
+    bool empty() const { return entries_.empty(); }
+    size_t size() const { return entries_.size(); }
+    size_t bytes() const { return bytes_; }
+    size_t gop_count() const { return gop_sizes_.size(); }
+    // 最旧与最新包之间的时间跨度
+    int64_t duration() const {
+        return entries_.empty() ? 0 : entries_.back().timestamp - entries_.front().timestamp;
+    }
+
+private:
+    void pop_gop() {
+        for (size_t i = gop_sizes_.front(); i > 0; --i) {
+            bytes_ -= entries_.front().bytes;
+            entries_.pop_front();
+        }
+        gop_sizes_.pop_front();
+    }
+
+    void evict() {
+        while (gop_sizes_.size() > 1) {
+            // 第二个 GOP 的起始时间
+            const int64_t second_start = entries_[gop_sizes_.front()].timestamp;
+            const bool too_long = options_.max_duration > 0 &&
+                                  entries_.back().timestamp - second_start >= options_.max_duration;
+            const bool too_big = options_.max_bytes > 0 && bytes_ > options_.max_bytes;
+            if (!too_long && !too_big) break;
+            pop_gop();
+        }
+        if (options_.max_bytes > 0 && bytes_ > options_.max_bytes) clear();
+    }
+
+    Options options_;
+    std::deque<Entry> entries_;
+    std::deque<size_t> gop_sizes_;  // 每个 GOP 的包数，与 entries_ 对应
+    size_t bytes_ = 0;
+};
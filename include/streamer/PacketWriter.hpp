@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// 异步写出线程：编码线程把已编码的包放进有界队列，独立线程负责复用/网络写出
+// （例如 av_interleaved_write_frame）。推流服务器的 TCP 拥塞只会让队列变长，
+// 不会阻塞编码。
+//
+// 队列满（包数或字节数超出上限）时按 GOP 丢包，保证送出去的码流仍可解码：
+// - 新来的是非关键帧：丢弃它，并继续丢弃本 GOP 剩下的所有包，直到下一个关键帧
+//   （后续 P 帧依赖被丢掉的帧，送出去也无法解码）；
+// - 新来的是关键帧：它开启一个可以独立解码的新 GOP，队列中尚未发送的旧包全部丢弃。
+// 已经在队列中的包是 GOP 的前缀，仍然可以解码，因此不会被单独丢弃。
+//
+// Packet 只需可移动；push() 由调用方告知是否为关键帧与字节数。
+template <typename Packet>
+class PacketWriter {
+public:
+    // 写出一个包，返回 false 表示写出失败（计入 write_errors，不重试）
+    using WriteFn = std::function<bool(Packet&)>;
+
+    struct Options {
+        size_t max_packets = 120;  // 队列最多容纳的包数（30fps 下约 4 秒）
+        size_t max_bytes = 0;      // 队列最多容纳的字节数，0 表示不限制
+    };
+
+    struct Stats {
+        uint64_t queued = 0;            // 成功入队的包数
+        uint64_t written = 0;           // 写出成功的包数
+        uint64_t write_errors = 0;      // 写出失败的包数
+        uint64_t dropped_packets = 0;   // 因背压丢弃的包数
+        uint64_t dropped_bytes = 0;
+        uint64_t dropped_gops = 0;      // 发生丢包的 GOP 数
+        size_t queue_depth = 0;         // 当前排队的包数
+        size_t queue_bytes = 0;
+        size_t queue_high_water = 0;
+        double send_ms_avg = 0.0;       // 单次写出调用耗时
+        double send_ms_max = 0.0;
+        double queue_ms_avg = 0.0;      // 入队到写出完成的总延迟
+        double queue_ms_max = 0.0;
+    };
+
+    explicit PacketWriter(WriteFn write, Options options = {})
+        : write_(std::move(write)), options_(options) {
+        if (options_.max_packets == 0) options_.max_packets = 1;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~PacketWriter() { stop(); }
+
+    PacketWriter(const PacketWriter&) = delete;
+    PacketWriter& operator=(const PacketWriter&) = delete;
+
+    // 入队一个包；因背压或已停止而被丢弃时返回 false
+    bool push(Packet&& packet, bool keyframe, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            count_drop(bytes);
+            return false;
+        }
+        if (skipping_gop_) {
+            if (!keyframe) {
+                count_drop(bytes);
+                return false;
+            }
+            skipping_gop_ = false;
+        }
+        if (full(bytes)) {
+            ++stats_.dropped_gops;
+            if (!keyframe) {
+                count_drop(bytes);
+                skipping_gop_ = true;
+                return false;
+            }
+            // 新的关键帧让排队中的旧包失去意义，直接从它开始发送
+            for (const auto& item : queue_) count_drop(item.bytes);
+            queue_.clear();
+            queue_bytes_ = 0;
+        }
+        queue_.push_back({std::move(packet), bytes, Clock::now()});
+        queue_bytes_ += bytes;
+        ++stats_.queued;
+        stats_.queue_high_water = std::max(stats_.queue_high_water, queue_.size());
+        cv_.notify_one();
+        return true;
+    }
+
+    // 停止写出线程。drain 为 true 时先写完队列中剩余的包，否则直接丢弃
+    void stop(bool drain = true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!drain) {
+                for (const auto& item : queue_) count_drop(item.bytes);
+                queue_.clear();
+                queue_bytes_ = 0;
+            }
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s = stats_;
+        s.queue_depth = queue_.size();
+        s.queue_bytes = queue_bytes_;
+        const uint64_t attempts = stats_.written + stats_.write_errors;
+        if (attempts) {
+            s.send_ms_avg = send_ms_total_ / attempts;
+            s.queue_ms_avg = queue_ms_total_ / attempts;
+        }
+        return s;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Item {
+        Packet packet;
+        size_t bytes;
+        Clock::time_point enqueued;
+    };
+
+    bool full(size_t incoming_bytes) const {
+        if (queue_.size() >= options_.max_packets) return true;
+        return options_.max_bytes && !queue_.empty() &&
+               queue_bytes_ + incoming_bytes > options_.max_bytes;
+    }
+
+    void count_drop(size_t bytes) {
+        ++stats_.dropped_packets;
+        stats_.dropped_bytes += bytes;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // stopping_ 且已写完
+            Item item = std::move(queue_.front());
+            queue_.pop_front();
+            queue_bytes_ -= item.bytes;
+            lock.unlock();
+
+            const auto start = Clock::now();
+            const bool ok = write_(item.packet);
+            const auto end = Clock::now();
+
+            lock.lock();
+            const double send_ms = std::chrono::duration<double, std::milli>(end - start).count();
+            const double queue_ms =
+                std::chrono::duration<double, std::milli>(end - item.enqueued).count();
+            ++(ok ? stats_.written : stats_.write_errors);
+            send_ms_total_ += send_ms;
+            queue_ms_total_ += queue_ms;
+            stats_.send_ms_max = std::max(stats_.send_ms_max, send_ms);
+            stats_.queue_ms_max = std::max(stats_.queue_ms_max, queue_ms);
+        }
+    }
+
+    WriteFn write_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Item> queue_;
+    size_t queue_bytes_ = 0;
+    bool skipping_gop_ = false;  // 本 GOP 已丢包，等待下一个关键帧
+    bool stopping_ = false;
+    Stats stats_;
+    double send_ms_total_ = 0.0, queue_ms_total_ = 0.0;
+
+    std::thread thread_;  // 最后初始化：线程启动时其他成员都已就绪
+};
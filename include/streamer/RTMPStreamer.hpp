@@ -8,6 +8,15 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <chrono>
+
+#include "processor/JpegDecoder.hpp"
+#include "streamer/AVFramePool.hpp"
+#include "pipeline/LatencyWindow.hpp"
+#include "streamer/PacketWriter.hpp"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -15,23 +24,173 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+// 持有 AVPacket 所有权的智能指针，析构时 av_packet_free
+struct AVPacketDeleter {
+    void operator()(AVPacket* pkt) const { av_packet_free(&pkt); }
+};
+using AVPacketPtr = std::unique_ptr<AVPacket, AVPacketDeleter>;
+
+class SegmentRecorder;
+
+// 码率控制模式
+enum class RateControl {
+    VBV,  // 平均码率 bit_rate，maxrate = bit_rate，VBV 缓冲 2 倍（默认，推流常用）
+    CBR,  // 恒定码率：VBV 缓冲 1 倍，x264 额外开启 nal-hrd=cbr（填充到目标码率）
+    CRF,  // 恒定质量 crf；bit_rate > 0 时作为 maxrate 上限
+};
+
+// 编码线程模型
+enum class EncoderThreading {
+    Slice,  // 一帧切成多个 slice 并行编码，不增加延迟（zerolatency 的默认）
+    Frame,  // 多帧流水线并行，吞吐更高，但每个线程增加约一帧的编码延迟
+};
+
+// 编码参数。默认值即原来硬编码的配置：libx264 ultrafast/zerolatency baseline、
+// 2 Mbit/s、GOP 60、单线程
+struct EncoderConfig {
+    std::string codec = "libx264";  // 编码器名称，见 RTMPStreamer::AvailableEncoders()
+    std::string preset = "ultrafast";
+    std::string tune = "zerolatency";  // 空字符串表示不设置
+    RateControl rate_control = RateControl::VBV;
+    int64_t bit_rate = 2000000;  // 目标码率（CRF 模式下为 maxrate 上限，0 表示不限制）
+    int crf = 23;                // 仅 CRF 模式
+    int gop_size = 60;           // 关键帧间隔（帧）
+    EncoderThreading threading = EncoderThreading::Slice;
+    int threads = 1;             // 编码线程数，0 表示按 CPU 核数自动选择
+    // RepeatFrame 的心跳间隔：画面静止时至少每隔这么久把上一帧再编一次，
+    // 其余静止帧不编码（PTS 上留空）；0 表示每个静止帧都编一个重复帧
+    int repeat_interval_ms = 1000;
+};
+
 class RTMPStreamer {
     public:
-        RTMPStreamer(int w, int h, int f, const char* rtmp_url);
+        // rtmp_url 也可以是本地文件路径（例如 out.flv），便于不依赖服务器的测试。
+        // write_options 控制编码包队列的容量，超出时按 GOP 丢包
+        RTMPStreamer(int w, int h, int f, const char* rtmp_url,
+                     EncoderConfig encoder_config = {},
+                     PacketWriter<AVPacketPtr>::Options write_options = {});
         ~RTMPStreamer();
     
         void PushFrame(const cv::Mat& rgbFrame);  // 由外部线程定时调用
+        // PushFrame 拆分成的两步，便于在流水线中作为独立阶段运行：
+        // ConvertFrame: RGB24 → YUV420P（池化帧），不访问编码器状态；
+        //               同一个 RTMPStreamer 上不能并发调用（共享 SwsContext）
+        // EncodeFrame:  设置 PTS、编码并把包交给写出线程，必须按帧顺序调用；
+        //               网络写出在独立线程进行，服务器拥塞不会阻塞编码
+        AVFramePtr ConvertFrame(const cv::Mat& rgbFrame);
+        // YUV 直通模式：摄像头的 YUYV 直接拆分进编码器的 YUV420P 平面（SIMD），
+        // 跳过 RGB 往返；可与其他 ConvertFrame 调用并发
+        AVFramePtr ConvertFromYUYV(const uint8_t* yuyv, int stride);
+        // MJPEG 直通：TurboJPEG 直接解码到编码器的 YUV420P 平面。
+        // decoder 由调用方提供（每个线程一个），因此可与其他转换并发
+        AVFramePtr ConvertFromMJPEG(JpegDecoder& decoder, const uint8_t* jpeg, size_t size);
+        // frame->pict_type 为 AV_PICTURE_TYPE_I 时强制编码为 IDR（用于多路输出的 GOP 对齐）。
+        // capture_ns 为采集时间（CLOCK_MONOTONIC 纳秒，见 V4L2FrameView::capture_ns）：
+        // 给出时 PTS 取自采集时钟（相对第一帧），丢帧/晚到在时间轴上留下真实的空隙，
+        // 并统计采集→写出延迟；为 0 时按标称帧率递增（合成帧、测试）
+        void EncodeFrame(AVFramePtr frame, int64_t capture_ns = 0);
+        // 画面与上一次编码的帧相同（运动检测判定为静止）时代替 EncodeFrame 调用，不需要新帧：
+        // 距上一次送入编码器不足 repeat_interval_ms 时什么也不编，返回 false；
+        // 否则把上一帧原样再送一次并返回 true，画面相同，编码器几乎全部编为 skip 宏块。
+        // 静止期间距上一个关键帧超过一个 GOP 时长时，心跳帧编为关键帧，新观众仍能及时入流。
+        // 没有采集时钟（capture_ns 为 0）时无法在时间轴上留空，每次都编重复帧
+        bool RepeatFrame(int64_t capture_ns = 0);
+        // 排空编码器：取出缓存的延迟帧（帧线程/lookahead），包照常交给 recorder 与写出线程。
+        // 在编码线程结束后、停止 recorder 之前调用；之后 EncodeFrame/RepeatFrame 不再编码。
+        // 析构时会自动调用，重复调用无副作用
+        void Flush();
+        // 按比例调整目标码率（相对 EncoderConfig::bit_rate，限制在 0.1-1；CRF 模式下调整 maxrate 上限），
+        // 用于过载降级（见 LoadGovernor）。可在任意线程调用，下一次 EncodeFrame 时生效，不重开编码器
+        void SetBitRateScale(double scale);
+        double GetBitRateScale() const { return bit_rate_scale.load(std::memory_order_relaxed); }
+        // CRF 模式且没有 maxrate 上限（bit_rate == 0）时没有可以缩放的码率，SetBitRateScale 不起作用
+        bool SupportsBitRateScale() const {
+            return config.rate_control != RateControl::CRF || config.bit_rate > 0;
+        }
+        // 从帧池取一帧编码器分辨率的 YUV420P 帧，供调用方自行填充（例如缩放结果）
+        AVFramePtr AcquireFrame() { return frame_pool->acquire(); }
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+        AVFramePool::Stats GetFramePoolStats() const { return frame_pool->stats(); }
+        // 写出线程的队列深度、发送延迟与丢包计数
+        PacketWriter<AVPacketPtr>::Stats GetWriterStats() const { return writer->stats(); }
+        // 编码包同时旁路给 recorder（本地/事件录像），不重新编码；传 nullptr 取消。
+        // 必须在开始 EncodeFrame 之前设置，recorder 的生命周期由调用方保证
+        void SetRecorder(SegmentRecorder* rec) { recorder = rec; }
+        // 码流参数（含 SPS/PPS extradata）与包时间戳的时间基，供 SegmentRecorder 封装
+        const AVCodecParameters* GetCodecParameters() const { return video_stream->codecpar; }
+        AVRational GetPacketTimeBase() const { return codec_ctx->time_base; }
+
+        // 编码延迟：帧送入编码器（avcodec_send_frame）到收到它的包的时间。
+        // 帧线程模型下编码器会缓存若干帧，in_flight 为送入但尚未出包的帧数
+        struct EncodeStats {
+            uint64_t frames = 0;          // 已出包的帧数
+            double latency_ms_last = 0.0;
+            double latency_ms_avg = 0.0;
+            double latency_ms_max = 0.0;
+            size_t in_flight = 0;
+            size_t in_flight_max = 0;
+            uint64_t repeated = 0;        // RepeatFrame 编出的重复帧
+            uint64_t repeat_skipped = 0;  // RepeatFrame 跳过、没有编码的静止帧
+        };
+        EncodeStats GetEncodeStats() const;
+        // 每帧出包时回调一次（在调用 EncodeFrame 的线程中），参数为帧 PTS 与编码延迟
+        using EncodeLatencyFn = std::function<void(int64_t pts, double latency_ms)>;
+        void SetEncodeLatencyCallback(EncodeLatencyFn fn) { latency_callback = std::move(fn); }
+        // 采集→包写出（av_interleaved_write_frame 返回）的滚动窗口延迟，毫秒；
+        // 只统计带 capture_ns 的帧
+        LatencyWindow::Summary GetCaptureLatency() const { return capture_latency.summary(); }
+        // 编码器实际使用的线程数（thread_count=0 时由编码器决定）
+        int GetEncoderThreads() const { return codec_ctx->thread_count; }
+
+        // 本机 FFmpeg 中可用于推流的 H.264 软件编码器（排除硬件编码器）
+        static std::vector<std::string> AvailableEncoders();
     private:
         void InitEncoder(const char* rtmp_url);
+        // 在写出线程中调用
+        bool WritePacket(AVPacketPtr& pkt);
+        // 取出编码器中已就绪的包，交给录像与写出线程
+        void ReceivePackets();
+        // capture_ns 对应的 PTS（不更新 last_pts）
+        int64_t NextPts(int64_t capture_ns);
+        // 按 config.rate_control 设置 codec_ctx 的码率与 VBV 参数，码率为 config.bit_rate * scale
+        void ConfigureRateControl(double scale);
     
         int width, height, fps;
-        int64_t pts;
+        EncoderConfig config;
+        // 编码器时间基：90kHz，足以表示采集时钟上的不规则间隔
+        static constexpr AVRational kTimeBase{1, 90000};
+        int64_t last_pts = AV_NOPTS_VALUE;
+        // 最后一个关键帧包的 PTS，只在编码线程访问
+        int64_t last_key_pts = AV_NOPTS_VALUE;
+        // 最后一次编码的帧（只持有引用），供 RepeatFrame 重复
+        AVFramePtr last_frame;
+        // 第一帧的采集时间，PTS 0 对应的时刻；0 表示没有采集时钟（由写出线程读取）
+        std::atomic<int64_t> clock_origin_ns{0};
+        LatencyWindow capture_latency{1024};
+        // SetBitRateScale 请求的比例；applied_bit_rate_scale 为已设置到编码器的比例，只在编码线程访问
+        std::atomic<double> bit_rate_scale{1.0};
+        double applied_bit_rate_scale = 1.0;
+        // Flush() 已送出结束标记，只在编码线程（或编码结束后的调用方）访问
+        bool flushed = false;
     
         AVFormatContext* output_ctx;
         AVCodecContext* codec_ctx;
-        AVFrame* frame;
+        // 每帧从池中取 YUV420P 帧：编码器可能仍持有上一帧的引用，
+        // 复用同一个 AVFrame 需要 av_frame_make_writable，而池化帧无需拷贝也不用每帧分配
+        std::unique_ptr<AVFramePool> frame_pool;
         SwsContext* sws_ctx;
         AVStream* video_stream; // 你应在类中添加 AVStream* video_stream
+        // 异步写出线程，析构时先于 output_ctx 停止
+        std::unique_ptr<PacketWriter<AVPacketPtr>> writer;
+        SegmentRecorder* recorder = nullptr;
+
+        // 已送入编码器、尚未出包的帧（PTS 与送入时间），只在编码线程访问
+        std::deque<std::pair<int64_t, std::chrono::steady_clock::time_point>> pending_frames;
+        EncodeLatencyFn latency_callback;
+        mutable std::mutex encode_stats_mutex;
+        EncodeStats encode_stats;
+        double latency_ms_total = 0.0;
 
     };
     
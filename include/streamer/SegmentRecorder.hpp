@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "streamer/PacketRing.hpp"
+#include "streamer/PacketWriter.hpp"
+#include "streamer/RTMPStreamer.hpp"
+
+// 本地录像的封装格式
+enum class RecordFormat {
+    MP4,            // 普通 MP4，每个分段关闭时写 moov
+    FragmentedMP4,  // fMP4（empty_moov + 按关键帧分片），进程异常退出时已写部分仍可播放
+    HLS,            // HLS：.m3u8 播放列表 + .ts 分段，由 FFmpeg 的 hls 封装器切分
+};
+
+struct RecorderConfig {
+    std::string output_dir = ".";
+    std::string prefix = "event";           // 文件名前缀，后接时间与分段序号
+    RecordFormat format = RecordFormat::FragmentedMP4;
+    double pre_event_seconds = 10.0;        // 事件前至少保留的时长
+    double post_event_seconds = 10.0;       // 事件后继续录制的时长（再次触发会顺延）
+    double segment_seconds = 60.0;          // 单个分段的目标时长，在关键帧处切分
+    size_t max_ring_bytes = 64u << 20;      // 事件前缓冲的内存上限
+    bool continuous = false;                // 持续录制（不依赖事件触发）
+    // 编码线程到录像线程的队列，超出时按 GOP 丢包，录像磁盘慢不会拖慢编码
+    PacketWriter<AVPacketPtr>::Options queue;
+};
+
+// 事件录像：把 RTMPStreamer 已编码的包旁路一份（引用计数复制，不重新编码），
+// 在独立线程中维护事件前的包缓冲，并在触发时写成滚动分段文件：
+// - 平时只保存最近 pre_event_seconds 的包（PacketRing，从关键帧开始、整 GOP 淘汰，
+//   同时受 max_ring_bytes 限制）；
+// - Trigger() 后先把缓冲中的包写出，再继续写实时包，直到最后一次触发后
+//   post_event_seconds；分段在达到 segment_seconds 后的第一个关键帧处切换；
+// - 文件写入（封装、磁盘 IO）全部在录像线程中进行，编码线程只做一次入队。
+// 每个文件的时间戳从 0 开始。
+class SegmentRecorder {
+public:
+    struct Stats {
+        size_t ring_packets = 0;
+        size_t ring_bytes = 0;
+        double ring_seconds = 0.0;   // 当前缓冲覆盖的时长
+        bool recording = false;
+        uint64_t events = 0;         // Trigger 次数
+        uint64_t segments = 0;       // 已打开的分段文件数
+        uint64_t packets_written = 0;
+        uint64_t bytes_written = 0;
+        uint64_t write_errors = 0;
+        PacketWriter<AVPacketPtr>::Stats queue;
+    };
+
+    // codecpar 与 time_base 描述 OnPacket 收到的码流（见 RTMPStreamer::GetCodecParameters）。
+    // 输出目录不可用时抛出 std::runtime_error
+    SegmentRecorder(const AVCodecParameters* codecpar, AVRational time_base,
+                    RecorderConfig config);
+    ~SegmentRecorder();
+
+    SegmentRecorder(const SegmentRecorder&) = delete;
+    SegmentRecorder& operator=(const SegmentRecorder&) = delete;
+
+    // 由编码线程调用：引用 pkt 的数据（不拷贝）并入队，不等待磁盘
+    void OnPacket(const AVPacket& pkt);
+    // 标记事件，可从任意线程调用；在录像线程处理下一个包时生效
+    void Trigger();
+    // 写完队列中剩余的包并关闭当前分段
+    void Stop();
+
+    Stats GetStats() const;
+
+private:
+    // 以下在录像线程中调用
+    bool HandlePacket(AVPacketPtr& pkt);
+    bool OpenSegment();
+    void CloseSegment();
+    bool WriteToSegment(const AVPacket& pkt);
+    std::string SegmentPath() const;
+
+    RecorderConfig config;
+    AVCodecParameters* codecpar = nullptr;
+    AVRational time_base;
+    int64_t pre_event_ticks, post_event_ticks, segment_ticks;
+
+    std::atomic<bool> trigger_pending{false};
+
+    // 录像线程状态；统计字段由 stats_mutex 保护
+    mutable std::mutex stats_mutex;
+    PacketRing<AVPacketPtr> ring;
+    AVFormatContext* segment_ctx = nullptr;
+    int64_t segment_start = 0;      // 当前文件第一个包的 dts，写出时减去
+    int64_t segment_cut = 0;        // 当前分段的起始时间，用于判断何时切分
+    int64_t record_until = 0;       // 事件录制的截止时间
+    bool recording = false;
+    bool waiting_keyframe = false;  // 开始录制时缓冲为空，等关键帧再写
+    std::string event_stamp;        // 本次事件的时间标记，用于文件名
+    int segment_index = 0;
+    Stats stats;
+
+    std::unique_ptr<PacketWriter<AVPacketPtr>> queue;  // 最后创建，最先停止
+};
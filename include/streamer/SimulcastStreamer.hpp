@@ -0,0 +1,142 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "queue/FrameRing.hpp"
+#include "streamer/RTMPStreamer.hpp"
+
+// 一路输出（ABR 阶梯中的一级）
+struct Rendition {
+    std::string name;      // 例如 "720p"
+    int width = 0;
+    int height = 0;
+    EncoderConfig encoder;
+    std::string url;       // RTMP 地址或本地文件（例如 out_720p.flv）
+};
+
+// 同一路采集同时推多路分辨率（simulcast / ABR 阶梯）：
+// - 采集、解码、算法只做一次，PushFrame 接收处理好的源分辨率 YUV420P 帧；
+// - 缩放级联：每一级从上一级缩放（1080p → 720p → 360p），而不是都从源缩放，
+//   越往下的级别输入越小；
+// - 每一级一个线程：先把本级帧缩放给下一级，再交给本级编码器，各级编码并行；
+// - 各级之间用 Block 策略的有界队列连接，所有级别收到完全相同的帧序列，
+//   PTS 保持一致；关键帧按源帧序号强制插入（见 KeyframeSchedule），
+//   各级 GOP 互为整数倍时关键帧在时间上对齐，播放器可以在 GOP 边界无缝切换。
+// 网络写出仍由各级 RTMPStreamer 的写出线程负责，拥塞时按 GOP 丢包。
+class SimulcastStreamer {
+public:
+    struct RungStats {
+        std::string name;
+        int width = 0, height = 0;
+        uint64_t frames = 0;        // 已编码帧数（不含重复帧）
+        uint64_t repeated = 0;      // 编出的重复帧
+        double scale_ms_avg = 0.0;  // 为下一级缩放的平均耗时
+        double encode_ms_avg = 0.0; // 平均编码耗时（不含网络写出）
+        size_t queue_depth = 0;     // 本级输入队列长度
+        PacketWriter<AVPacketPtr>::Stats writer;
+        LatencyWindow::Summary capture_latency;  // 采集→本级包写出
+    };
+
+    // ladder 按分辨率从高到低排列，且不高于源分辨率；各级 gop_size 必须是
+    // 最小 gop_size 的整数倍。参数非法或某一级初始化失败时抛出 std::runtime_error
+    SimulcastStreamer(int src_width, int src_height, int fps,
+                      std::vector<Rendition> ladder);
+    ~SimulcastStreamer();
+
+    SimulcastStreamer(const SimulcastStreamer&) = delete;
+    SimulcastStreamer& operator=(const SimulcastStreamer&) = delete;
+
+    // 与 RTMPStreamer 相同的转换接口，输出源分辨率的池化 YUV420P 帧。
+    // ConvertFrame 共享 SwsContext，不能并发调用；另外两个可以并发
+    AVFramePtr ConvertFrame(const cv::Mat& rgbFrame);
+    AVFramePtr ConvertFromYUYV(const uint8_t* yuyv, int stride);
+    AVFramePtr ConvertFromMJPEG(JpegDecoder& decoder, const uint8_t* jpeg, size_t size);
+
+    // 送入一帧源分辨率的 YUV420P 帧，必须按帧顺序调用；第一级队列满时阻塞（背压给上游）。
+    // capture_ns 随帧传到每一级编码器，各级 PTS 取自同一个采集时钟
+    void PushFrame(AVFramePtr frame, int64_t capture_ns = 0);
+    // 画面静止时代替 PushFrame：各级依次调用 RTMPStreamer::RepeatFrame，不缩放也不编码新帧。
+    // 各级收到相同的采集时间，跳过/重复的决定一致，GOP 仍然对齐
+    void RepeatFrame(int64_t capture_ns = 0);
+    // 各级同时按比例调整码率（见 RTMPStreamer::SetBitRateScale），可在任意线程调用
+    void SetBitRateScale(double scale) {
+        for (auto& rung : rungs) rung->streamer->SetBitRateScale(scale);
+    }
+    // 至少有一级可以缩放码率（见 RTMPStreamer::SupportsBitRateScale）
+    bool SupportsBitRateScale() const {
+        for (const auto& rung : rungs) {
+            if (rung->streamer->SupportsBitRateScale()) return true;
+        }
+        return false;
+    }
+    // 停止接收新帧，等各级编码完队列中剩余的帧并排空编码器（RTMPStreamer::Flush）
+    void Stop();
+
+    std::vector<RungStats> GetStats() const;
+    // 第 index 级的编码器，例如用于 SetRecorder；index 按 ladder 顺序
+    RTMPStreamer& GetRungStreamer(size_t index) { return *rungs.at(index)->streamer; }
+
+    // 1080p / 720p / 360p 三级默认阶梯，url_prefix 后接 "_1080p" 等后缀
+    // 只保留不高于源分辨率的级别，宽度按源宽高比计算
+    static std::vector<Rendition> DefaultLadder(const std::string& url_prefix,
+                                                int src_width, int src_height);
+    // 检查阶梯是否满足构造函数的要求（见上），不满足时抛出 std::runtime_error
+    static void ValidateLadder(int src_width, int src_height,
+                               const std::vector<Rendition>& ladder);
+
+    // 单级的关键帧安排。源帧序号（PushFrame/RepeatFrame 的调用顺序）落在 GOP 边界时
+    // 本级欠一个关键帧，由本级下一个新编码的帧偿还。边界恰好是重复帧、或本级因帧池
+    // 耗尽没拿到这一帧时关键帧顺延，但下一个边界仍按源帧序号计算，偏移不会累积
+    class KeyframeSchedule {
+    public:
+        explicit KeyframeSchedule(int gop_size) : gop_size_(gop_size) {}
+        // 每个源帧按顺序调用一次；new_frame 为本级是否要编码一个新帧（重复帧为 false）。
+        // 返回该帧是否需要强制编为关键帧
+        bool next(uint64_t source_index, bool new_frame) {
+            if (gop_size_ > 0 && source_index % static_cast<uint64_t>(gop_size_) == 0) {
+                due_ = true;
+            }
+            if (!new_frame || !due_) return false;
+            due_ = false;
+            return true;
+        }
+
+    private:
+        int gop_size_;
+        bool due_ = false;
+    };
+
+private:
+    // 级间队列中的一帧及其采集时间；frame 为空表示重复上一帧
+    struct TimedFrame {
+        AVFramePtr frame;
+        int64_t capture_ns = 0;
+        uint64_t source_index = 0;  // 源帧序号，各级据此对齐关键帧
+    };
+
+    struct Rung {
+        Rendition config;
+        std::unique_ptr<RTMPStreamer> streamer;
+        // 从本级缩放到下一级（没有下一级时为空）
+        SwsContext* sws_to_next = nullptr;
+        BoundedRing<TimedFrame> input{2, OverflowPolicy::Block};
+        std::thread thread;
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> repeated{0};
+        std::atomic<uint64_t> scale_us{0}, encode_us{0};
+    };
+
+    void RunRung(size_t index);
+
+    int src_width, src_height;
+    AVFramePool source_pool;
+    SwsContext* sws_rgb = nullptr;
+    // 源帧与第一级尺寸不同时，在 PushFrame 中先缩放到第一级
+    SwsContext* sws_from_source = nullptr;
+    std::vector<std::unique_ptr<Rung>> rungs;
+    uint64_t next_source_index = 0;
+    bool stopped = false;
+};
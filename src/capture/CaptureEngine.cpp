@@ -0,0 +1,181 @@
+#include "capture/CaptureEngine.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+// 统计量平滑系数，与 RFC 3550 抖动估计一致取 1/16
+constexpr double kSmoothing = 1.0 / 16.0;
+constexpr int kMaxEvents = 16;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+}  // namespace
+
+CaptureEngine::CaptureEngine(unsigned loop_count) {
+    if (loop_count == 0) loop_count = 1;
+    loops_.resize(loop_count);
+}
+
+CaptureEngine::~CaptureEngine() {
+    stop();
+}
+
+int CaptureEngine::add_camera(V4L2Capture& capture, FrameCallback callback) {
+    if (running_) {
+        throw std::runtime_error("CaptureEngine 运行中不能添加摄像头");
+    }
+    auto cam = std::make_unique<Camera>();
+    cam->capture = &capture;
+    cam->callback = std::move(callback);
+    cam->loop = static_cast<unsigned>(cameras_.size() % loops_.size());
+    cameras_.push_back(std::move(cam));
+    return static_cast<int>(cameras_.size() - 1);
+}
+
+bool CaptureEngine::start() {
+    if (running_) return true;
+    for (auto& loop : loops_) {
+        loop.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop.epoll_fd < 0 || loop.wake_fd < 0) {
+            std::cerr << "[CaptureEngine] 创建 epoll/eventfd 失败" << std::endl;
+            stop();
+            return false;
+        }
+        // data.u32 使用 UINT32_MAX 标记唤醒事件，其余为 camera_id
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = UINT32_MAX;
+        epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, loop.wake_fd, &ev);
+    }
+    for (size_t id = 0; id < cameras_.size(); ++id) {
+        Camera& cam = *cameras_[id];
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(id);
+        if (epoll_ctl(loops_[cam.loop].epoll_fd, EPOLL_CTL_ADD,
+                      cam.capture->get_fd(), &ev) < 0) {
+            std::cerr << "[CaptureEngine] 摄像头 " << id << " 注册 epoll 失败" << std::endl;
+            stop();
+            return false;
+        }
+        cam.alive.store(true, std::memory_order_relaxed);
+    }
+    running_ = true;
+    for (auto& loop : loops_) {
+        loop.thread = std::thread(&CaptureEngine::run_loop, this, std::ref(loop));
+    }
+    return true;
+}
+
+void CaptureEngine::stop() {
+    running_ = false;
+    for (auto& loop : loops_) {
+        if (loop.wake_fd >= 0) {
+            uint64_t one = 1;
+            if (write(loop.wake_fd, &one, sizeof(one)) < 0) {
+                // eventfd 计数溢出时才会失败，线程仍会在下一次就绪时退出
+            }
+        }
+    }
+    for (auto& loop : loops_) {
+        if (loop.thread.joinable()) loop.thread.join();
+        if (loop.epoll_fd >= 0) close(loop.epoll_fd);
+        if (loop.wake_fd >= 0) close(loop.wake_fd);
+        loop.epoll_fd = -1;
+        loop.wake_fd = -1;
+    }
+}
+
+CaptureEngine::DeviceStats CaptureEngine::get_stats(int camera_id) const {
+    const Camera& cam = *cameras_.at(camera_id);
+    DeviceStats stats;
+    stats.frames = cam.frames.load(std::memory_order_relaxed);
+    stats.errors = cam.errors.load(std::memory_order_relaxed);
+    stats.driver_drops = cam.driver_drops.load(std::memory_order_relaxed);
+    stats.interval_ms = cam.interval_ms.load(std::memory_order_relaxed);
+    stats.jitter_ms = cam.jitter_ms.load(std::memory_order_relaxed);
+    stats.fps = stats.interval_ms > 0.0 ? 1000.0 / stats.interval_ms : 0.0;
+    return stats;
+}
+
+bool CaptureEngine::is_alive(int camera_id) const {
+    return cameras_.at(camera_id)->alive.load(std::memory_order_relaxed);
+}
+
+void CaptureEngine::run_loop(Loop& loop) {
+    epoll_event events[kMaxEvents];
+    while (running_) {
+        int n = epoll_wait(loop.epoll_fd, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[CaptureEngine] epoll_wait 失败" << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint32_t id = events[i].data.u32;
+            if (id == UINT32_MAX) continue;  // stop() 唤醒
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                drop_camera(loop, static_cast<int>(id), "设备报告错误/挂断");
+                continue;
+            }
+            drain_camera(loop, static_cast<int>(id));
+        }
+    }
+}
+
+void CaptureEngine::drop_camera(Loop& loop, int camera_id, const char* reason) {
+    Camera& cam = *cameras_[camera_id];
+    if (!cam.alive.exchange(false, std::memory_order_relaxed)) return;
+    cam.errors.fetch_add(1, std::memory_order_relaxed);
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, cam.capture->get_fd(), nullptr);
+    std::cerr << "[CaptureEngine] 摄像头 " << camera_id << " " << reason
+              << "，已停止监听" << std::endl;
+}
+
+void CaptureEngine::drain_camera(Loop& loop, int camera_id) {
+    Camera& cam = *cameras_[camera_id];
+    // 水平触发：一次把已完成的帧全部取出，剩余的下一轮 epoll_wait 仍会报告。
+    // 错误码由 try_acquire_frame 显式返回，回调可能已改写 errno
+    int error = 0;
+    while (FrameLease frame = cam.capture->try_acquire_frame(&error)) {
+        const int64_t t = now_ns();
+        if (cam.last_dequeue_ns != 0) {
+            const double interval = (t - cam.last_dequeue_ns) / 1e6;
+            double avg = cam.interval_ms.load(std::memory_order_relaxed);
+            avg = avg == 0.0 ? interval : avg + (interval - avg) * kSmoothing;
+            double jitter = cam.jitter_ms.load(std::memory_order_relaxed);
+            jitter += (std::fabs(interval - avg) - jitter) * kSmoothing;
+            cam.interval_ms.store(avg, std::memory_order_relaxed);
+            cam.jitter_ms.store(jitter, std::memory_order_relaxed);
+        }
+        cam.last_dequeue_ns = t;
+
+        if (cam.has_sequence) {
+            // 按 uint32 取差，驱动序号回绕时不会误算成大量丢帧
+            const uint32_t gap = static_cast<uint32_t>(frame->sequence - cam.last_sequence - 1);
+            if (gap) cam.driver_drops.fetch_add(gap, std::memory_order_relaxed);
+        }
+        cam.last_sequence = frame->sequence;
+        cam.has_sequence = true;
+
+        cam.frames.fetch_add(1, std::memory_order_relaxed);
+        if (cam.callback) cam.callback(camera_id, std::move(frame));
+    }
+    if (error == ENODEV) {
+        drop_camera(loop, camera_id, "已被拔出");
+    } else if (error != EAGAIN) {
+        cam.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,140 @@
+#include "capture/FrameSource.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "capture/ReplaySource.hpp"
+#include "capture/SyntheticSource.hpp"
+#include "capture/V4L2Capture.hpp"
+
+namespace {
+int64_t steady_ns(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+}  // namespace
+
+bool parse_pacing(const std::string& name, Pacing& pacing) {
+    if (name == "realtime") {
+        pacing = Pacing::RealTime;
+    } else if (name == "fixed") {
+        pacing = Pacing::FixedRate;
+    } else if (name == "unpaced") {
+        pacing = Pacing::Unpaced;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* pacing_name(Pacing pacing) {
+    switch (pacing) {
+        case Pacing::RealTime: return "realtime";
+        case Pacing::FixedRate: return "fixed";
+        case Pacing::Unpaced: return "unpaced";
+    }
+    return "?";
+}
+
+bool FrameSource::capture_frame(std::vector<uint8_t>& buffer, V4L2FrameView* info) {
+    FrameLease frame = acquire_frame();
+    if (!frame) {
+        return false;
+    }
+    buffer.assign(frame->data, frame->data + frame->bytesused);
+    if (buffer.empty()) {
+        throw std::runtime_error("摄像头返回空数据");
+    }
+    if (info) {
+        *info = *frame;
+        info->data = nullptr;
+    }
+    // frame 析构时缓冲区重新入队
+    return true;
+}
+
+FramePacer::FramePacer(Pacing pacing, double fps)
+    : pacing_(pacing),
+      period_ns_(fps > 0 ? static_cast<int64_t>(1e9 / fps) : 0) {
+    if (period_ns_ <= 0) pacing_ = Pacing::Unpaced;
+}
+
+void FramePacer::set_timeline(Timeline timeline) {
+    timeline_ = std::move(timeline);
+}
+
+bool FramePacer::next(std::chrono::steady_clock::time_point deadline, uint64_t& index,
+                      int64_t& due_ns) {
+    const int64_t now = steady_ns(std::chrono::steady_clock::now());
+    if (pacing_ == Pacing::Unpaced) {
+        index = next_++;
+        due_ns = now;
+        return true;
+    }
+    if (start_ns_ < 0) start_ns_ = now;
+    if (pacing_ == Pacing::RealTime) {
+        // 已经过了下一帧之后的帧的出帧时刻：中间的帧“采集”了但没人取，跳过
+        uint64_t current = next_;
+        if (timeline_) {
+            while (start_ns_ + timeline_(current + 1) <= now) ++current;
+        } else {
+            current = std::max(current, static_cast<uint64_t>((now - start_ns_) / period_ns_));
+        }
+        if (current > next_) {
+            skipped_.fetch_add(current - next_, std::memory_order_relaxed);
+            next_ = current;
+        }
+    }
+    const int64_t offset = pacing_ == Pacing::RealTime && timeline_
+                               ? timeline_(next_)
+                               : static_cast<int64_t>(next_) * period_ns_;
+    const int64_t due = start_ns_ + offset;
+    if (due > now) {
+        const auto due_tp = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(due));
+        if (due_tp > deadline) {
+            std::this_thread::sleep_until(deadline);
+            return false;
+        }
+        std::this_thread::sleep_until(due_tp);
+    }
+    index = next_++;
+    due_ns = due;
+    return true;
+}
+
+LeaseSlots::LeaseSlots(unsigned count) : busy_(std::max(1u, count), false) {}
+
+int LeaseSlots::acquire(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cv_.wait_until(lock, deadline, [this] { return leased_ < busy_.size(); })) return -1;
+    const auto it = std::find(busy_.begin(), busy_.end(), false);
+    *it = true;
+    ++leased_;
+    return static_cast<int>(it - busy_.begin());
+}
+
+void LeaseSlots::release(unsigned index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_[index] = false;
+        --leased_;
+    }
+    cv_.notify_one();
+}
+
+unsigned LeaseSlots::leased() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return leased_;
+}
+
+std::unique_ptr<FrameSource> open_frame_source(const std::string& spec,
+                                               const FrameSourceOptions& options) {
+    if (spec == "synthetic") return std::make_unique<SyntheticSource>(options, true);
+    if (spec == "synthetic:static") return std::make_unique<SyntheticSource>(options, false);
+    const std::string replay = "replay:";
+    if (spec.compare(0, replay.size(), replay) == 0) {
+        return std::make_unique<ReplaySource>(spec.substr(replay.size()), options);
+    }
+    return std::make_unique<V4L2Capture>(spec);
+}
@@ -0,0 +1,282 @@
+#include "capture/RawCapture.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+constexpr char kMagic[8] = {'V', 'S', 'R', 'A', 'W', 'C', 'A', 'P'};
+
+uint64_t align_up(uint64_t v, uint64_t align) { return (v + align - 1) / align * align; }
+}  // namespace
+
+RawCaptureWriter::RawCaptureWriter(const std::string& path, uint32_t fourcc, unsigned width,
+                                   unsigned height, Options options)
+    : path_(path), options_(options) {
+    if (options_.chunks < 2) options_.chunks = 2;
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("[RawCaptureWriter] 无法创建 " + path + ": " +
+                                 std::strerror(errno));
+    }
+    std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_.version = kRawCaptureVersion;
+    header_.header_bytes = kRawCaptureHeaderBytes;
+    header_.fourcc = fourcc;
+    header_.width = width;
+    header_.height = height;
+    header_.data_end = kRawCaptureHeaderBytes;
+    // 未完成的文件头：中途退出时读取端据此扫描重建索引
+    std::vector<uint8_t> head(kRawCaptureHeaderBytes, 0);
+    std::memcpy(head.data(), &header_, sizeof(header_));
+    ensure_allocated(kRawCaptureHeaderBytes);
+    if (!write_all(head.data(), head.size(), 0)) {
+        ::close(fd_);
+        throw std::runtime_error("[RawCaptureWriter] 写文件头失败: " + path);
+    }
+
+    // 块的内存在第一次使用时才分配
+    for (unsigned i = 0; i < options_.chunks; ++i) free_chunks_.push_back(std::make_unique<Chunk>());
+    writer_ = std::thread([this] { run_writer(); });
+}
+
+RawCaptureWriter::~RawCaptureWriter() { close(); }
+
+bool RawCaptureWriter::append(const V4L2FrameView& frame) {
+    if (closed_) return false;
+    const uint64_t record_bytes = align_up(sizeof(RawFrameRecord) + frame.bytesused, kRawRecordAlign);
+    if (current_ && current_->used + record_bytes > current_->data.size()) submit_current();
+    if (!current_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_chunks_.empty() || write_failed_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        current_ = std::move(free_chunks_.back());
+        free_chunks_.pop_back();
+        current_->used = 0;
+        current_->file_offset = next_offset_;
+        // 单帧比块还大（例如 4K YUYV）时按帧扩大，之后一直复用
+        const size_t want = std::max<size_t>(options_.chunk_bytes, record_bytes);
+        if (current_->data.size() < want) current_->data.resize(want);
+    }
+
+    uint8_t* dst = current_->data.data() + current_->used;
+    RawFrameRecord record{};
+    record.magic = kRawFrameMagic;
+    record.bytes = static_cast<uint32_t>(frame.bytesused);
+    record.sequence = frame.sequence;
+    record.capture_ns = frame.capture_ns;
+    std::memcpy(dst, &record, sizeof(record));
+    std::memcpy(dst + sizeof(record), frame.data, frame.bytesused);
+    // 对齐填充清零，文件内容可重复
+    std::memset(dst + sizeof(record) + frame.bytesused, 0,
+                record_bytes - sizeof(record) - frame.bytesused);
+
+    index_.push_back({next_offset_ + sizeof(record), record.bytes, frame.sequence, frame.capture_ns});
+    current_->used += record_bytes;
+    next_offset_ += record_bytes;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void RawCaptureWriter::submit_current() {
+    if (!current_) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(current_));
+    }
+    cv_.notify_one();
+}
+
+void RawCaptureWriter::run_writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) return;  // stopping_ 且已写完
+        std::unique_ptr<Chunk> chunk = std::move(pending_.front());
+        pending_.pop_front();
+        lock.unlock();
+        ensure_allocated(chunk->file_offset + chunk->used);
+        const bool ok = write_all(chunk->data.data(), chunk->used, chunk->file_offset);
+        if (ok) {
+            bytes_written_.fetch_add(chunk->used, std::memory_order_relaxed);
+            writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        lock.lock();
+        if (!ok) write_failed_ = true;
+        free_chunks_.push_back(std::move(chunk));
+    }
+}
+
+void RawCaptureWriter::ensure_allocated(uint64_t end) {
+    if (end <= allocated_ || options_.preallocate_bytes == 0) return;
+    const uint64_t target = std::max(end, allocated_ + options_.preallocate_bytes);
+    // 不改变文件长度，只预留磁盘块；不支持 fallocate 的文件系统上直接跳过
+    // （不用 posix_fallocate：它在这种情况下会退化为逐块写零）
+    if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated_),
+                  static_cast<off_t>(target - allocated_)) == 0) {
+        allocated_ = target;
+    } else {
+        options_.preallocate_bytes = 0;
+    }
+}
+
+bool RawCaptureWriter::write_all(const uint8_t* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        const ssize_t n = pwrite(fd_, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            std::cerr << "[RawCaptureWriter] 写入 " << path_ << " 失败: " << std::strerror(errno)
+                      << std::endl;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool RawCaptureWriter::close() {
+    if (closed_) return !write_failed_;
+    closed_ = true;
+    submit_current();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (writer_.joinable()) writer_.join();
+
+    bool ok = !write_failed_;
+    // 索引紧跟在最后一条记录之后，64 字节对齐
+    const uint64_t index_offset = align_up(next_offset_, kRawRecordAlign);
+    const size_t index_bytes = index_.size() * sizeof(RawIndexEntry);
+    ok = ok && write_all(reinterpret_cast<const uint8_t*>(index_.data()), index_bytes, index_offset);
+    header_.frame_count = index_.size();
+    header_.index_offset = index_offset;
+    header_.data_end = next_offset_;
+    header_.flags |= kRawCaptureFinalized;
+    // 文件头最后写：之前任何一步失败，文件都保持“未完成”，读取端按记录头重建
+    ok = ok && fdatasync(fd_) == 0;
+    ok = ok && write_all(reinterpret_cast<const uint8_t*>(&header_), sizeof(header_), 0);
+    // 释放预分配但没有用到的部分
+    ok = ok && ftruncate(fd_, static_cast<off_t>(index_offset + index_bytes)) == 0;
+    ok = ok && fsync(fd_) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    if (!ok) std::cerr << "[RawCaptureWriter] 关闭 " << path_ << " 时出错" << std::endl;
+    return ok;
+}
+
+RawCaptureWriter::Stats RawCaptureWriter::stats() const {
+    Stats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    s.writes = writes_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool RawCaptureReader::probe(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kMagic)] = {};
+    in.read(magic, sizeof(magic));
+    return in && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+RawCaptureReader::RawCaptureReader(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("[RawCaptureReader] 无法打开 " + path + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < kRawCaptureHeaderBytes) {
+        ::close(fd);
+        throw std::runtime_error("[RawCaptureReader] 文件过短: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("[RawCaptureReader] mmap 失败: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(addr);
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header_.version != kRawCaptureVersion || header_.header_bytes < sizeof(header_)) {
+        munmap(addr, size_);
+        throw std::runtime_error("[RawCaptureReader] 不是原始录制文件: " + path);
+    }
+
+    if (finalized() && header_.index_offset % alignof(RawIndexEntry) == 0 &&
+        header_.index_offset >= header_.header_bytes && header_.index_offset <= size_ &&
+        header_.frame_count <= (size_ - header_.index_offset) / sizeof(RawIndexEntry)) {
+        // 索引项指向的负载必须落在索引之前的映射范围内，否则 frame() 会越界读；
+        // 文件头或索引损坏时放弃索引，退回扫描
+        const auto* index = reinterpret_cast<const RawIndexEntry*>(data_ + header_.index_offset);
+        bool valid = true;
+        for (uint64_t i = 0; i < header_.frame_count && valid; ++i) {
+            valid = index[i].offset >= header_.header_bytes &&
+                    index[i].offset <= header_.index_offset &&
+                    index[i].bytes <= header_.index_offset - index[i].offset;
+        }
+        if (valid) {
+            index_ = index;
+            count_ = header_.frame_count;
+            return;
+        }
+        std::cerr << "[RawCaptureReader] " << path << " 索引损坏，改为扫描帧记录" << std::endl;
+    }
+    // 录制未正常结束或索引无效：按记录头扫描，遇到第一条无效/不完整的记录为止
+    header_.flags &= ~kRawCaptureFinalized;
+    uint64_t offset = header_.header_bytes;
+    while (offset + sizeof(RawFrameRecord) <= size_) {
+        RawFrameRecord record;
+        std::memcpy(&record, data_ + offset, sizeof(record));
+        const uint64_t payload = offset + sizeof(record);
+        if (record.magic != kRawFrameMagic || payload + record.bytes > size_) break;
+        rebuilt_index_.push_back({payload, record.bytes, record.sequence, record.capture_ns});
+        offset = align_up(payload + record.bytes, kRawRecordAlign);
+    }
+    count_ = rebuilt_index_.size();
+    std::cerr << "[RawCaptureReader] " << path << " 未正常结束，扫描恢复 " << count_ << " 帧"
+              << std::endl;
+}
+
+RawCaptureReader::~RawCaptureReader() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+RawCaptureReader::Frame RawCaptureReader::frame(size_t i) const {
+    const RawIndexEntry& e = entry(i);
+    Frame f;
+    f.data = data_ + e.offset;
+    f.bytes = e.bytes;
+    f.sequence = e.sequence;
+    f.capture_ns = e.capture_ns;
+    return f;
+}
+
+size_t RawCaptureReader::seek_time(int64_t capture_ns) const {
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (entry(mid).capture_ns < capture_ns) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,226 @@
+#include "capture/ReplaySource.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "processor/JpegDecoder.hpp"
+
+ReplaySource::Mapping::~Mapping() {
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+}
+
+ReplaySource::ReplaySource(std::string path, FrameSourceOptions options)
+    : path_(std::move(path)), options_(options), pacer_(options.pacing, options.fps) {}
+
+bool ReplaySource::initialize(unsigned width, unsigned height) {
+    if (RawCaptureReader::probe(path_)) return initialize_recording();
+    const int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[ReplaySource] 无法打开 " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        std::cerr << "[ReplaySource] 文件为空: " << path_ << std::endl;
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后不再需要 fd
+    if (addr == MAP_FAILED) {
+        std::cerr << "[ReplaySource] mmap 失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // 顺序读取，让内核提前预读
+    madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    auto mapping = std::make_shared<Mapping>();
+    mapping->data = static_cast<const uint8_t*>(addr);
+    mapping->size = static_cast<size_t>(st.st_size);
+    mapping_ = mapping;
+
+    width_ = width;
+    height_ = height;
+    const uint8_t* d = mapping_->data;
+    const bool is_mjpeg = mapping_->size >= 3 && d[0] == 0xFF && d[1] == 0xD8 && d[2] == 0xFF;
+    const uint32_t detected = is_mjpeg ? V4L2_PIX_FMT_MJPEG : V4L2_PIX_FMT_YUYV;
+    if (detected != pixel_format_) {
+        std::cout << "[ReplaySource] 文件内容为 " << (is_mjpeg ? "MJPEG" : "YUYV")
+                  << "，按文件格式回放" << std::endl;
+        pixel_format_ = detected;
+    }
+
+    frames_.clear();
+    if (is_mjpeg) {
+        index_mjpeg();
+        // MJPEG 的分辨率以文件为准
+        int w = 0, h = 0;
+        if (!frames_.empty() &&
+            JpegDecoder::parse_sof(d + frames_[0].first, frames_[0].second, w, h) &&
+            (static_cast<unsigned>(w) != width_ || static_cast<unsigned>(h) != height_)) {
+            std::cout << "[ReplaySource] JPEG 分辨率为 " << w << "x" << h << std::endl;
+            width_ = w;
+            height_ = h;
+        }
+    } else {
+        const size_t frame_bytes = static_cast<size_t>(width_) * height_ * 2;
+        if (frame_bytes == 0) return false;
+        for (size_t off = 0; off + frame_bytes <= mapping_->size; off += frame_bytes) {
+            frames_.emplace_back(off, frame_bytes);
+        }
+        if (mapping_->size % frame_bytes != 0) {
+            std::cerr << "[ReplaySource] 文件末尾有 " << mapping_->size % frame_bytes
+                      << " 字节不足一帧，已忽略（分辨率是否正确？）" << std::endl;
+        }
+    }
+    if (frames_.empty()) {
+        std::cerr << "[ReplaySource] 文件中没有完整的帧: " << path_ << std::endl;
+        return false;
+    }
+    slots_ = std::make_shared<LeaseSlots>(buffer_count_);
+    return true;
+}
+
+bool ReplaySource::initialize_recording() {
+    std::shared_ptr<const RawCaptureReader> raw;
+    try {
+        raw = std::make_shared<const RawCaptureReader>(path_);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+    if (raw->frame_count() == 0) {
+        std::cerr << "[ReplaySource] 录制文件中没有帧: " << path_ << std::endl;
+        return false;
+    }
+    if (raw->fourcc() != pixel_format_) {
+        std::cout << "[ReplaySource] 录制文件为 "
+                  << (raw->fourcc() == V4L2_PIX_FMT_MJPEG ? "MJPEG" : "YUYV") << "，按文件格式回放"
+                  << std::endl;
+        pixel_format_ = raw->fourcc();
+    }
+    width_ = raw->width();
+    height_ = raw->height();
+
+    const size_t n = raw->frame_count();
+    const RawCaptureReader::Frame first = raw->frame(0);
+    const RawCaptureReader::Frame last = raw->frame(n - 1);
+    sequence_span_ = last.sequence - first.sequence + 1;
+    if (pacer_.pacing() == Pacing::RealTime) {
+        const int64_t span = last.capture_ns - first.capture_ns;
+        // 循环时最后一帧到下一遍第一帧之间取平均帧间隔
+        // （至少 1ns，保证时间线严格递增）
+        const int64_t gap = std::max<int64_t>(
+            1, n > 1 ? span / static_cast<int64_t>(n - 1) : static_cast<int64_t>(1e9 / options_.fps));
+        const int64_t t0 = first.capture_ns;
+        pacer_.set_timeline([raw, n, t0, span, gap](uint64_t i) {
+            return (raw->frame(i % n).capture_ns - t0) +
+                   static_cast<int64_t>(i / n) * (span + gap);
+        });
+    }
+    raw_ = std::move(raw);
+    slots_ = std::make_shared<LeaseSlots>(buffer_count_);
+    return true;
+}
+
+void ReplaySource::index_mjpeg() {
+    const uint8_t* d = mapping_->data;
+    const size_t size = mapping_->size;
+    auto is_soi = [&](size_t i) {
+        return i + 2 < size && d[i] == 0xFF && d[i + 1] == 0xD8 && d[i + 2] == 0xFF;
+    };
+    // 部分 UVC 摄像头按缓冲区大小在 EOI 之后补 0x00/0xFF，直接 dump 的文件里
+    // 帧与帧之间会夹着这些填充字节
+    auto skip_padding = [&](size_t i) {
+        while (i < size && (d[i] == 0x00 || d[i] == 0xFF) && !is_soi(i)) ++i;
+        return i;
+    };
+    // EOI 之后（跳过填充）紧跟下一帧的 SOI 或文件结束才算一帧的结尾
+    auto is_end = [&](size_t i) {
+        if (d[i] != 0xFF || d[i + 1] != 0xD9) return false;
+        const size_t next = skip_padding(i + 2);
+        return next == size || is_soi(next);
+    };
+    size_t start = 0;
+    while (start < size && is_soi(start)) {
+        size_t end = start + 2;
+        while (end + 1 < size && !is_end(end)) ++end;
+        if (end + 1 >= size) break;  // 最后一帧不完整
+        frames_.emplace_back(start, end + 2 - start);
+        start = skip_padding(end + 2);
+    }
+    if (start < size) {
+        std::cerr << "[ReplaySource] 文件末尾有 " << size - start << " 字节不是完整的 JPEG，已忽略"
+                  << std::endl;
+    }
+}
+
+FrameLease ReplaySource::acquire_frame(int timeout_ms) {
+    if (!slots_ || finished()) return nullptr;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    const int slot = slots_->acquire(deadline);
+    if (slot < 0) return nullptr;
+    uint64_t index = 0;
+    int64_t due_ns = 0;
+    if (!pacer_.next(deadline, index, due_ns)) {
+        slots_->release(static_cast<unsigned>(slot));
+        return nullptr;
+    }
+    // 只播放一遍时，RealTime 跳过的帧也计入播放进度
+    const size_t count = frame_count();
+    const uint64_t limit = options_.frame_limit ? options_.frame_limit : count;
+    if (index >= limit) {
+        finished_.store(true, std::memory_order_relaxed);
+        slots_->release(static_cast<unsigned>(slot));
+        return nullptr;
+    }
+
+    auto* view = new V4L2FrameView;
+    if (raw_) {
+        // 保留录制时的驱动序号（能看出录制时驱动侧的丢帧），每循环一遍整体后移
+        const RawCaptureReader::Frame f = raw_->frame(index % count);
+        view->data = f.data;
+        view->bytesused = f.bytes;
+        view->sequence = f.sequence + static_cast<uint32_t>(index / count) * sequence_span_;
+    } else {
+        const auto& [offset, length] = frames_[index % count];
+        view->data = mapping_->data + offset;
+        view->bytesused = length;
+        view->sequence = static_cast<uint32_t>(index);
+    }
+    view->index = static_cast<uint32_t>(slot);
+    view->capture_ns = due_ns;
+    view->timestamp.tv_sec = static_cast<time_t>(due_ns / 1000000000LL);
+    view->timestamp.tv_usec = static_cast<suseconds_t>((due_ns % 1000000000LL) / 1000);
+
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    if (index + 1 >= limit) finished_.store(true, std::memory_order_relaxed);
+    std::shared_ptr<LeaseSlots> slots = slots_;
+    std::shared_ptr<const Mapping> mapping = mapping_;
+    std::shared_ptr<const RawCaptureReader> raw = raw_;
+    return FrameLease(view, [slots, mapping, raw](const V4L2FrameView* v) {
+        slots->release(v->index);
+        delete v;
+    });
+}
+
+std::string ReplaySource::describe() const {
+    std::ostringstream out;
+    out << "replay " << path_ << " (" << (pixel_format_ == V4L2_PIX_FMT_MJPEG ? "MJPEG " : "YUYV ")
+        << width_ << "x" << height_ << ", " << frame_count() << " 帧" << (raw_ ? "，录制文件" : "")
+        << ") "
+        << pacing_name(pacer_.pacing());
+    if (raw_ && pacer_.pacing() == Pacing::RealTime) {
+        out << " @录制时间";
+    } else if (pacer_.pacing() != Pacing::Unpaced) {
+        out << " @" << options_.fps << "fps";
+    }
+    return out.str();
+}
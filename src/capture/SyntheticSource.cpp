@@ -0,0 +1,126 @@
+#include "capture/SyntheticSource.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+SyntheticSource::SyntheticSource(FrameSourceOptions options, bool motion)
+    : options_(options), motion_(motion), pacer_(options.pacing, options.fps) {}
+
+bool SyntheticSource::initialize(unsigned width, unsigned height) {
+    if (width == 0 || height == 0 || width % 2 != 0) {
+        std::cerr << "[SyntheticSource] 不支持的分辨率 " << width << "x" << height << std::endl;
+        return false;
+    }
+    if (pixel_format_ != V4L2_PIX_FMT_YUYV && pixel_format_ != V4L2_PIX_FMT_MJPEG) {
+        std::cerr << "[SyntheticSource] 只支持 YUYV 与 MJPEG" << std::endl;
+        return false;
+    }
+    width_ = width;
+    height_ = height;
+
+    // 图案按列周期为 width：两倍宽的一行里第 x 列与第 x + width 列相同，
+    // 任意偏移截取 width 列都是无缝的画面
+    const size_t row_bytes = static_cast<size_t>(width_) * 4;
+    pattern_.assign(row_bytes * height_, 0);
+    for (unsigned y = 0; y < height_; ++y) {
+        uint8_t* row = &pattern_[y * row_bytes];
+        for (unsigned x = 0; x < width_ * 2; x += 2) {
+            const unsigned px = x % width_;
+            const bool cell = ((px / 64) + (y / 64)) % 2 == 0;
+            const uint8_t base = static_cast<uint8_t>((px * 96) / width_ + (y * 64) / height_);
+            row[x * 2 + 0] = static_cast<uint8_t>(base + (cell ? 120 : 16));
+            row[x * 2 + 1] = static_cast<uint8_t>(96 + (px * 64) / width_);  // U
+            row[x * 2 + 2] = static_cast<uint8_t>(base + (cell ? 124 : 20));
+            row[x * 2 + 3] = static_cast<uint8_t>(160 - (y * 64) / height_);  // V
+        }
+    }
+
+    slots_ = std::make_shared<LeaseSlots>(buffer_count_);
+    const size_t frame_bytes = static_cast<size_t>(width_) * height_ * 2;
+    if (pixel_format_ == V4L2_PIX_FMT_YUYV) {
+        yuyv_buffers_ = std::make_shared<std::vector<std::vector<uint8_t>>>(
+            slots_->count(), std::vector<uint8_t>(frame_bytes));
+    } else {
+        // 预先编码一个周期；静止画面只需一帧
+        auto jpegs = std::make_shared<std::vector<std::vector<uint8_t>>>();
+        std::vector<uint8_t> yuyv(frame_bytes);
+        cv::Mat bgr;
+        for (unsigned i = 0; i < (motion_ ? kJpegCycle : 1u); ++i) {
+            render_yuyv(i, yuyv.data());
+            cv::cvtColor(cv::Mat(height_, width_, CV_8UC2, yuyv.data()), bgr,
+                         cv::COLOR_YUV2BGR_YUYV);
+            std::vector<uint8_t> jpeg;
+            if (!cv::imencode(".jpg", bgr, jpeg, {cv::IMWRITE_JPEG_QUALITY, 85})) {
+                std::cerr << "[SyntheticSource] JPEG 编码失败" << std::endl;
+                return false;
+            }
+            jpegs->push_back(std::move(jpeg));
+        }
+        jpeg_frames_ = std::move(jpegs);
+    }
+    return true;
+}
+
+void SyntheticSource::render_yuyv(uint64_t index, uint8_t* dst) const {
+    const size_t row_bytes = static_cast<size_t>(width_) * 2;
+    // 每帧右移 4 像素（保持偶数列，不拆开 YUYV 的像素对）
+    const size_t offset = motion_ ? (index * 4) % width_ : 0;
+    for (unsigned y = 0; y < height_; ++y) {
+        std::memcpy(dst + y * row_bytes, &pattern_[y * row_bytes * 2 + offset * 2], row_bytes);
+    }
+}
+
+FrameLease SyntheticSource::acquire_frame(int timeout_ms) {
+    if (!slots_ || finished()) return nullptr;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    // 先等空闲缓冲区再排定出帧时刻：RealTime 下等待期间错过的帧会被跳过，与摄像头一致
+    const int slot = slots_->acquire(deadline);
+    if (slot < 0) return nullptr;
+    uint64_t index = 0;
+    int64_t due_ns = 0;
+    if (!pacer_.next(deadline, index, due_ns)) {
+        slots_->release(static_cast<unsigned>(slot));
+        return nullptr;
+    }
+
+    auto* view = new V4L2FrameView;
+    view->index = static_cast<uint32_t>(slot);
+    view->sequence = static_cast<uint32_t>(index);
+    view->capture_ns = due_ns;
+    view->timestamp.tv_sec = static_cast<time_t>(due_ns / 1000000000LL);
+    view->timestamp.tv_usec = static_cast<suseconds_t>((due_ns % 1000000000LL) / 1000);
+    std::shared_ptr<const void> storage;
+    if (yuyv_buffers_) {
+        auto& buffer = (*yuyv_buffers_)[slot];
+        render_yuyv(index, buffer.data());
+        view->data = buffer.data();
+        view->bytesused = buffer.size();
+        storage = yuyv_buffers_;
+    } else {
+        const auto& jpeg = (*jpeg_frames_)[index % jpeg_frames_->size()];
+        view->data = jpeg.data();
+        view->bytesused = jpeg.size();
+        storage = jpeg_frames_;
+    }
+
+    const uint64_t delivered = delivered_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (options_.frame_limit && delivered >= options_.frame_limit) {
+        finished_.store(true, std::memory_order_relaxed);
+    }
+    std::shared_ptr<LeaseSlots> slots = slots_;
+    return FrameLease(view, [slots, storage](const V4L2FrameView* v) {
+        slots->release(v->index);
+        delete v;
+    });
+}
+
+std::string SyntheticSource::describe() const {
+    std::ostringstream out;
+    out << "synthetic " << (motion_ ? "" : "static ")
+        << (pixel_format_ == V4L2_PIX_FMT_MJPEG ? "MJPEG " : "YUYV ") << width_ << "x" << height_
+        << " " << pacing_name(pacer_.pacing());
+    if (pacer_.pacing() != Pacing::Unpaced) out << " @" << options_.fps << "fps";
+    return out.str();
+}
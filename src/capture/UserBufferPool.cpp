@@ -0,0 +1,28 @@
+#include "capture/UserBufferPool.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+UserBufferPool::UserBufferPool(unsigned count, size_t buffer_size) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    // 长度同样取整到页大小，部分驱动要求 USERPTR 长度是页的整数倍
+    buffer_size_ = (buffer_size + page - 1) / page * page;
+    buffers_.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, page, buffer_size_) != 0) {
+            for (uint8_t* p : buffers_) free(p);
+            throw std::runtime_error("分配页对齐用户缓冲区失败");
+        }
+        // 预先触碰每一页，避免采集时才发生缺页
+        std::memset(ptr, 0, buffer_size_);
+        buffers_.push_back(static_cast<uint8_t*>(ptr));
+    }
+}
+
+UserBufferPool::~UserBufferPool() {
+    for (uint8_t* p : buffers_) free(p);
+}
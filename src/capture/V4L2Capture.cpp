@@ -5,24 +5,31 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
-#include <sys/select.h>
+#include <poll.h>
+#include <cerrno>
+#include <chrono>
 #include <stdexcept>
 
-V4L2Capture::V4L2Capture(const std::string& device) {
+V4L2Capture::V4L2Capture(const std::string& device) : device_(device) {
     // 读写 非阻塞
     fd_ = open(device.c_str(), O_RDWR | O_NONBLOCK);
     if (fd_ < 0) {
         throw std::runtime_error("Failed to open V4L2 device");
     }
+    lease_state_ = std::make_shared<LeaseState>();
+    lease_state_->fd = fd_;
 }
 
 V4L2Capture::~V4L2Capture() {
+    // 先断开租约与本对象的联系，之后释放的租约不会再对已关闭的 fd 做 QBUF
+    lease_state_.reset();
     // 释放资源
     if (fd_ >= 0) {
         v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         ioctl(fd_, VIDIOC_STREAMOFF, &type);
         for (size_t i = 0; i < mapped_buffers_.size(); ++i) {
-            if (mapped_buffers_[i]) {
+            // USERPTR 模式下内存属于用户缓冲池，不能 munmap
+            if (memory_mode_ == MemoryMode::MMAP && mapped_buffers_[i]) {
                 munmap(mapped_buffers_[i], buffer_lengths_[i]);
             }
         }
@@ -32,7 +39,21 @@ V4L2Capture::~V4L2Capture() {
 
 bool V4L2Capture::initialize(unsigned width, unsigned height) {
     if (!set_format(width, height)) return false;
-    return init_mmap();
+    if (memory_mode_ == MemoryMode::USERPTR) {
+        if (init_userptr()) return start_streaming();
+        // 驱动拒绝 USERPTR（例如只支持 MMAP 的 UVC 旧驱动），退回 MMAP
+        std::cerr << "[V4L2Capture] 驱动不支持 USERPTR，退回 MMAP 模式" << std::endl;
+        memory_mode_ = MemoryMode::MMAP;
+        user_pool_.reset();
+    }
+    if (!init_mmap()) return false;
+    return start_streaming();
+}
+
+void V4L2Capture::set_memory_mode(MemoryMode mode,
+                                  std::shared_ptr<UserBufferPool> pool) {
+    memory_mode_ = mode;
+    user_pool_ = std::move(pool);
 }
 
 
@@ -42,23 +63,33 @@ bool V4L2Capture::set_format(unsigned width, unsigned height) {
     fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     fmt.fmt.pix.width = width;
     fmt.fmt.pix.height = height;
-    fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;  // 硬件压缩格式
+    fmt.fmt.pix.pixelformat = pixel_format_;
     // 将配置发送给驱动
     if (ioctl(fd_, VIDIOC_S_FMT, &fmt) < 0) return false;
+    // 不支持请求的格式时驱动会换成别的格式，继续下去解码端会按错误的格式解析
+    if (fmt.fmt.pix.pixelformat != pixel_format_) {
+        const uint32_t got = fmt.fmt.pix.pixelformat;
+        std::cerr << "[V4L2Capture] 设备不支持请求的像素格式，驱动返回 "
+                  << static_cast<char>(got & 0xFF) << static_cast<char>((got >> 8) & 0xFF)
+                  << static_cast<char>((got >> 16) & 0xFF) << static_cast<char>(got >> 24)
+                  << std::endl;
+        return false;
+    }
 
     // 驱动可能会调整至它支持的最接近的分辨率，读回 fmt.fmt.pix.
     // 驱动会返回实际生效的格式
     width_ = fmt.fmt.pix.width;
     height_ = fmt.fmt.pix.height;
+    size_image_ = fmt.fmt.pix.sizeimage;
     return true;
 }
 
 // 请求内核分配缓冲区
 // 把这些缓冲区映射到用户空间
 bool V4L2Capture::init_mmap() {
-    // 1) 请求 4 个缓冲区，类型：视频捕捉、内存映射
+    // 1) 请求 requested_buffers_ 个缓冲区（默认 4），类型：视频捕捉、内存映射
     v4l2_requestbuffers req{};
-    req.count = 4;
+    req.count = requested_buffers_;
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     req.memory = V4L2_MEMORY_MMAP;
     // 对这个设备申请缓存区
@@ -86,12 +117,54 @@ bool V4L2Capture::init_mmap() {
                                   MAP_SHARED, fd_, buf.m.offset);
         if (mapped_buffers_[i] == MAP_FAILED) return false;
     }
-    // 4) 把所有缓冲区 “入队” 到采集队列：driver 会往这些队列里不断填充新帧
+    lease_state_->memory = V4L2_MEMORY_MMAP;
+    return true;
+}
+
+bool V4L2Capture::init_userptr() {
+    // 1) 申请 USERPTR 类型的缓冲区：驱动只分配描述符，不分配内存
+    v4l2_requestbuffers req{};
+    req.count = user_pool_ ? user_pool_->count() : requested_buffers_;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_USERPTR;
+    if (ioctl(fd_, VIDIOC_REQBUFS, &req) < 0 || req.count == 0) return false;
+
+    // 2) 没有外部缓冲池时按驱动报告的单帧大小自己创建
+    if (!user_pool_) {
+        user_pool_ = std::make_shared<UserBufferPool>(req.count, size_image_);
+    }
+    if (user_pool_->count() < req.count || user_pool_->buffer_size() < size_image_) {
+        std::cerr << "[V4L2Capture] 用户缓冲池容量不足: 需要 " << req.count
+                  << " x " << size_image_ << " 字节" << std::endl;
+        // 释放已申请的描述符，保证退回 MMAP 时状态干净
+        req.count = 0;
+        ioctl(fd_, VIDIOC_REQBUFS, &req);
+        return false;
+    }
+
+    mapped_buffers_.resize(req.count);
+    buffer_lengths_.resize(req.count);
     for (unsigned i = 0; i < req.count; ++i) {
+        mapped_buffers_[i] = user_pool_->data(i);
+        buffer_lengths_[i] = user_pool_->buffer_size();
+    }
+    lease_state_->memory = V4L2_MEMORY_USERPTR;
+    lease_state_->user_ptrs = mapped_buffers_;
+    lease_state_->user_lengths = buffer_lengths_;
+    return true;
+}
+
+bool V4L2Capture::start_streaming() {
+    // 4) 把所有缓冲区 “入队” 到采集队列：driver 会往这些队列里不断填充新帧
+    for (unsigned i = 0; i < mapped_buffers_.size(); ++i) {
         v4l2_buffer buf{};
         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
+        buf.memory = lease_state_->memory;
         buf.index = i;
+        if (buf.memory == V4L2_MEMORY_USERPTR) {
+            buf.m.userptr = reinterpret_cast<unsigned long>(mapped_buffers_[i]);
+            buf.length = static_cast<uint32_t>(buffer_lengths_[i]);
+        }
         // 把编号为 i 的空缓冲区放入内核的采集队列  把空的缓冲区交给驱动去填数据
         if (ioctl(fd_, VIDIOC_QBUF, &buf) < 0) return false;
     }
@@ -100,44 +173,105 @@ bool V4L2Capture::init_mmap() {
     return ioctl(fd_, VIDIOC_STREAMON, &type) >= 0;
 }
 
-bool V4L2Capture::capture_frame(std::vector<uint8_t>& buffer) {
-    // 1) 等待 fd_ “可读” —— 意味着至少一个缓冲区里已有完整一帧
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(fd_, &fds);
-    timeval tv{2, 0}; // 最长等 2 秒
-    int ret = select(fd_ + 1, &fds, nullptr, nullptr, &tv);
-    if (ret <= 0) {
-        // ret == 0 表示超时；ret < 0 表示出错
-        return false;
+unsigned V4L2Capture::get_leased_count() const {
+    return lease_state_ ? lease_state_->leased.load(std::memory_order_relaxed)
+                        : 0;
+}
+
+void V4L2Capture::requeue(LeaseState& state, uint32_t index) {
+    v4l2_buffer buf{};
+    buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = state.memory;
+    buf.index  = index;
+    if (state.memory == V4L2_MEMORY_USERPTR) {
+        buf.m.userptr = reinterpret_cast<unsigned long>(state.user_ptrs[index]);
+        buf.length = static_cast<uint32_t>(state.user_lengths[index]);
+    }
+    if (ioctl(state.fd, VIDIOC_QBUF, &buf) < 0) {
+        std::cerr << "[V4L2Capture] 缓冲区 " << index << " 重新入队失败" << std::endl;
     }
+    state.leased.fetch_sub(1, std::memory_order_relaxed);
+}
 
-    // 2) 循环尝试 DQBUF，直到成功或遇到非 EAGAIN 错误
+FrameLease V4L2Capture::try_acquire_frame(int* error) {
+    // fd_ 以 O_NONBLOCK 打开，没有已完成的帧时 DQBUF 立即返回 EAGAIN
     v4l2_buffer buf{};
     buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_MMAP;
-
-    for (int attempts = 0; attempts < 3; ++attempts) {
-        if (ioctl(fd_, VIDIOC_DQBUF, &buf) == 0) {
-            // 成功取到一帧
-            const auto* src = static_cast<uint8_t*>(mapped_buffers_[buf.index]);
-            buffer.assign(src, src + buf.bytesused);
-            if (buffer.empty()) {
-                throw std::runtime_error("摄像头返回空数据");
+    buf.memory = lease_state_->memory;
+    if (ioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+        if (error) *error = errno;
+        return nullptr;
+    }
+    if (error) *error = 0;
+
+    // 成功取到一帧：只记录位置和元数据，不拷贝像素
+    auto* view = new V4L2FrameView;
+    view->data = static_cast<const uint8_t*>(mapped_buffers_[buf.index]);
+    view->bytesused = buf.bytesused;
+    view->index = buf.index;
+    view->sequence = buf.sequence;
+    view->timestamp = buf.timestamp;
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC &&
+        (buf.timestamp.tv_sec != 0 || buf.timestamp.tv_usec != 0)) {
+        view->capture_ns = static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000000LL +
+                           static_cast<int64_t>(buf.timestamp.tv_usec) * 1000LL;
+    } else {
+        view->capture_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    lease_state_->leased.fetch_add(1, std::memory_order_relaxed);
+    std::weak_ptr<LeaseState> weak = lease_state_;
+    // 最后一个持有者释放时重新入队
+    return FrameLease(view, [weak](const V4L2FrameView* v) {
+        if (auto state = weak.lock()) {
+            requeue(*state, v->index);
+        }
+        delete v;
+    });
+}
+
+FrameLease V4L2Capture::acquire_frame(int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        // 1) 等待 fd_ “可读” —— 意味着至少一个缓冲区里已有完整一帧
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() < 0) return nullptr;  // 超时
+        pollfd pfd{fd_, POLLIN, 0};
+        int ret = poll(&pfd, 1, static_cast<int>(remaining.count()));
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) {
+            // ret == 0 表示超时；ret < 0 表示出错
+            return nullptr;
+        }
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            // 设备被拔出或流已停止
+            return nullptr;
+        }
+
+        // 2) 可读后 DQBUF；极少数情况下唤醒后仍是 EAGAIN（被其他线程取走），
+        //    此时回到 poll 继续等待，而不是 sleep 重试
+        int error = 0;
+        if (FrameLease frame = try_acquire_frame(&error)) {
+            if (latest_frame_) {
+                // 3) 低延迟模式：取出其余已完成的帧，换下来的旧租约析构时立即重新入队
+                while (FrameLease newer = try_acquire_frame()) {
+                    frame = std::move(newer);
+                    stale_dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
             }
-            // std::cout << "采集数据大小: " << buffer.size() << " 字节" << std::endl;
-            // 重新入队
-            ioctl(fd_, VIDIOC_QBUF, &buf);
-            return !buffer.empty();
+            return frame;
         }
-        if (errno != EAGAIN) {
+        if (error != EAGAIN) {
             // 真正的错误
-            return false;
+            return nullptr;
         }
-        // 如果是 EAGAIN，短暂休息再重试
-        usleep(1000); // 1 ms
     }
+}
 
-    // 多次 EAGAIN 后仍然失败
-    return false;
-}
\ No newline at end of file
+std::string V4L2Capture::describe() const {
+    return device_ + (pixel_format_ == V4L2_PIX_FMT_MJPEG ? " MJPEG " : " YUYV ") +
+           std::to_string(width_) + "x" + std::to_string(height_);
+}
@@ -0,0 +1,98 @@
+#include "pipeline/LoadGovernor.hpp"
+
+#include <algorithm>
+
+LoadGovernor::LoadGovernor(Options options) : options_(options) {
+    options_.target_fps = std::max(1.0, options_.target_fps);
+    options_.max_level = std::clamp(options_.max_level, 0, kLevelCount - 1);
+}
+
+const char* LoadGovernor::level_name(Level level) {
+    switch (level) {
+        case Level::Full: return "full";
+        case Level::ReducedResolution: return "reduced_resolution";
+        case Level::FrameSkip: return "frame_skip";
+        case Level::EncoderReduced: return "encoder_reduced";
+    }
+    return "unknown";
+}
+
+bool LoadGovernor::update(const std::vector<StageSample>& stages, Clock::time_point now) {
+    const double deadline_ms = 1000.0 / options_.target_fps;
+    double load = 0.0;
+    std::string bottleneck;
+    for (const auto& s : stages) {
+        // 与上一次的累计值相减，得到这段时间内的单帧耗时
+        auto prev = std::find_if(previous_.begin(), previous_.end(),
+                                 [&](const StageSample& p) { return p.name == s.name; });
+        const double busy = s.busy_ms - (prev != previous_.end() ? prev->busy_ms : 0.0);
+        const uint64_t processed = s.processed - (prev != previous_.end() ? prev->processed : 0);
+        if (processed == 0) continue;
+        // 多个工作线程时每帧的期限按线程数放宽
+        const double stage_load = busy / processed / (deadline_ms * std::max(1u, s.workers));
+        if (stage_load > load) {
+            load = stage_load;
+            bottleneck = s.name;
+        }
+    }
+    previous_ = stages;
+
+    const Level current = level();
+    if (started_) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.level_seconds[static_cast<int>(current)] +=
+            std::chrono::duration<double>(now - last_update_).count();
+        stats_.load = load;
+        stats_.bottleneck = bottleneck;
+    }
+    const bool first = !started_;
+    started_ = true;
+    last_update_ = now;
+    // 第一次调用只建立基线：累计值里包含启动阶段，不能代表当前负载
+    if (first || bottleneck.empty()) return false;
+
+    const bool over = load > options_.degrade_load;
+    const bool under = load < options_.recover_load;
+    if (over && !over_) over_since_ = now;
+    if (under && !under_) under_since_ = now;
+    over_ = over;
+    under_ = under;
+
+    const auto held = [&](Clock::time_point since, double seconds) {
+        return std::chrono::duration<double>(now - since).count() >= seconds;
+    };
+    const int index = static_cast<int>(current);
+    if (over_ && index < options_.max_level && held(over_since_, options_.degrade_seconds)) {
+        // 刚恢复就再次过载：说明恢复早了，下一次恢复前多等一倍时间
+        if (recovered_ && !held(last_recovery_, options_.recover_seconds * recover_backoff_)) {
+            recover_backoff_ = std::min(8.0, recover_backoff_ * 2);
+        } else {
+            recover_backoff_ = 1.0;
+        }
+        change_level(static_cast<Level>(index + 1), now);
+        return true;
+    }
+    if (under_ && index > 0 &&
+        held(under_since_, options_.recover_seconds * recover_backoff_)) {
+        change_level(static_cast<Level>(index - 1), now);
+        recovered_ = true;
+        last_recovery_ = now;
+        return true;
+    }
+    return false;
+}
+
+void LoadGovernor::change_level(Level level, Clock::time_point now) {
+    level_.store(level, std::memory_order_relaxed);
+    // 新级别下的负载要重新累计持续时间
+    over_ = under_ = false;
+    over_since_ = under_since_ = now;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.level = level;
+    ++stats_.transitions;
+}
+
+LoadGovernor::Stats LoadGovernor::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
@@ -0,0 +1,175 @@
+#include "pipeline/MetricsExporter.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+void MetricsText::declare(const std::string& name, const std::string& help, const char* type) {
+    if (!declared_.insert(name).second) return;
+    out_ += "# HELP " + name + " " + help + "\n";
+    out_ += "# TYPE " + name + " " + type + "\n";
+}
+
+void MetricsText::sample(const std::string& name, const std::string& labels, double value) {
+    char buf[64];
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(buf, sizeof(buf), "%.0f", value);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.6g", value);
+    }
+    out_ += name;
+    if (!labels.empty()) out_ += "{" + labels + "}";
+    out_ += " ";
+    out_ += buf;
+    out_ += "\n";
+}
+
+void MetricsText::counter(const std::string& name, const std::string& help, double value,
+                          const std::string& labels) {
+    declare(name, help, "counter");
+    sample(name, labels, value);
+}
+
+void MetricsText::gauge(const std::string& name, const std::string& help, double value,
+                        const std::string& labels) {
+    declare(name, help, "gauge");
+    sample(name, labels, value);
+}
+
+void MetricsText::summary(const std::string& name, const std::string& help,
+                          const LatencyWindow::Summary& s, const std::string& labels) {
+    declare(name, help, "summary");
+    const std::string sep = labels.empty() ? "" : labels + ",";
+    sample(name, sep + "quantile=\"0.5\"", s.p50);
+    sample(name, sep + "quantile=\"0.9\"", s.p90);
+    sample(name, sep + "quantile=\"0.99\"", s.p99);
+    sample(name + "_sum", labels, s.sum);
+    sample(name + "_count", labels, static_cast<double>(s.count));
+}
+
+MetricsExporter::MetricsExporter(Collector collector, Options options)
+    : collector_(std::move(collector)), options_(std::move(options)) {
+    if (options_.http_port > 0) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) throw std::runtime_error("[MetricsExporter] 创建 socket 失败");
+        const int reuse = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(options_.http_port));
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(listen_fd_, 8) < 0) {
+            const std::string err = std::strerror(errno);
+            close(listen_fd_);
+            throw std::runtime_error("[MetricsExporter] 无法监听 127.0.0.1:" +
+                                     std::to_string(options_.http_port) + ": " + err);
+        }
+        port_ = options_.http_port;
+    }
+    if (options_.interval_s <= 0) options_.interval_s = 5.0;
+    thread_ = std::thread([this] { run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    stopping_ = true;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) close(listen_fd_);
+    // 退出前写最后一次，保留结束时的计数
+    if (!options_.file_path.empty()) write_file();
+}
+
+std::string MetricsExporter::render() const {
+    MetricsText text;
+    collector_(text);
+    return text.str();
+}
+
+bool MetricsExporter::write_file() const {
+    const std::string tmp = options_.file_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[MetricsExporter] 无法写入 " << tmp << std::endl;
+            return false;
+        }
+        out << render();
+        if (!out) return false;
+    }
+    if (std::rename(tmp.c_str(), options_.file_path.c_str()) != 0) {
+        std::cerr << "[MetricsExporter] rename 失败: " << options_.file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options_.interval_s));
+    auto next_write = Clock::now();
+    while (!stopping_) {
+        if (!options_.file_path.empty() && Clock::now() >= next_write) {
+            write_file();
+            next_write += interval;
+        }
+        // 最多等 200ms，保证 stopping_ 及时生效
+        if (listen_fd_ < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) > 0 && (pfd.revents & POLLIN)) {
+            const int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                serve_client(client);
+                close(client);
+            }
+        }
+    }
+}
+
+void MetricsExporter::serve_client(int fd) const {
+    // 只需要请求行；客户端 1 秒内没发完就放弃
+    char request[2048];
+    size_t got = 0;
+    while (got < sizeof(request) - 1) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (poll(&pfd, 1, 1000) <= 0) return;
+        const ssize_t n = recv(fd, request + got, sizeof(request) - 1 - got, 0);
+        if (n <= 0) return;
+        got += static_cast<size_t>(n);
+        request[got] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) break;
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (std::strncmp(request, "GET /metrics", 12) == 0 || std::strncmp(request, "GET / ", 6) == 0) {
+        body = render();
+    } else {
+        status = "404 Not Found";
+        body = "not found\n";
+    }
+    const std::string response = "HTTP/1.0 " + status +
+                                 "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                 "Content-Length: " + std::to_string(body.size()) +
+                                 "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        const ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
@@ -0,0 +1,146 @@
+#include "pipeline/Tracer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+std::atomic<bool> Tracer::enabled_{false};
+
+namespace {
+thread_local std::string t_thread_name;
+
+// 事件名与线程名只含普通字符，这里只处理 JSON 必须转义的字符
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+}  // namespace
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::set_thread_name(const std::string& name) { t_thread_name = name; }
+
+void Tracer::enable(size_t events_per_thread) {
+    capacity_.store(std::max<size_t>(16, events_per_thread), std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer* Tracer::local_buffer() {
+    // 缓冲区归 Tracer 所有，线程退出后事件仍可导出
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        auto owned = std::make_unique<ThreadBuffer>();
+        // 多留一个槽位给正在写入的事件，导出时完整保留 capacity 条
+        owned->capacity = capacity_.load(std::memory_order_relaxed) + 1;
+        owned->slots = std::make_unique<Slot[]>(owned->capacity);
+        owned->thread_name = t_thread_name;
+        std::lock_guard<std::mutex> lock(mutex_);
+        owned->tid = static_cast<uint32_t>(buffers_.size() + 1);
+        buffer = owned.get();
+        buffers_.push_back(std::move(owned));
+    }
+    return buffer;
+}
+
+void Tracer::record(const char* name, uint64_t id, int64_t begin_ns, int64_t end_ns) {
+    ThreadBuffer* buffer = local_buffer();
+    const uint64_t h = buffer->head.load(std::memory_order_relaxed);
+    Slot& slot = buffer->slots[h % buffer->capacity];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    buffer->head.store(h + 1, std::memory_order_release);
+}
+
+std::vector<Tracer::Event> Tracer::snapshot() const {
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& buffer : buffers_) {
+        const uint64_t cap = buffer->capacity;
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t begin = head >= cap ? head - cap + 1 : 0;
+        const size_t first = events.size();
+        for (uint64_t i = begin; i < head; ++i) {
+            const Slot& slot = buffer->slots[i % cap];
+            Event e;
+            e.name = slot.name.load(std::memory_order_relaxed);
+            e.id = slot.id.load(std::memory_order_relaxed);
+            e.begin_ns = slot.begin_ns.load(std::memory_order_relaxed);
+            e.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+            e.tid = buffer->tid;
+            events.push_back(e);
+        }
+        // 读取期间写入的事件可能覆盖了最旧的槽位（包括正在写的下一个），丢弃这些
+        const uint64_t after = buffer->head.load(std::memory_order_acquire);
+        const uint64_t valid_from = after >= cap ? after - cap + 1 : 0;
+        if (valid_from > begin) {
+            const size_t skip = static_cast<size_t>(std::min(valid_from - begin, head - begin));
+            events.erase(events.begin() + first, events.begin() + first + skip);
+        }
+    }
+    return events;
+}
+
+bool Tracer::write_chrome_trace(const std::string& path) const {
+    std::vector<Event> events = snapshot();
+    std::vector<std::pair<uint32_t, std::string>> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& buffer : buffers_) threads.emplace_back(buffer->tid, buffer->thread_name);
+    }
+
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "[Tracer] 无法写入 " << path << std::endl;
+        return false;
+    }
+    int64_t origin = 0;
+    if (!events.empty()) {
+        origin = std::min_element(events.begin(), events.end(), [](const Event& a, const Event& b) {
+                     return a.begin_ns < b.begin_ns;
+                 })->begin_ns;
+    }
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& [tid, name] : threads) {
+        if (name.empty()) continue;
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+            << tid << ",\"args\":{\"name\":\"" << json_escape(name) << "\"}}";
+        first = false;
+    }
+    char buf[64];
+    for (const auto& e : events) {
+        // trace_event 的时间单位是微秒
+        out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"cat\":\"frame\",\"name\":\""
+            << json_escape(e.name ? e.name : "?") << "\",\"pid\":1,\"tid\":" << e.tid;
+        std::snprintf(buf, sizeof(buf), ",\"ts\":%.3f,\"dur\":%.3f", (e.begin_ns - origin) / 1e3,
+                      (e.end_ns - e.begin_ns) / 1e3);
+        out << buf << ",\"args\":{\"frame\":" << e.id << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_) buffer->head.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,193 @@
+#include "processor/EdgeKernel.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "processor/TileScheduler.hpp"
+
+namespace {
+// tan(22.5°) * 2^15，与 OpenCV Canny 的方向判定一致
+constexpr int kTan22 = 13573;
+}  // namespace
+
+EdgeKernel::EdgeKernel(int low_threshold, int high_threshold)
+    : low_(low_threshold), high_(high_threshold) {}
+
+void EdgeKernel::resize(int width, int height, size_t bands) {
+    const size_t w2 = static_cast<size_t>(width) + 2;
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        map_.assign(w2 * (static_cast<size_t>(height) + 2), 0);
+        bands_.clear();
+    }
+    while (bands_.size() < bands) {
+        BandScratch band;
+        band.luma_rows.assign(3 * w2, 0);
+        band.dx_rows.assign(3 * w2, 0);
+        band.dy_rows.assign(3 * w2, 0);
+        band.mag_rows.assign(3 * w2, 0);
+        bands_.push_back(std::move(band));
+    }
+}
+
+void EdgeKernel::load_luma_row(const uint8_t* src, int src_stride,
+                               int pixel_step, int row, uint8_t* out) const {
+    row = std::clamp(row, 0, height_ - 1);
+    const uint8_t* p = src + static_cast<size_t>(row) * src_stride;
+    if (pixel_step == 1) {
+        std::memcpy(out + 1, p, width_);
+    } else {
+        for (int x = 0; x < width_; ++x) out[x + 1] = p[x * pixel_step];
+    }
+    out[0] = out[1];
+    out[width_ + 1] = out[width_];
+}
+
+void EdgeKernel::sobel_row(BandScratch& band, int row) {
+    const size_t w2 = static_cast<size_t>(width_) + 2;
+    const uint8_t* up = &band.luma_rows[((row + 2) % 3) * w2];  // row - 1
+    const uint8_t* mid = &band.luma_rows[(row % 3) * w2];
+    const uint8_t* down = &band.luma_rows[((row + 1) % 3) * w2];
+    int16_t* dx = &band.dx_rows[(row % 3) * w2];
+    int16_t* dy = &band.dy_rows[(row % 3) * w2];
+    int* mag = &band.mag_rows[(row % 3) * w2];
+    for (int x = 1; x <= width_; ++x) {
+        int gx = (up[x + 1] + 2 * mid[x + 1] + down[x + 1]) -
+                 (up[x - 1] + 2 * mid[x - 1] + down[x - 1]);
+        int gy = (down[x - 1] + 2 * down[x] + down[x + 1]) -
+                 (up[x - 1] + 2 * up[x] + up[x + 1]);
+        dx[x] = static_cast<int16_t>(gx);
+        dy[x] = static_cast<int16_t>(gy);
+        mag[x] = std::abs(gx) + std::abs(gy);
+    }
+}
+
+void EdgeKernel::suppress_row(BandScratch& band, int row) {
+    const size_t w2 = static_cast<size_t>(width_) + 2;
+    // 图像外的幅值行视为 0
+    auto mag_at = [&](int r) -> const int* {
+        return (r < 0 || r >= height_) ? nullptr : &band.mag_rows[(r % 3) * w2];
+    };
+    const int* prev = mag_at(row - 1);
+    const int* cur = mag_at(row);
+    const int* next = mag_at(row + 1);
+    const int16_t* dx = &band.dx_rows[(row % 3) * w2];
+    const int16_t* dy = &band.dy_rows[(row % 3) * w2];
+    uint8_t* map = &map_[static_cast<size_t>(row + 1) * w2];
+
+    for (int x = 1; x <= width_; ++x) {
+        const int m = cur[x];
+        uint8_t state = 0;
+        if (m > low_) {
+            const int ax = std::abs(dx[x]);
+            const int ay = std::abs(dy[x]) << 15;
+            const int tg22x = ax * kTan22;
+            bool is_max;
+            if (ay < tg22x) {
+                // 水平方向梯度：与左右比较
+                is_max = m > cur[x - 1] && m >= cur[x + 1];
+            } else {
+                const int tg67x = tg22x + (ax << 16);
+                const int up_center = prev ? prev[x] : 0;
+                const int down_center = next ? next[x] : 0;
+                if (ay > tg67x) {
+                    // 垂直方向梯度：与上下比较
+                    is_max = m > up_center && m >= down_center;
+                } else {
+                    // 对角方向
+                    const int s = (dx[x] ^ dy[x]) < 0 ? -1 : 1;
+                    const int a = prev ? prev[x - s] : 0;
+                    const int b = next ? next[x + s] : 0;
+                    is_max = m > a && m > b;
+                }
+            }
+            if (is_max) {
+                state = m > high_ ? 2 : 1;
+                if (state == 2) band.strong.push_back(&map[x]);
+            }
+        }
+        map[x] = state;
+    }
+}
+
+void EdgeKernel::sweep_band(BandScratch& band, const uint8_t* src, int src_stride,
+                            int pixel_step, int row_begin, int row_end) {
+    const size_t w2 = static_cast<size_t>(width_) + 2;
+    // 从 row_begin 的上一行开始算 Sobel（即 halo），非极大值抑制落后 Sobel 一行，
+    // 环形缓存中始终保留 row - 1、row、row + 1 三行
+    const int first = std::max(row_begin - 1, 0);
+    const int last = std::min(row_end, height_ - 1);
+    load_luma_row(src, src_stride, pixel_step, first - 1,
+                  &band.luma_rows[((first + 2) % 3) * w2]);
+    load_luma_row(src, src_stride, pixel_step, first,
+                  &band.luma_rows[(first % 3) * w2]);
+    for (int row = first; row <= last; ++row) {
+        load_luma_row(src, src_stride, pixel_step, row + 1,
+                      &band.luma_rows[((row + 1) % 3) * w2]);
+        sobel_row(band, row);
+        if (row - 1 >= row_begin) suppress_row(band, row - 1);
+    }
+    if (row_end == height_) suppress_row(band, height_ - 1);
+}
+
+void EdgeKernel::hysteresis() {
+    const ptrdiff_t step = static_cast<ptrdiff_t>(width_) + 2;
+    const ptrdiff_t offsets[8] = {-step - 1, -step, -step + 1, -1,
+                                  1,         step - 1, step,  step + 1};
+    stack_.clear();
+    for (auto& band : bands_) {
+        stack_.insert(stack_.end(), band.strong.begin(), band.strong.end());
+        band.strong.clear();
+    }
+    // 连通结果与遍历顺序无关，所以分块与整帧执行结果一致
+    while (!stack_.empty()) {
+        uint8_t* p = stack_.back();
+        stack_.pop_back();
+        for (ptrdiff_t off : offsets) {
+            if (p[off] == 1) {
+                p[off] = 2;
+                stack_.push_back(p + off);
+            }
+        }
+    }
+}
+
+void EdgeKernel::write_rows(uint8_t* dst, int dst_stride, int row_begin,
+                            int row_end) const {
+    const size_t w2 = static_cast<size_t>(width_) + 2;
+    for (int row = row_begin; row < row_end; ++row) {
+        const uint8_t* map = &map_[static_cast<size_t>(row + 1) * w2 + 1];
+        uint8_t* out = dst + static_cast<size_t>(row) * dst_stride;
+        for (int x = 0; x < width_; ++x) out[x] = map[x] == 2 ? 255 : 0;
+    }
+}
+
+void EdgeKernel::detect(const uint8_t* src, int src_stride, int pixel_step,
+                        int width, int height, uint8_t* dst, int dst_stride,
+                        TileScheduler* scheduler) {
+    if (width <= 0 || height <= 0) return;
+    if (!scheduler || scheduler->thread_count() == 1) {
+        resize(width, height, 1);
+        sweep_band(bands_[0], src, src_stride, pixel_step, 0, height);
+        hysteresis();
+        // 所有读取都已完成，dst 可以与 src 共用同一块 Y 平面
+        write_rows(dst, dst_stride, 0, height);
+        return;
+    }
+
+    const int tiles = std::min<int>(scheduler->thread_count(), height);
+    resize(width, height, tiles);
+    // 1) 各条带独立扫描，只写自己的 map_ 行；halo 行由条带内部重新计算
+    scheduler->run(height, kHaloRows, [&](const TileScheduler::Tile& tile) {
+        sweep_band(bands_[tile.index], src, src_stride, pixel_step,
+                   tile.row_begin, tile.row_end);
+    }, tiles);
+    // 2) 滞后连接会跨越条带边界，串行完成
+    hysteresis();
+    // 3) 输出：所有条带都已读完输入，dst 可以与 src 共用同一块内存
+    scheduler->run(height, 0, [&](const TileScheduler::Tile& tile) {
+        write_rows(dst, dst_stride, tile.row_begin, tile.row_end);
+    }, tiles);
+}
@@ -0,0 +1,196 @@
+#include "processor/FilterChain.hpp"
+
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace {
+
+std::mutex& registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// 内置链在第一次访问注册表时登记
+std::map<std::string, FilterChain::Factory>& registry() {
+    static std::map<std::string, FilterChain::Factory> chains = [] {
+        std::map<std::string, FilterChain::Factory> m;
+        m["none"] = [] { return std::make_unique<FilterChain>(); };
+        m["canny"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(std::make_unique<EdgeStage>());
+            return chain;
+        };
+        m["denoise-edges"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(std::make_unique<GaussianStage>())
+                .then(std::make_unique<EdgeStage>(50, 150));
+            return chain;
+        };
+        m["edge-overlay"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(std::make_unique<GaussianStage>())
+                .then(std::make_unique<EdgeOverlayStage>());
+            return chain;
+        };
+        m["threshold"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(std::make_unique<GaussianStage>())
+                .then(fuse(Contrast(1.2f, -10), Threshold(128)));
+            return chain;
+        };
+        m["posterize"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(fuse(Contrast(1.2f, -10), Posterize(4)));
+            return chain;
+        };
+        m["heatmap"] = [] {
+            auto chain = std::make_unique<FilterChain>();
+            chain->then(std::make_unique<GaussianStage>())
+                .then(fuse(Gamma(0.8f), Contrast(1.3f, -20)))
+                .set_color_map(ColorMap::heat());
+            return chain;
+        };
+        return m;
+    }();
+    return chains;
+}
+
+}  // namespace
+
+void GaussianStage::blur_rows(const LumaPlane& plane, int row_begin, int row_end) {
+    const int w = plane.width;
+    // 垂直方向累加结果，左右各留 1 个复制边界
+    thread_local std::vector<int> column;
+    column.resize(static_cast<size_t>(w) + 2);
+    for (int r = row_begin; r < row_end; ++r) {
+        const uint8_t* up = plane.row(std::max(r - 1, 0));
+        const uint8_t* mid = plane.row(r);
+        const uint8_t* down = plane.row(std::min(r + 1, plane.height - 1));
+        for (int x = 0; x < w; ++x) column[x + 1] = up[x] + 2 * mid[x] + down[x];
+        column[0] = column[1];
+        column[w + 1] = column[w];
+        uint8_t* out = &scratch_[static_cast<size_t>(r) * w];
+        for (int x = 0; x < w; ++x) {
+            out[x] = static_cast<uint8_t>(
+                (column[x] + 2 * column[x + 1] + column[x + 2] + 8) >> 4);
+        }
+    }
+}
+
+void GaussianStage::apply(const LumaPlane& plane, TileScheduler* scheduler) {
+    scratch_.resize(static_cast<size_t>(plane.width) * plane.height);
+    if (scheduler) {
+        scheduler->run(plane.height, 1, [&](const TileScheduler::Tile& tile) {
+            blur_rows(plane, tile.row_begin, tile.row_end);
+        });
+    } else {
+        blur_rows(plane, 0, plane.height);
+    }
+    for (int r = 0; r < plane.height; ++r) {
+        std::memcpy(plane.row(r), &scratch_[static_cast<size_t>(r) * plane.width],
+                    plane.width);
+    }
+}
+
+void EdgeStage::apply(const LumaPlane& plane, TileScheduler* scheduler) {
+    kernel_.detect(plane.data, plane.stride, 1, plane.width, plane.height,
+                   plane.data, plane.stride, scheduler);
+}
+
+void EdgeOverlayStage::apply(const LumaPlane& plane, TileScheduler* scheduler) {
+    const int w = plane.width;
+    edges_.resize(static_cast<size_t>(w) * plane.height);
+    kernel_.detect(plane.data, plane.stride, 1, w, plane.height, edges_.data(), w,
+                   scheduler);
+    for (int r = 0; r < plane.height; ++r) {
+        uint8_t* p = plane.row(r);
+        const uint8_t* e = &edges_[static_cast<size_t>(r) * w];
+        for (int x = 0; x < w; ++x) {
+            p[x] = e[x] ? 255 : static_cast<uint8_t>((p[x] * dim_q8_ + 128) >> 8);
+        }
+    }
+}
+
+ColorMap ColorMap::gray() {
+    ColorMap map;
+    for (int i = 0; i < 256; ++i) {
+        const auto v = static_cast<uint8_t>(i);
+        map.rgb[i] = {v, v, v};
+    }
+    return map;
+}
+
+ColorMap ColorMap::heat() {
+    ColorMap map;
+    for (int i = 0; i < 256; ++i) {
+        // 三段线性插值：R 先饱和，然后 G，最后 B
+        const int r = std::min(255, i * 3);
+        const int g = std::clamp((i - 85) * 3, 0, 255);
+        const int b = std::clamp((i - 170) * 3, 0, 255);
+        map.rgb[i] = {static_cast<uint8_t>(r), static_cast<uint8_t>(g),
+                      static_cast<uint8_t>(b)};
+    }
+    return map;
+}
+
+FilterChain& FilterChain::then(std::unique_ptr<FilterStage> stage) {
+    if (stage) stages_.push_back(std::move(stage));
+    return *this;
+}
+
+FilterChain& FilterChain::set_color_map(const ColorMap& map) {
+    color_map_ = std::make_unique<ColorMap>(map);
+    return *this;
+}
+
+void FilterChain::apply(const LumaPlane& plane, TileScheduler* scheduler) {
+    if (!plane.data || plane.width <= 0 || plane.height <= 0) return;
+    for (auto& stage : stages_) stage->apply(plane, scheduler);
+}
+
+void FilterChain::expand_rgb(const LumaPlane& plane, uint8_t* rgb,
+                             int rgb_stride) const {
+    for (int r = 0; r < plane.height; ++r) {
+        const uint8_t* src = plane.row(r);
+        uint8_t* dst = rgb + static_cast<size_t>(r) * rgb_stride;
+        if (color_map_) {
+            for (int x = 0; x < plane.width; ++x) {
+                std::memcpy(dst + x * 3, color_map_->rgb[src[x]].data(), 3);
+            }
+        } else {
+            for (int x = 0; x < plane.width; ++x) {
+                dst[x * 3] = dst[x * 3 + 1] = dst[x * 3 + 2] = src[x];
+            }
+        }
+    }
+}
+
+std::string FilterChain::describe() const {
+    std::string s;
+    for (const auto& stage : stages_) {
+        if (!s.empty()) s += " -> ";
+        s += stage->describe();
+    }
+    if (color_map_) s += s.empty() ? "colormap" : " -> colormap";
+    return s.empty() ? "passthrough" : s;
+}
+
+std::unique_ptr<FilterChain> FilterChain::create(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    auto it = registry().find(name);
+    if (it == registry().end()) return nullptr;
+    return it->second();
+}
+
+void FilterChain::register_chain(const std::string& name, Factory factory) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry()[name] = std::move(factory);
+}
+
+std::vector<std::string> FilterChain::names() {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    std::vector<std::string> result;
+    for (const auto& [name, factory] : registry()) result.push_back(name);
+    return result;
+}
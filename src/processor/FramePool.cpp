@@ -0,0 +1,115 @@
+#include "processor/FramePool.hpp"
+
+#include <opencv2/core.hpp>
+
+FramePool::FramePool(size_t max_cached_per_size)
+    : max_cached_per_size_(max_cached_per_size) {}
+
+FramePool::~FramePool() {
+    trim();
+}
+
+FramePool& FramePool::shared() {
+    // 故意不析构：静态对象析构顺序不确定，可能晚于仍持有池内存的全局 Mat
+    static FramePool* pool = new FramePool();
+    return *pool;
+}
+
+cv::Mat FramePool::acquire(int rows, int cols, int type) {
+    cv::Mat mat;
+    mat.allocator = this;
+    mat.create(rows, cols, type);
+    return mat;
+}
+
+FramePool::Stats FramePool::stats() const {
+    Stats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.outstanding = outstanding_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mtx_);
+    s.cached_bytes = cached_bytes_;
+    return s;
+}
+
+void FramePool::trim() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& [size, blocks] : free_blocks_) {
+        for (void* block : blocks) cv::fastFree(block);
+    }
+    free_blocks_.clear();
+    cached_bytes_ = 0;
+}
+
+// 步长计算与 OpenCV 默认的 StdMatAllocator 保持一致
+cv::UMatData* FramePool::allocate(int dims, const int* sizes, int type,
+                                  void* data0, size_t* step,
+                                  cv::AccessFlag /*flags*/,
+                                  cv::UMatUsageFlags /*usageFlags*/) const {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = static_cast<uchar*>(data0);
+    if (!data) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = free_blocks_.find(total);
+            if (it != free_blocks_.end() && !it->second.empty()) {
+                data = static_cast<uchar*>(it->second.back());
+                it->second.pop_back();
+                cached_bytes_ -= total;
+            }
+        }
+        if (data) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // fastMalloc 保证 64 字节对齐，满足 SIMD 访问
+            data = static_cast<uchar*>(cv::fastMalloc(total));
+            misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) u->flags |= cv::UMatData::USER_ALLOCATED;
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData* u, cv::AccessFlag /*accessflags*/,
+                         cv::UMatUsageFlags /*usageFlags*/) const {
+    return u != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData* u) const {
+    if (!u) return;
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        outstanding_.fetch_sub(1, std::memory_order_relaxed);
+        bool cached = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto& blocks = free_blocks_[u->size];
+            if (blocks.size() < max_cached_per_size_) {
+                blocks.push_back(u->origdata);
+                cached_bytes_ += u->size;
+                cached = true;
+            }
+        }
+        if (!cached) cv::fastFree(u->origdata);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
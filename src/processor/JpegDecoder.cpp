@@ -0,0 +1,271 @@
+#include "processor/JpegDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifdef VISION_HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+
+// 把 cw x ch 的色度平面按 rx x ry 的块平均到 4:2:0 平面（rx, ry ∈ {1, 2}）
+[[maybe_unused]] void resample_chroma(const uint8_t* src, int src_stride, int cw, int ch, int rx,
+                     int ry, uint8_t* dst, int dst_stride, int out_w, int out_h) {
+    for (int y = 0; y < out_h; ++y) {
+        const uint8_t* r0 = src + static_cast<size_t>(std::min(y * ry, ch - 1)) * src_stride;
+        const uint8_t* r1 = src + static_cast<size_t>(std::min(y * ry + ry - 1, ch - 1)) * src_stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+        for (int x = 0; x < out_w; ++x) {
+            const int x0 = std::min(x * rx, cw - 1);
+            const int x1 = std::min(x * rx + rx - 1, cw - 1);
+            if (rx == 1) {
+                // 与 YuvConvert 的 YUYV 路径一致：(a + b + 1) >> 1
+                out[x] = static_cast<uint8_t>((r0[x0] + r1[x0] + 1) >> 1);
+            } else {
+                out[x] = static_cast<uint8_t>((r0[x0] + r0[x1] + r1[x0] + r1[x1] + 2) >> 2);
+            }
+        }
+    }
+}
+
+#ifndef VISION_HAVE_TURBOJPEG
+int imread_flags(JpegDecoder::Scale scale, bool gray) {
+    switch (scale) {
+        case JpegDecoder::Scale::Half:
+            return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        case JpegDecoder::Scale::Quarter:
+            return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        case JpegDecoder::Scale::Eighth:
+            return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+        default:
+            return gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    }
+}
+#endif
+
+}  // namespace
+
+bool JpegDecoder::parse_sof(const uint8_t* data, size_t size, int& width, int& height) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return false;
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) return false;
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {  // 填充字节
+            ++pos;
+            continue;
+        }
+        const size_t length = (data[pos + 2] << 8) | data[pos + 3];
+        // SOF0..SOF15，排除 DHT(C4)、JPG(C8)、DAC(CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+            marker != 0xCC) {
+            if (pos + 9 > size) return false;
+            height = (data[pos + 5] << 8) | data[pos + 6];
+            width = (data[pos + 7] << 8) | data[pos + 8];
+            return width > 0 && height > 0;
+        }
+        if (marker == 0xDA) return false;  // 图像数据开始前没有 SOF
+        pos += 2 + length;
+    }
+    return false;
+}
+
+#ifdef VISION_HAVE_TURBOJPEG
+
+JpegDecoder::JpegDecoder() : handle_(tjInitDecompress()) {
+    if (!handle_) {
+        throw std::runtime_error(std::string("tjInitDecompress 失败: ") +
+                                 tjGetErrorStr2(nullptr));
+    }
+}
+
+JpegDecoder::~JpegDecoder() {
+    if (handle_) tjDestroy(handle_);
+}
+
+bool JpegDecoder::uses_turbojpeg() { return true; }
+
+bool JpegDecoder::read_header(const uint8_t* data, size_t size, int& width,
+                              int& height) {
+    int subsamp = 0, colorspace = 0;
+    if (!data || tjDecompressHeader3(handle_, data, static_cast<unsigned long>(size),
+                                     &width, &height, &subsamp, &colorspace) != 0) {
+        std::cerr << "[JpegDecoder] 文件头解析失败: " << tjGetErrorStr2(handle_) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JpegDecoder::decode_rgb(const uint8_t* data, size_t size, cv::Mat& rgb,
+                             Scale scale) {
+    int width = 0, height = 0;
+    if (!read_header(data, size, width, height)) return false;
+    const int w = scaled(width, scale), h = scaled(height, scale);
+    rgb.create(h, w, CV_8UC3);
+    // 传入缩放后的尺寸，TurboJPEG 会选择对应的 DCT 缩放因子
+    if (tjDecompress2(handle_, data, static_cast<unsigned long>(size), rgb.data, w,
+                      static_cast<int>(rgb.step), h, TJPF_RGB,
+                      fast_dct_ ? TJFLAG_FASTDCT : 0) != 0) {
+        std::cerr << "[JpegDecoder] 解码失败: " << tjGetErrorStr2(handle_) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JpegDecoder::decode_gray(const uint8_t* data, size_t size, cv::Mat& gray,
+                              Scale scale) {
+    int width = 0, height = 0;
+    if (!read_header(data, size, width, height)) return false;
+    const int w = scaled(width, scale), h = scaled(height, scale);
+    gray.create(h, w, CV_8UC1);
+    if (tjDecompress2(handle_, data, static_cast<unsigned long>(size), gray.data, w,
+                      static_cast<int>(gray.step), h, TJPF_GRAY,
+                      fast_dct_ ? TJFLAG_FASTDCT : 0) != 0) {
+        std::cerr << "[JpegDecoder] 解码失败: " << tjGetErrorStr2(handle_) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JpegDecoder::decode_yuv420p(const uint8_t* data, size_t size,
+                                 const Yuv420pPlanes& planes, int width, int height) {
+    int jw = 0, jh = 0, subsamp = 0, colorspace = 0;
+    if (!data || tjDecompressHeader3(handle_, data, static_cast<unsigned long>(size),
+                                     &jw, &jh, &subsamp, &colorspace) != 0) {
+        std::cerr << "[JpegDecoder] 文件头解析失败: " << tjGetErrorStr2(handle_) << std::endl;
+        return false;
+    }
+    if (jw != width || jh != height) {
+        std::cerr << "[JpegDecoder] 尺寸不匹配: JPEG " << jw << "x" << jh << "，期望 "
+                  << width << "x" << height << std::endl;
+        return false;
+    }
+    const int flags = fast_dct_ ? TJFLAG_FASTDCT : 0;
+    // 与 AVFrame 的 YUV420P 布局一致，奇数尺寸时色度向上取整
+    const int out_cw = (width + 1) / 2, out_ch = (height + 1) / 2;
+
+    if (subsamp == TJSAMP_420) {
+        // 与编码器格式一致，直接写入目标平面
+        unsigned char* dst[3] = {planes.y, planes.u, planes.v};
+        int strides[3] = {planes.y_stride, planes.u_stride, planes.v_stride};
+        if (tjDecompressToYUVPlanes(handle_, data, static_cast<unsigned long>(size), dst,
+                                    width, strides, height, flags) != 0) {
+            std::cerr << "[JpegDecoder] 解码失败: " << tjGetErrorStr2(handle_) << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (subsamp == TJSAMP_GRAY) {
+        unsigned char* dst[3] = {planes.y, nullptr, nullptr};
+        int strides[3] = {planes.y_stride, 0, 0};
+        if (tjDecompressToYUVPlanes(handle_, data, static_cast<unsigned long>(size), dst,
+                                    width, strides, height, flags) != 0) {
+            std::cerr << "[JpegDecoder] 解码失败: " << tjGetErrorStr2(handle_) << std::endl;
+            return false;
+        }
+        for (int y = 0; y < out_ch; ++y) {
+            std::memset(planes.u + static_cast<size_t>(y) * planes.u_stride, 128, out_cw);
+            std::memset(planes.v + static_cast<size_t>(y) * planes.v_stride, 128, out_cw);
+        }
+        return true;
+    }
+
+    // 其余采样方式：亮度直接写入，色度先解码到临时平面再重采样
+    const int cw = tjPlaneWidth(1, width, subsamp);
+    const int ch = tjPlaneHeight(1, height, subsamp);
+    // 色度为全分辨率时按 2 个样本平均，半分辨率时直接对应。
+    // 奇数尺寸下半分辨率色度向上取整（例如 4:2:2 宽 641 时 cw == 321），只能按是否
+    // 达到亮度尺寸判断，不能用 cw * 2 > width
+    const int rx = cw >= width ? 2 : 1;
+    const int ry = ch >= height ? 2 : 1;
+    if (cw * 2 < width || ch * 2 < height) {  // 例如 4:1:1
+        std::cerr << "[JpegDecoder] 不支持的色度采样方式: " << subsamp << std::endl;
+        return false;
+    }
+    chroma_scratch_.resize(static_cast<size_t>(cw) * ch * 2);
+    unsigned char* dst[3] = {planes.y, chroma_scratch_.data(),
+                             chroma_scratch_.data() + static_cast<size_t>(cw) * ch};
+    int strides[3] = {planes.y_stride, cw, cw};
+    if (tjDecompressToYUVPlanes(handle_, data, static_cast<unsigned long>(size), dst,
+                                width, strides, height, flags) != 0) {
+        std::cerr << "[JpegDecoder] 解码失败: " << tjGetErrorStr2(handle_) << std::endl;
+        return false;
+    }
+    resample_chroma(dst[1], cw, cw, ch, rx, ry, planes.u, planes.u_stride, out_cw, out_ch);
+    resample_chroma(dst[2], cw, cw, ch, rx, ry, planes.v, planes.v_stride, out_cw, out_ch);
+    return true;
+}
+
+#else  // 没有 TurboJPEG：cv::imdecode 回退实现
+
+JpegDecoder::JpegDecoder() = default;
+JpegDecoder::~JpegDecoder() = default;
+
+bool JpegDecoder::uses_turbojpeg() { return false; }
+
+bool JpegDecoder::read_header(const uint8_t* data, size_t size, int& width,
+                              int& height) {
+    if (!data || !parse_sof(data, size, width, height)) {
+        std::cerr << "[JpegDecoder] 文件头解析失败" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JpegDecoder::decode_rgb(const uint8_t* data, size_t size, cv::Mat& rgb,
+                             Scale scale) {
+    if (!data || size == 0) return false;
+    cv::Mat raw(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    cv::imdecode(raw, imread_flags(scale, false), &bgr_);
+    if (bgr_.empty()) {
+        std::cerr << "[JpegDecoder] 解码失败" << std::endl;
+        return false;
+    }
+    cv::cvtColor(bgr_, rgb, cv::COLOR_BGR2RGB);
+    return true;
+}
+
+bool JpegDecoder::decode_gray(const uint8_t* data, size_t size, cv::Mat& gray,
+                              Scale scale) {
+    if (!data || size == 0) return false;
+    cv::Mat raw(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    cv::imdecode(raw, imread_flags(scale, true), &gray);
+    if (gray.empty()) {
+        std::cerr << "[JpegDecoder] 解码失败" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JpegDecoder::decode_yuv420p(const uint8_t* data, size_t size,
+                                 const Yuv420pPlanes& planes, int width, int height) {
+    if (!data || size == 0) return false;
+    cv::Mat raw(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    cv::imdecode(raw, cv::IMREAD_COLOR, &bgr_);
+    if (bgr_.cols != width || bgr_.rows != height || (width | height) & 1) {
+        std::cerr << "[JpegDecoder] 解码失败或尺寸不匹配" << std::endl;
+        return false;
+    }
+    // I420 输出为连续的 Y、U、V 三段
+    cv::cvtColor(bgr_, i420_, cv::COLOR_BGR2YUV_I420);
+    const uint8_t* y = i420_.data;
+    const uint8_t* u = y + static_cast<size_t>(width) * height;
+    const uint8_t* v = u + static_cast<size_t>(width / 2) * (height / 2);
+    for (int r = 0; r < height; ++r) {
+        std::memcpy(planes.y + static_cast<size_t>(r) * planes.y_stride,
+                    y + static_cast<size_t>(r) * width, width);
+    }
+    for (int r = 0; r < height / 2; ++r) {
+        std::memcpy(planes.u + static_cast<size_t>(r) * planes.u_stride,
+                    u + static_cast<size_t>(r) * (width / 2), width / 2);
+        std::memcpy(planes.v + static_cast<size_t>(r) * planes.v_stride,
+                    v + static_cast<size_t>(r) * (width / 2), width / 2);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "processor/MotionGate.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+bool parse_motion_regions(const std::string& text, std::vector<MotionRegion>& regions) {
+    std::vector<MotionRegion> parsed;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ';')) {
+        if (item.empty()) continue;
+        MotionRegion r;
+        char c1 = 0, c2 = 0, c3 = 0;
+        std::istringstream fields(item);
+        if (!(fields >> r.x >> c1 >> r.y >> c2 >> r.width >> c3 >> r.height) || c1 != ',' ||
+            c2 != ',' || c3 != ',' || r.width <= 0 || r.height <= 0) {
+            return false;
+        }
+        parsed.push_back(r);
+    }
+    regions = std::move(parsed);
+    return true;
+}
+
+MotionGate::MotionGate(unsigned width, unsigned height, Options options)
+    : width_(width), height_(height), options_(options) {
+    options_.cell = std::max(1, options_.cell);
+    options_.row_step = std::max(1, options_.row_step);
+    thumb_w_ = std::max(1, (static_cast<int>(width_) + options_.cell - 1) / options_.cell);
+    thumb_h_ = std::max(1, (static_cast<int>(height_) + options_.cell - 1) / options_.cell);
+    const size_t blocks = static_cast<size_t>(thumb_w_) * thumb_h_;
+    sums_.resize(blocks);
+    current_.resize(blocks);
+    reference_.resize(blocks);
+    rebuild_mask();
+}
+
+void MotionGate::set_regions(const std::vector<MotionRegion>& regions) {
+    regions_ = regions;
+    rebuild_mask();
+}
+
+void MotionGate::set_ignore_regions(const std::vector<MotionRegion>& regions) {
+    ignore_ = regions;
+    rebuild_mask();
+}
+
+void MotionGate::rebuild_mask() {
+    // 以块中心点落在哪些区域内为准
+    auto contains = [](const MotionRegion& r, int x, int y) {
+        return x >= r.x && x < r.x + r.width && y >= r.y && y < r.y + r.height;
+    };
+    mask_.assign(static_cast<size_t>(thumb_w_) * thumb_h_, 0);
+    watched_ = 0;
+    for (int by = 0; by < thumb_h_; ++by) {
+        const int cy = std::min<int>(by * options_.cell + options_.cell / 2, height_ - 1);
+        for (int bx = 0; bx < thumb_w_; ++bx) {
+            const int cx = std::min<int>(bx * options_.cell + options_.cell / 2, width_ - 1);
+            bool watched = regions_.empty();
+            for (const auto& r : regions_) watched = watched || contains(r, cx, cy);
+            for (const auto& r : ignore_) watched = watched && !contains(r, cx, cy);
+            mask_[static_cast<size_t>(by) * thumb_w_ + bx] = watched;
+            watched_ += watched;
+        }
+    }
+}
+
+void MotionGate::prepare(int width, int height) {
+    if (width == input_w_ && height == input_h_) return;
+    input_w_ = width;
+    input_h_ = height;
+    col_begin_.resize(thumb_w_ + 1);
+    for (int bx = 0; bx <= thumb_w_; ++bx) {
+        col_begin_[bx] = static_cast<int>(static_cast<int64_t>(bx) * width / thumb_w_);
+    }
+    row_block_.resize(height);
+    for (int y = 0; y < height; ++y) {
+        row_block_[y] = static_cast<int>(static_cast<int64_t>(y) * thumb_h_ / height);
+    }
+    counts_.assign(static_cast<size_t>(thumb_w_) * thumb_h_, 0);
+    for (int y = 0; y < height; y += options_.row_step) {
+        for (int bx = 0; bx < thumb_w_; ++bx) {
+            counts_[static_cast<size_t>(row_block_[y]) * thumb_w_ + bx] +=
+                col_begin_[bx + 1] - col_begin_[bx];
+        }
+    }
+    // 参考缩略图与输入尺寸无关（都是块均值），不需要丢弃
+}
+
+MotionGate::Decision MotionGate::analyze(const uint8_t* luma, int stride, int step, int width,
+                                         int height) {
+    const auto start = std::chrono::steady_clock::now();
+    Decision decision;
+    if (!luma || width <= 0 || height <= 0) return decision;  // 无法判断时当作变化
+    if (reference_invalid_.exchange(false, std::memory_order_acq_rel)) has_reference_ = false;
+    prepare(width, height);
+
+    std::fill(sums_.begin(), sums_.end(), 0);
+    for (int y = 0; y < height; y += options_.row_step) {
+        const uint8_t* row = luma + static_cast<size_t>(y) * stride;
+        uint32_t* sums = sums_.data() + static_cast<size_t>(row_block_[y]) * thumb_w_;
+        for (int bx = 0; bx < thumb_w_; ++bx) {
+            uint32_t sum = 0;
+            for (int x = col_begin_[bx]; x < col_begin_[bx + 1]; ++x) sum += row[x * step];
+            sums[bx] += sum;
+        }
+    }
+    size_t changed_blocks = 0;
+    for (size_t i = 0; i < sums_.size(); ++i) {
+        current_[i] = static_cast<uint16_t>(counts_[i] ? sums_[i] / counts_[i] : 0);
+        if (mask_[i] && std::abs(current_[i] - reference_[i]) > options_.threshold) {
+            ++changed_blocks;
+        }
+    }
+
+    decision.changed_fraction = watched_ ? static_cast<double>(changed_blocks) / watched_ : 0.0;
+    decision.changed = !has_reference_ ||
+                       (changed_blocks > 0 && decision.changed_fraction > options_.min_changed);
+    if (!decision.changed && options_.refresh_frames && ++static_run_ >= options_.refresh_frames) {
+        decision.changed = decision.refresh = true;
+        refreshes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (decision.changed) {
+        // 只在真正处理的帧上更新参考，缓慢变化也会累积到阈值
+        reference_.swap(current_);
+        has_reference_ = true;
+        static_run_ = 0;
+    } else {
+        static_frames_.fetch_add(1, std::memory_order_relaxed);
+    }
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    detect_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start).count(),
+                         std::memory_order_relaxed);
+    return decision;
+}
+
+MotionGate::Stats MotionGate::stats() const {
+    Stats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.static_frames = static_frames_.load(std::memory_order_relaxed);
+    s.refreshes = refreshes_.load(std::memory_order_relaxed);
+    const uint64_t processed = s.frames - s.static_frames;
+    const double detect_ms = detect_ns_.load(std::memory_order_relaxed) / 1e6;
+    if (s.frames) s.detect_ms_avg = detect_ms / s.frames;
+    if (processed) s.process_ms_avg = process_ns_.load(std::memory_order_relaxed) / 1e6 / processed;
+    s.cpu_saved_ms = s.static_frames * s.process_ms_avg - detect_ms -
+                     overhead_ns_.load(std::memory_order_relaxed) / 1e6;
+    return s;
+}
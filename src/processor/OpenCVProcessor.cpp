@@ -17,34 +17,34 @@ OpenCVProcessor::OpenCVProcessor(PixelFormat fmt, unsigned width,
 
 bool OpenCVProcessor::Decode2RGB(const std::vector<uint8_t>& raw_data,
                                  cv::Mat& RGBFrame) {
-    if (raw_data.empty()) {
+    return Decode2RGB(raw_data.data(), raw_data.size(), RGBFrame);
+}
+
+bool OpenCVProcessor::Decode2RGB(const uint8_t* data, size_t size,
+                                 cv::Mat& RGBFrame) {
+    if (!data || size == 0) {
         std::cerr << "接收到的数据为空! " << std::endl;
         return false;
     }
-    cv::Mat frame;
     if (pixel_format_ == PixelFormat::MJPEG) {
-        // MJPEG 解码（BGR 格式）
-        cv::Mat raw_mat(1, static_cast<int>(raw_data.size()), CV_8UC1,
-                        const_cast<uint8_t*>(raw_data.data()));
-        frame = cv::imdecode(raw_mat, cv::IMREAD_COLOR);
-        if (frame.empty()) {
+        // TurboJPEG 直接解码为 RGB，不经过中间的 BGR Mat；
+        // 设置了 DCT 缩放时输出为缩小后的尺寸
+        if (!jpeg_decoder_.decode_rgb(data, size, RGBFrame, decode_scale_)) {
             std::cerr << "MJPEG 解码失败! " << std::endl;
             return false;
         }
-        // BGR → RGB 转换
-        cv::cvtColor(frame, RGBFrame, cv::COLOR_BGR2RGB);
     } else if (pixel_format_ == PixelFormat::YUYV) {
         // 验证 YUYV 数据大小
         size_t expected_size = width_ * height_ * 2;
-        if (raw_data.size() != expected_size) {
+        if (size != expected_size) {
             throw std::runtime_error(
                 "YUYV 数据大小错误: 期望 " + std::to_string(expected_size) +
-                " 字节，实际 " + std::to_string(raw_data.size()));
+                " 字节，实际 " + std::to_string(size));
             return false;
         }
         // YUYV → BGR
-        // 创建 YUYV Mat 对象
-        cv::Mat yuyv_frame(height_, width_, CV_8UC2, (void*)raw_data.data());
+        // 创建 YUYV Mat 对象（只是数据头，直接引用驱动/租约中的内存）
+        cv::Mat yuyv_frame(height_, width_, CV_8UC2, const_cast<uint8_t*>(data));
         if (yuyv_frame.empty()) {
             throw std::runtime_error("YUYV 帧数据为空");
             return false;
@@ -56,12 +56,13 @@ bool OpenCVProcessor::Decode2RGB(const std::vector<uint8_t>& raw_data,
 
 std::string OpenCVProcessor::process_and_save(const std::string& output_dir,
                                               cv::Mat& RGBFrame) {
-    // 确保输出目录存在
-    if (!fs::exists(output_dir)) {
-        if (!fs::create_directories(output_dir)) {
+    // 确保输出目录存在；同一个目录只检查一次，不再逐帧 stat
+    if (output_dir != checked_dir_) {
+        if (!fs::exists(output_dir) && !fs::create_directories(output_dir)) {
             throw std::runtime_error("Failed to create output directory: " +
                                      output_dir);
         }
+        checked_dir_ = output_dir;
     }
     apply_algorithm(RGBFrame);
 
@@ -80,10 +81,151 @@ std::string OpenCVProcessor::process_and_save(const std::string& output_dir,
     return file_path;
 }
 
+std::future<std::string> OpenCVProcessor::process_and_save(SnapshotWriter& writer,
+                                                           cv::Mat& RGBFrame,
+                                                           SnapshotWriter::Callback done) {
+    apply_algorithm(RGBFrame);
+    return writer.submit(RGBFrame, std::move(done));
+}
+
+namespace {
+LumaPlane plane_of(cv::Mat& mat) {
+    return {mat.data, static_cast<int>(mat.step), mat.cols, mat.rows};
+}
+
+// 缩小 2^level 倍后的尺寸；level 为 0 或缩小后不足 16 像素时返回空，按原尺寸处理
+cv::Size reduced_size(const cv::Mat& mat, int level) {
+    if (level <= 0) return cv::Size();
+    const cv::Size size(mat.cols >> level, mat.rows >> level);
+    return size.width >= 16 && size.height >= 16 ? size : cv::Size();
+}
+}  // namespace
+
+bool OpenCVProcessor::set_algorithm(const std::string& name) {
+    auto chain = FilterChain::create(name);
+    if (!chain) {
+        std::cerr << "未知的算法链: " << name << std::endl;
+        return false;
+    }
+    chain_ = std::move(chain);
+    return true;
+}
+
+std::string OpenCVProcessor::describe_algorithm() const {
+    return chain_ ? chain_->describe() : "canny (opencv)";
+}
+
 void OpenCVProcessor::apply_algorithm(cv::Mat& frame) {
-    // 示例：Canny 边缘检测
-    cv::Mat gray, edges;
-    cv::cvtColor(frame, gray, cv::COLOR_RGB2GRAY);
-    cv::Canny(gray, edges, 100, 200);
-    cv::cvtColor(edges, frame, cv::COLOR_GRAY2RGB);
+    // 空链原样输出：不转灰度，也不经过缩小/放大
+    if (chain_ && chain_->empty()) return;
+    if (const cv::Size reduced = reduced_size(frame, pyramid_level_); !reduced.empty()) {
+        // 缩小用 INTER_AREA（相当于先低通再抽样），结果按双线性放大回原尺寸
+        cv::cvtColor(frame, gray_, cv::COLOR_RGB2GRAY);
+        cv::resize(gray_, small_, reduced, 0, 0, cv::INTER_AREA);
+        if (chain_) {
+            chain_->apply(plane_of(small_), tile_scheduler_);
+            cv::resize(small_, gray_, gray_.size(), 0, 0, cv::INTER_LINEAR);
+            LumaPlane plane = plane_of(gray_);
+            chain_->expand_rgb(plane, frame.data, static_cast<int>(frame.step));
+        } else {
+            cv::Canny(small_, edges_, 100, 200);
+            cv::resize(edges_, gray_, gray_.size(), 0, 0, cv::INTER_LINEAR);
+            cv::cvtColor(gray_, frame, cv::COLOR_GRAY2RGB);
+        }
+        return;
+    }
+    if (chain_) {
+        // 算法链在亮度上运行，最后按链的伪彩色展开回 RGB
+        cv::cvtColor(frame, gray_, cv::COLOR_RGB2GRAY);
+        LumaPlane plane = plane_of(gray_);
+        chain_->apply(plane, tile_scheduler_);
+        chain_->expand_rgb(plane, frame.data, static_cast<int>(frame.step));
+        return;
+    }
+    // 示例：Canny 边缘检测（中间结果复用成员缓冲区，不再逐帧分配）
+    if (!tile_scheduler_) {
+        cv::cvtColor(frame, gray_, cv::COLOR_RGB2GRAY);
+        cv::Canny(gray_, edges_, 100, 200);
+        cv::cvtColor(edges_, frame, cv::COLOR_GRAY2RGB);
+        return;
+    }
+    // 逐像素的颜色转换不需要 halo，按条带并行；cv::Canny 内部已自带并行
+    gray_.create(frame.rows, frame.cols, CV_8UC1);
+    tile_scheduler_->run(frame.rows, 0, [&](const TileScheduler::Tile& tile) {
+        cv::Mat band = gray_.rowRange(tile.row_begin, tile.row_end);
+        cv::cvtColor(frame.rowRange(tile.row_begin, tile.row_end), band,
+                     cv::COLOR_RGB2GRAY);
+    });
+    cv::Canny(gray_, edges_, 100, 200);
+    tile_scheduler_->run(frame.rows, 0, [&](const TileScheduler::Tile& tile) {
+        cv::Mat band = frame.rowRange(tile.row_begin, tile.row_end);
+        cv::cvtColor(edges_.rowRange(tile.row_begin, tile.row_end), band,
+                     cv::COLOR_GRAY2RGB);
+    });
+}
+
+void OpenCVProcessor::apply_algorithm_luma(cv::Mat& luma, cv::Mat& u, cv::Mat& v) {
+    // 空链保留原始色度，不把画面变成灰度
+    if (chain_ && chain_->empty()) return;
+    if (const cv::Size reduced = reduced_size(luma, pyramid_level_); !reduced.empty()) {
+        // 放大直接写回 Y 平面：尺寸与类型不变，resize 不会重新分配 luma 的数据
+        cv::resize(luma, small_, reduced, 0, 0, cv::INTER_AREA);
+        if (chain_) {
+            chain_->apply(plane_of(small_), tile_scheduler_);
+        } else {
+            edge_kernel_.detect(small_.data, static_cast<int>(small_.step), 1, small_.cols,
+                                small_.rows, small_.data, static_cast<int>(small_.step),
+                                tile_scheduler_);
+        }
+        cv::resize(small_, luma, luma.size(), 0, 0, cv::INTER_LINEAR);
+        u.setTo(cv::Scalar(128));
+        v.setTo(cv::Scalar(128));
+        return;
+    }
+    if (chain_) {
+        // YUV 输出保持灰度，伪彩色只在展开为 RGB 时生效
+        chain_->apply(plane_of(luma), tile_scheduler_);
+        u.setTo(cv::Scalar(128));
+        v.setTo(cv::Scalar(128));
+        return;
+    }
+    // 融合内核允许输入输出为同一块 Y 平面
+    edge_kernel_.detect(luma.data, static_cast<int>(luma.step), 1, luma.cols,
+                        luma.rows, luma.data, static_cast<int>(luma.step),
+                        tile_scheduler_);
+    u.setTo(cv::Scalar(128));
+    v.setTo(cv::Scalar(128));
+}
+
+bool OpenCVProcessor::Decode2Edges(const uint8_t* data, size_t size,
+                                   cv::Mat& edges, bool expand_rgb) {
+    if (!data || size == 0) {
+        std::cerr << "接收到的数据为空! " << std::endl;
+        return false;
+    }
+    cv::Mat& out = expand_rgb ? edges_ : edges;
+    out.create(height_, width_, CV_8UC1);
+    if (pixel_format_ == PixelFormat::YUYV) {
+        if (size < static_cast<size_t>(width_) * height_ * 2) {
+            std::cerr << "YUYV 数据不完整! " << std::endl;
+            return false;
+        }
+        // 亮度直接从 YUYV 的偶数字节读取
+        edge_kernel_.detect(data, static_cast<int>(width_ * 2), 2, width_, height_,
+                            out.data, static_cast<int>(out.step), tile_scheduler_);
+    } else {
+        // MJPEG 只解码亮度，跳过色度上采样与颜色转换
+        if (!jpeg_decoder_.decode_gray(data, size, gray_, decode_scale_)) {
+            std::cerr << "MJPEG 解码失败! " << std::endl;
+            return false;
+        }
+        out.create(gray_.rows, gray_.cols, CV_8UC1);
+        edge_kernel_.detect(gray_.data, static_cast<int>(gray_.step), 1, gray_.cols,
+                            gray_.rows, out.data, static_cast<int>(out.step),
+                            tile_scheduler_);
+    }
+    if (expand_rgb) {
+        cv::cvtColor(edges_, edges, cv::COLOR_GRAY2RGB);
+    }
+    return true;
 }
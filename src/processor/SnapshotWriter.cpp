@@ -0,0 +1,288 @@
+#include "processor/SnapshotWriter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "processor/FramePool.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+double elapsed_ms(std::chrono::steady_clock::time_point since,
+                  std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now()) {
+    return std::chrono::duration<double, std::milli>(until - since).count();
+}
+
+// 写满 size 字节，处理短写与 EINTR
+bool write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+}  // namespace
+
+bool parse_snapshot_format(const std::string& name, SnapshotFormat& format) {
+    if (name == "png") {
+        format = SnapshotFormat::PNG;
+    } else if (name == "jpeg" || name == "jpg") {
+        format = SnapshotFormat::JPEG;
+    } else if (name == "raw") {
+        format = SnapshotFormat::Raw;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter(std::string output_dir, Options options)
+    : output_dir_(std::move(output_dir)), options_(std::move(options)) {
+    // 目录只在这里检查一次
+    std::error_code ec;
+    fs::create_directories(output_dir_, ec);
+    if (ec || !fs::is_directory(output_dir_)) {
+        throw std::runtime_error("[SnapshotWriter] 无法创建输出目录 " + output_dir_);
+    }
+    dir_fd_ = ::open(output_dir_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    options_.workers = std::max(1u, options_.workers);
+    options_.queue_capacity = std::max<size_t>(1, options_.queue_capacity);
+    options_.jpeg_quality = std::clamp(options_.jpeg_quality, 0, 100);
+    options_.png_compression = std::clamp(options_.png_compression, 0, 9);
+    for (unsigned i = 0; i < options_.workers; ++i) {
+        workers_.emplace_back([this] { run(); });
+    }
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    for (auto& t : workers_) t.join();
+    // 工作线程已退出，剩余的文件在这里同步
+    sync_batch(unsynced_, unsynced_fs_);
+    if (dir_fd_ >= 0) ::close(dir_fd_);
+}
+
+std::string SnapshotWriter::next_path(const cv::Mat& frame) {
+    std::ostringstream oss;
+    oss << output_dir_ << "/" << options_.prefix << std::setfill('0') << std::setw(4)
+        << sequence_++;
+    switch (options_.format) {
+    case SnapshotFormat::PNG: oss << ".png"; break;
+    case SnapshotFormat::JPEG: oss << ".jpg"; break;
+    case SnapshotFormat::Raw:
+        oss << "_" << frame.cols << "x" << frame.rows
+            << (frame.channels() == 1 ? "_gray8" : "_rgb24") << ".raw";
+        break;
+    }
+    return oss.str();
+}
+
+std::future<std::string> SnapshotWriter::submit(const cv::Mat& frame, Callback done) {
+    Job job;
+    std::future<std::string> result = job.promise.get_future();
+    if (frame.empty() || frame.depth() != CV_8U ||
+        (frame.channels() != 3 && frame.channels() != 1)) {
+        std::cerr << "[SnapshotWriter] 不支持的帧格式" << std::endl;
+        job.promise.set_value("");
+        if (done) done("");
+        return result;
+    }
+    job.done = std::move(done);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++stats_.submitted;
+        if (options_.block_when_full) {
+            not_full_.wait(lock, [&] {
+                return stopping_ || queue_.size() + reserved_ < options_.queue_capacity;
+            });
+        }
+        if (stopping_ || queue_.size() + reserved_ >= options_.queue_capacity) {
+            ++stats_.dropped;
+            lock.unlock();
+            job.promise.set_value("");
+            if (job.done) job.done("");
+            return result;
+        }
+        job.path = next_path(frame);
+        ++reserved_;  // 占住队列位置，拷贝期间其他调用方不会超出容量
+    }
+    // 在锁外拷贝像素：调用方返回后可以立即复用自己的缓冲区
+    job.frame = FramePool::shared().acquire(frame.rows, frame.cols, frame.type());
+    frame.copyTo(job.frame);
+    job.queued_at = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --reserved_;
+        queue_.push_back(std::move(job));
+        stats_.queue_high_water = std::max(stats_.queue_high_water, queue_.size());
+    }
+    not_empty_.notify_one();
+    return result;
+}
+
+void SnapshotWriter::flush() {
+    std::vector<std::string> paths;
+    bool whole_fs = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [&] { return queue_.empty() && reserved_ == 0 && active_ == 0; });
+        paths.swap(unsynced_);
+        std::swap(whole_fs, unsynced_fs_);
+    }
+    sync_batch(paths, whole_fs);
+}
+
+void SnapshotWriter::run() {
+    // 每个工作线程复用自己的编码缓冲区与颜色转换结果
+    std::vector<uint8_t> encoded;
+    cv::Mat bgr;
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // 停止且队列已写完
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++active_;
+            const double wait_ms = elapsed_ms(job.queued_at);
+            queue_wait_ms_total_ += wait_ms;
+            stats_.queue_wait_ms_max = std::max(stats_.queue_wait_ms_max, wait_ms);
+        }
+        not_full_.notify_one();
+
+        const bool ok = write_job(job, encoded, bgr);
+        job.frame.release();  // 尽快把内存还给 FramePool
+        std::vector<std::string> batch;
+        if (ok) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (options_.fsync_batch == 0) {
+                unsynced_fs_ = true;
+            } else {
+                unsynced_.push_back(job.path);
+                if (unsynced_.size() >= options_.fsync_batch) batch.swap(unsynced_);
+            }
+        }
+        // 路径在文件写出（进入页缓存）后交付；落盘由批量同步保证
+        job.promise.set_value(ok ? job.path : "");
+        if (job.done) job.done(ok ? job.path : "");
+        sync_batch(batch);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        idle_.notify_all();
+    }
+}
+
+bool SnapshotWriter::write_job(Job& job, std::vector<uint8_t>& encoded, cv::Mat& bgr) {
+    const auto encode_start = std::chrono::steady_clock::now();
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    bool ok = true;
+    if (options_.format == SnapshotFormat::Raw) {
+        // 池化的 Mat 是连续的，直接整块写出
+        data = job.frame.data;
+        size = job.frame.total() * job.frame.elemSize();
+    } else {
+        const cv::Mat* src = &job.frame;
+        if (job.frame.channels() == 3) {
+            cv::cvtColor(job.frame, bgr, cv::COLOR_RGB2BGR);
+            src = &bgr;
+        }
+        const std::vector<int> params =
+            options_.format == SnapshotFormat::JPEG
+                ? std::vector<int>{cv::IMWRITE_JPEG_QUALITY, options_.jpeg_quality}
+                : std::vector<int>{cv::IMWRITE_PNG_COMPRESSION, options_.png_compression};
+        try {
+            ok = cv::imencode(options_.format == SnapshotFormat::JPEG ? ".jpg" : ".png", *src,
+                              encoded, params);
+        } catch (const cv::Exception& e) {
+            std::cerr << "[SnapshotWriter] 编码失败: " << e.what() << std::endl;
+            ok = false;
+        }
+        data = encoded.data();
+        size = encoded.size();
+    }
+    const double encode_ms = elapsed_ms(encode_start);
+
+    const auto write_start = std::chrono::steady_clock::now();
+    if (ok) {
+        // 写完立即关闭：同步时按路径重新打开，打开的描述符数量不随未同步的文件增长
+        const int fd = ::open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        ok = fd >= 0 && write_all(fd, data, size);
+        if (fd >= 0 && ::close(fd) < 0) ok = false;
+        if (!ok) {
+            std::cerr << "[SnapshotWriter] 写入 " << job.path << " 失败: " << std::strerror(errno)
+                      << std::endl;
+        }
+    }
+    const double write_ms = elapsed_ms(write_start);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    encode_ms_total_ += encode_ms;
+    stats_.encode_ms_max = std::max(stats_.encode_ms_max, encode_ms);
+    if (ok) {
+        ++stats_.written;
+        stats_.bytes_written += size;
+        write_ms_total_ += write_ms;
+    } else {
+        ++stats_.failed;
+    }
+    return ok;
+}
+
+void SnapshotWriter::sync_batch(std::vector<std::string>& paths, bool whole_fs) {
+    if (paths.empty() && !whole_fs) return;
+    if (whole_fs) {
+        // 数量不限的一批文件：一次 syncfs 代替逐个重新打开
+        if (dir_fd_ < 0 || ::syncfs(dir_fd_) < 0) ::sync();
+    }
+    for (const auto& path : paths) {
+        // 脏页属于文件而不是描述符，重新打开后 fdatasync 同样会把它们写回
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || ::fdatasync(fd) < 0) {
+            std::cerr << "[SnapshotWriter] 同步 " << path << " 失败: " << std::strerror(errno)
+                      << std::endl;
+        }
+        if (fd >= 0) ::close(fd);
+    }
+    paths.clear();
+    // 新文件的目录项也要落盘，整批只同步一次
+    if (dir_fd_ >= 0) ::fsync(dir_fd_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.fsyncs;
+}
+
+SnapshotWriter::Stats SnapshotWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.queue_depth = queue_.size();
+    const uint64_t dequeued = s.written + s.failed;
+    if (dequeued) {
+        s.queue_wait_ms_avg = queue_wait_ms_total_ / dequeued;
+        s.encode_ms_avg = encode_ms_total_ / dequeued;
+    }
+    if (s.written) s.write_ms_avg = write_ms_total_ / s.written;
+    return s;
+}
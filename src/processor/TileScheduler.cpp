@@ -0,0 +1,103 @@
+#include "processor/TileScheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+TileScheduler::TileScheduler(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+TileScheduler::~TileScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+TileScheduler::Tile TileScheduler::make_tile(int height, int tile_count, int halo,
+                                             int index) {
+    Tile tile;
+    tile.index = index;
+    // 余数均摊到前面的条带，各条带行数相差不超过 1
+    const int base = height / tile_count, extra = height % tile_count;
+    tile.row_begin = index * base + std::min(index, extra);
+    tile.row_end = tile.row_begin + base + (index < extra ? 1 : 0);
+    tile.halo_begin = std::max(0, tile.row_begin - halo);
+    tile.halo_end = std::min(height, tile.row_end + halo);
+    return tile;
+}
+
+void TileScheduler::run(int height, int halo, const TileFn& fn, int tile_count) {
+    if (height <= 0) return;
+    if (tile_count <= 0) tile_count = static_cast<int>(thread_count());
+    tile_count = std::min(tile_count, height);
+
+    if (workers_.empty() || tile_count == 1) {
+        for (int i = 0; i < tile_count; ++i) fn(make_tile(height, tile_count, halo, i));
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // 等上一轮迟到的工作线程退出 drain()，它们仍可能读取本轮要改写的参数
+        done_cv_.wait(lock, [this] { return active_ == 0; });
+        fn_ = &fn;
+        height_ = height;
+        halo_ = halo;
+        tile_count_ = tile_count;
+        remaining_ = tile_count;
+        error_ = nullptr;
+        next_tile_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    work_cv_.notify_all();
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return remaining_ == 0; });
+    fn_ = nullptr;
+    if (error_) std::rethrow_exception(std::exchange(error_, nullptr));
+}
+
+void TileScheduler::drain() {
+    int finished = 0;
+    std::exception_ptr error;
+    for (;;) {
+        const int index = next_tile_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= tile_count_) break;
+        try {
+            (*fn_)(make_tile(height_, tile_count_, halo_, index));
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+        ++finished;
+    }
+    if (finished == 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error && !error_) error_ = error;
+    remaining_ -= finished;
+    if (remaining_ == 0) done_cv_.notify_all();
+}
+
+void TileScheduler::worker_loop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            ++active_;
+        }
+        drain();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--active_ == 0) done_cv_.notify_all();
+    }
+}
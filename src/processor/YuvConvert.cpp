@@ -0,0 +1,183 @@
+#include "processor/YuvConvert.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VISION_X86 1
+#endif
+
+namespace {
+
+// 处理一对源行（row1 为空表示奇数高度的最后一行）中 [x_begin, width) 的像素
+void convert_row_pair_scalar(const uint8_t* row0, const uint8_t* row1,
+                             uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v,
+                             int x_begin, int width) {
+    for (int x = x_begin; x < width; x += 2) {
+        const uint8_t* p0 = row0 + x * 2;
+        y0[x] = p0[0];
+        y0[x + 1] = p0[2];
+        if (row1) {
+            const uint8_t* p1 = row1 + x * 2;
+            y1[x] = p1[0];
+            y1[x + 1] = p1[2];
+            u[x / 2] = static_cast<uint8_t>((p0[1] + p1[1] + 1) >> 1);
+            v[x / 2] = static_cast<uint8_t>((p0[3] + p1[3] + 1) >> 1);
+        } else {
+            u[x / 2] = p0[1];
+            v[x / 2] = p0[3];
+        }
+    }
+}
+
+#ifdef VISION_X86
+// 每次处理 32 个像素（每行 64 字节 YUYV）
+void convert_row_pair_sse2(const uint8_t* row0, const uint8_t* row1,
+                           uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v,
+                           int width) {
+    const __m128i lo_mask = _mm_set1_epi16(0x00FF);
+    const int simd_width = width & ~31;
+    for (int x = 0; x < simd_width; x += 32) {
+        const __m128i* s0 = reinterpret_cast<const __m128i*>(row0 + x * 2);
+        const __m128i* s1 = reinterpret_cast<const __m128i*>(row1 + x * 2);
+        __m128i a[4], b[4];
+        for (int i = 0; i < 4; ++i) {
+            a[i] = _mm_loadu_si128(s0 + i);
+            b[i] = _mm_loadu_si128(s1 + i);
+        }
+        // 偶数字节是 Y，奇数字节是 U/V 交替
+        for (int i = 0; i < 2; ++i) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(y0 + x + i * 16),
+                             _mm_packus_epi16(_mm_and_si128(a[2 * i], lo_mask),
+                                              _mm_and_si128(a[2 * i + 1], lo_mask)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(y1 + x + i * 16),
+                             _mm_packus_epi16(_mm_and_si128(b[2 * i], lo_mask),
+                                              _mm_and_si128(b[2 * i + 1], lo_mask)));
+        }
+        // UVUV... 两行求平均：_mm_avg_epu8 正好是 (a + b + 1) >> 1
+        __m128i uv[2];
+        for (int i = 0; i < 2; ++i) {
+            __m128i uv0 = _mm_packus_epi16(_mm_srli_epi16(a[2 * i], 8),
+                                           _mm_srli_epi16(a[2 * i + 1], 8));
+            __m128i uv1 = _mm_packus_epi16(_mm_srli_epi16(b[2 * i], 8),
+                                           _mm_srli_epi16(b[2 * i + 1], 8));
+            uv[i] = _mm_avg_epu8(uv0, uv1);
+        }
+        __m128i uu = _mm_packus_epi16(_mm_and_si128(uv[0], lo_mask),
+                                      _mm_and_si128(uv[1], lo_mask));
+        __m128i vv = _mm_packus_epi16(_mm_srli_epi16(uv[0], 8),
+                                      _mm_srli_epi16(uv[1], 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u + x / 2), uu);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + x / 2), vv);
+    }
+    convert_row_pair_scalar(row0, row1, y0, y1, u, v, simd_width, width);
+}
+
+// AVX2 的 pack 在两个 128 位通道内各自进行，结果需要用 permute4x64 恢复顺序
+// 取每个 16 位字的低字节（Y 或 U）
+__attribute__((target("avx2"))) inline __m256i pack_lo_avx2(__m256i p, __m256i q) {
+    const __m256i lo_mask = _mm256_set1_epi16(0x00FF);
+    return _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_and_si256(p, lo_mask),
+                            _mm256_and_si256(q, lo_mask)),
+        0xD8);
+}
+
+// 取每个 16 位字的高字节（U/V 或 V）
+__attribute__((target("avx2"))) inline __m256i pack_hi_avx2(__m256i p, __m256i q) {
+    return _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(_mm256_srli_epi16(p, 8), _mm256_srli_epi16(q, 8)),
+        0xD8);
+}
+
+// 每次处理 64 个像素（每行 128 字节 YUYV）
+__attribute__((target("avx2")))
+void convert_row_pair_avx2(const uint8_t* row0, const uint8_t* row1,
+                           uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v,
+                           int width) {
+    const int simd_width = width & ~63;
+    for (int x = 0; x < simd_width; x += 64) {
+        const __m256i* s0 = reinterpret_cast<const __m256i*>(row0 + x * 2);
+        const __m256i* s1 = reinterpret_cast<const __m256i*>(row1 + x * 2);
+        __m256i a[4], b[4];
+        for (int i = 0; i < 4; ++i) {
+            a[i] = _mm256_loadu_si256(s0 + i);
+            b[i] = _mm256_loadu_si256(s1 + i);
+        }
+        __m256i uv[2];
+        for (int i = 0; i < 2; ++i) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y0 + x + i * 32),
+                                pack_lo_avx2(a[2 * i], a[2 * i + 1]));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y1 + x + i * 32),
+                                pack_lo_avx2(b[2 * i], b[2 * i + 1]));
+            uv[i] = _mm256_avg_epu8(pack_hi_avx2(a[2 * i], a[2 * i + 1]),
+                                    pack_hi_avx2(b[2 * i], b[2 * i + 1]));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + x / 2),
+                            pack_lo_avx2(uv[0], uv[1]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + x / 2),
+                            pack_hi_avx2(uv[0], uv[1]));
+    }
+    convert_row_pair_sse2(row0 + simd_width * 2, row1 + simd_width * 2,
+                          y0 + simd_width, y1 + simd_width, u + simd_width / 2,
+                          v + simd_width / 2, width - simd_width);
+}
+#endif
+
+}  // namespace
+
+SimdLevel detect_simd_level() {
+#ifdef VISION_X86
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void yuyv_to_yuv420p_scalar(const uint8_t* src, int src_stride, int width,
+                            int height, const Yuv420pPlanes& dst) {
+    yuyv_to_yuv420p(src, src_stride, width, height, dst, SimdLevel::Scalar);
+}
+
+void yuyv_to_yuv420p(const uint8_t* src, int src_stride, int width, int height,
+                     const Yuv420pPlanes& dst, SimdLevel level) {
+    if (level > detect_simd_level()) level = detect_simd_level();
+    for (int row = 0; row < height; row += 2) {
+        const uint8_t* row0 = src + static_cast<size_t>(row) * src_stride;
+        uint8_t* y0 = dst.y + static_cast<size_t>(row) * dst.y_stride;
+        uint8_t* u = dst.u + static_cast<size_t>(row / 2) * dst.u_stride;
+        uint8_t* v = dst.v + static_cast<size_t>(row / 2) * dst.v_stride;
+        if (row + 1 >= height) {
+            // 奇数高度：最后一行没有配对行
+            convert_row_pair_scalar(row0, nullptr, y0, nullptr, u, v, 0, width);
+            break;
+        }
+        const uint8_t* row1 = row0 + src_stride;
+        uint8_t* y1 = y0 + dst.y_stride;
+        switch (level) {
+#ifdef VISION_X86
+            case SimdLevel::AVX2:
+                convert_row_pair_avx2(row0, row1, y0, y1, u, v, width);
+                break;
+            case SimdLevel::SSE2:
+                convert_row_pair_sse2(row0, row1, y0, y1, u, v, width);
+                break;
+#endif
+            default:
+                convert_row_pair_scalar(row0, row1, y0, y1, u, v, 0, width);
+                break;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include "streamer/AVFramePool.hpp"
+
+#include <stdexcept>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+AVFramePool::AVFramePool(int width, int height, AVPixelFormat format, int align)
+    : width_(width), height_(height), format_(format), align_(align) {
+    buffer_size_ = av_image_get_buffer_size(format_, width_, height_, align_);
+    if (buffer_size_ < 0) {
+        throw std::runtime_error("AVFramePool: 无效的分辨率或像素格式");
+    }
+    pool_ = av_buffer_pool_init2(buffer_size_, this, &AVFramePool::alloc_buffer,
+                                 nullptr);
+    if (!pool_) {
+        throw std::runtime_error("AVFramePool: 创建缓冲池失败");
+    }
+}
+
+AVFramePool::~AVFramePool() {
+    // 仍在外部的缓冲区归还后池才真正释放
+    av_buffer_pool_uninit(&pool_);
+}
+
+AVBufferRef* AVFramePool::alloc_buffer(void* opaque, size_t size) {
+    auto* self = static_cast<AVFramePool*>(opaque);
+    self->misses_.fetch_add(1, std::memory_order_relaxed);
+    return av_buffer_alloc(size);
+}
+
+AVFramePtr AVFramePool::acquire() {
+    AVFramePtr frame(av_frame_alloc());
+    if (!frame) return nullptr;
+    frame->buf[0] = av_buffer_pool_get(pool_);
+    if (!frame->buf[0]) return nullptr;
+    frame->format = format_;
+    frame->width = width_;
+    frame->height = height_;
+    // 各平面共享同一块缓冲区，只填写指针和行宽
+    if (av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data,
+                             format_, width_, height_, align_) < 0) {
+        return nullptr;
+    }
+    acquired_.fetch_add(1, std::memory_order_relaxed);
+    return frame;
+}
+
+AVFramePool::Stats AVFramePool::stats() const {
+    Stats s;
+    s.misses = misses_.load(std::memory_order_relaxed);
+    uint64_t acquired = acquired_.load(std::memory_order_relaxed);
+    s.hits = acquired > s.misses ? acquired - s.misses : 0;
+    return s;
+}
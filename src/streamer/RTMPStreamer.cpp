@@ -1,12 +1,73 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include "streamer/RTMPStreamer.hpp"
+#include "pipeline/Tracer.hpp"
+#include "streamer/SegmentRecorder.hpp"
+#include "processor/YuvConvert.hpp"
 
-RTMPStreamer::RTMPStreamer(int w, int h, int f, const char* rtmp_url)
-    : width(w), height(h), fps(f), pts(0),
-      output_ctx(nullptr), codec_ctx(nullptr), frame(nullptr), sws_ctx(nullptr)
+namespace {
+// 按 H.264 附录 A 表 A-1 选出能容纳该分辨率与帧率的最低 level（不低于 3.1）。
+// 只看每帧宏块数（MaxFS）与每秒宏块数（MaxMBPS）；超出 6.2 时返回 nullptr，交给 x264 自行选择
+const char* h264_level(int width, int height, int fps) {
+    struct Limit { const char* name; int64_t max_mbps; int64_t max_fs; };
+    static const Limit kLimits[] = {
+        {"3.1", 108000, 3600},    {"3.2", 216000, 5120},     {"4.0", 245760, 8192},
+        {"4.2", 522240, 8704},    {"5.0", 589824, 22080},    {"5.1", 983040, 36864},
+        {"5.2", 2073600, 36864},  {"6.0", 4177920, 139264},  {"6.1", 8355840, 139264},
+        {"6.2", 16711680, 139264},
+    };
+    const int64_t frame_mbs = static_cast<int64_t>((width + 15) / 16) * ((height + 15) / 16);
+    const int64_t mbps = frame_mbs * std::max(1, fps);
+    for (const auto& limit : kLimits) {
+        if (frame_mbs <= limit.max_fs && mbps <= limit.max_mbps) return limit.name;
+    }
+    return nullptr;
+}
+}  // namespace
+
+RTMPStreamer::RTMPStreamer(int w, int h, int f, const char* rtmp_url,
+                           EncoderConfig encoder_config,
+                           PacketWriter<AVPacketPtr>::Options write_options)
+    : width(w), height(h), fps(f), config(encoder_config),
+      output_ctx(nullptr), codec_ctx(nullptr), sws_ctx(nullptr)
        {
     avformat_network_init();
     InitEncoder(rtmp_url);
+    // 头部写完后 output_ctx 只由写出线程访问
+    writer = std::make_unique<PacketWriter<AVPacketPtr>>(
+        [this](AVPacketPtr& pkt) {
+            Tracer::set_thread_name("mux");
+            return WritePacket(pkt);
+        },
+        write_options);
+}
+
+bool RTMPStreamer::WritePacket(AVPacketPtr& pkt) {
+    // 写出线程没有帧序号，span 以包 PTS（编码器时间基）标记
+    TraceSpan span("mux", static_cast<uint64_t>(pkt->pts));
+    // 包时间戳是编码器时间基，写出前换算到流的时间基（FLV 在写头部时改成 1/1000）
+    const int64_t origin_ns = clock_origin_ns.load(std::memory_order_acquire);
+    const int64_t capture_ns =
+        origin_ns ? origin_ns + av_rescale_q(pkt->pts, codec_ctx->time_base, {1, 1000000000})
+                  : 0;
+    av_packet_rescale_ts(pkt.get(), codec_ctx->time_base, video_stream->time_base);
+    // av_interleaved_write_frame 接管包内数据的引用，可能因 TCP 拥塞阻塞
+    int ret = av_interleaved_write_frame(output_ctx, pkt.get());
+    if (ret < 0) {
+        char errbuf[256];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        std::cerr << "[RTMPStreamer] 推送帧失败 av_interleaved_write_frame: "
+                  << errbuf << std::endl;
+        return false;
+    }
+    if (capture_ns) {
+        const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        capture_latency.add((now_ns - capture_ns) / 1e6);
+    }
+    return true;
 }
 
 void RTMPStreamer::InitEncoder(const char* rtmp_url) {
@@ -26,46 +87,66 @@ void RTMPStreamer::InitEncoder(const char* rtmp_url) {
     }
 
     // ——————————————————————————————————————————————————————————————
-    // 3. 查找 H.264 编码器（libx264）
+    // 3. 按名称查找编码器（默认 libx264）
     //    AVCodecContext 将用来编码视频帧。
     // ——————————————————————————————————————————————————————————————
-    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_H264);
-    if (!codec) {
-        throw std::runtime_error("未找到H264编码器");
+    const AVCodec* codec = avcodec_find_encoder_by_name(config.codec.c_str());
+    if (!codec || codec->type != AVMEDIA_TYPE_VIDEO) {
+        throw std::runtime_error("未找到编码器 " + config.codec);
     }
+    const bool is_x264 = config.codec == "libx264";
 
     // ——————————————————————————————————————————————————————————————
     // 4. 分配并配置编码器上下文
     //    - width/height: 分辨率
-    //    - time_base/framerate: 时间基准（帧率 1/fps）
+    //    - time_base/framerate: 时间基准（90kHz，PTS 取自采集时钟）与标称帧率
     //    - pix_fmt: 像素格式（输出 YUV420P）
-    //    - bit_rate/rc_max_rate/rc_buffer_size: 码率控制
+    //    - bit_rate/rc_max_rate/rc_buffer_size: 码率控制（见 RateControl）
+    //    - thread_count/thread_type: 线程数与 slice/帧 线程模型
     // ——————————————————————————————————————————————————————————————
     codec_ctx = avcodec_alloc_context3(codec);
     codec_ctx->width = width;
     codec_ctx->height = height;
-    codec_ctx->time_base = {1, fps};
+    codec_ctx->time_base = kTimeBase;
     codec_ctx->framerate = {fps, 1};
     codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
-    codec_ctx->bit_rate = 2000000;
-    codec_ctx->rc_max_rate = 2000000;
-    codec_ctx->rc_buffer_size = 4000000;
+    codec_ctx->gop_size = config.gop_size;
+    codec_ctx->max_b_frames = 0;
+    ConfigureRateControl(1.0);
+    codec_ctx->thread_count = config.threads;
+    codec_ctx->thread_type =
+        config.threading == EncoderThreading::Frame ? FF_THREAD_FRAME : FF_THREAD_SLICE;
 
     // ——————————————————————————————————————————————————————————————
-    // 5. 设置 x264 参数字典
-    //    - preset=ultrafast: 尽可能快的编码
-    //    - tune=zerolatency: 零延迟编码，适合实时推流
-    //    - profile/level: 保证兼容性
-    //    - keyint/mbtree/bframes: GOP 长度与帧类型控制
+    // 5. 设置编码器参数字典
+    //    - preset: 默认 ultrafast，尽可能快的编码
+    //    - tune: 默认 zerolatency，零延迟编码，适合实时推流
+    //    - crf: 仅 CRF 模式
+    //    - profile/level: 保证兼容性（仅 libx264）
+    //    - keyint/mbtree/bframes: GOP 长度与帧类型控制（仅 libx264）
+    //    其他编码器只设置通用参数，编码器不认识的参数会在打开后给出警告
     // ——————————————————————————————————————————————————————————————
     AVDictionary* codec_options = nullptr;
-    av_dict_set(&codec_options, "preset", "ultrafast", 0);
-    av_dict_set(&codec_options, "tune", "zerolatency", 0);
-    av_dict_set(&codec_options, "profile", "baseline", 0);
-    av_dict_set(&codec_options, "level", "3.1", 0);
-    av_dict_set(&codec_options, "x264-params",
-                "keyint=60:min-keyint=30:no-scenecut=1"
-                ":no-mbtree=1:bframes=0", 0);
+    if (!config.preset.empty()) av_dict_set(&codec_options, "preset", config.preset.c_str(), 0);
+    if (!config.tune.empty()) av_dict_set(&codec_options, "tune", config.tune.c_str(), 0);
+    if (config.rate_control == RateControl::CRF) {
+        av_dict_set(&codec_options, "crf", std::to_string(config.crf).c_str(), 0);
+    }
+    if (is_x264) {
+        av_dict_set(&codec_options, "profile", "baseline", 0);
+        // 720p30 及以下保持 3.1；更大的分辨率或帧率按宏块数选 level（4K30 为 5.1）
+        if (const char* level = h264_level(width, height, fps)) {
+            av_dict_set(&codec_options, "level", level, 0);
+        }
+        std::string x264_params =
+            "keyint=" + std::to_string(config.gop_size) +
+            ":min-keyint=" + std::to_string(std::max(1, config.gop_size / 2)) +
+            ":no-scenecut=1:no-mbtree=1:bframes=0";
+        if (config.rate_control == RateControl::CBR) x264_params += ":nal-hrd=cbr";
+        av_dict_set(&codec_options, "x264-params", x264_params.c_str(), 0);
+        // 调用方通过 pict_type 强制的关键帧编码为 IDR
+        av_dict_set(&codec_options, "forced-idr", "1", 0);
+    }
 
     // 在 InitEncoder() 中，打开编码器前，添加：
     // 一些 RTMP 接收端（包括 Nginx-RTMP）要求所有的 codec extradata（SPS/PPS）
@@ -78,7 +159,13 @@ void RTMPStreamer::InitEncoder(const char* rtmp_url) {
     // 打开编码器，并将参数应用到 codec_ctx
     if (avcodec_open2(codec_ctx, codec, &codec_options) < 0) {
         av_dict_free(&codec_options);
-        throw std::runtime_error("打开编码器失败");
+        throw std::runtime_error("打开编码器 " + config.codec + " 失败");
+    }
+    // avcodec_open2 会移除已识别的参数，剩下的是该编码器不支持的
+    const AVDictionaryEntry* unused = nullptr;
+    while ((unused = av_dict_get(codec_options, "", unused, AV_DICT_IGNORE_SUFFIX))) {
+        std::cerr << "[RTMPStreamer] 编码器 " << config.codec << " 忽略参数 " << unused->key
+                  << "=" << unused->value << std::endl;
     }
     av_dict_free(&codec_options);
 
@@ -127,99 +214,283 @@ void RTMPStreamer::InitEncoder(const char* rtmp_url) {
     }
 
     // ——————————————————————————————————————————————————————————————
-    // 10. 分配 AVFrame 供后续填充 YUV 数据
-    //     设置 frame 的格式、宽高，并分配缓冲区。
+    // 10. 创建 YUV420P 帧池，供后续每帧填充 YUV 数据
+    //     帧被编码器释放后缓冲区自动回到池中。
     // ——————————————————————————————————————————————————————————————
-    frame = av_frame_alloc();
-    frame->format = AV_PIX_FMT_YUV420P;
-    frame->width  = width;
-    frame->height = height;
-    if (av_frame_get_buffer(frame, 32) < 0) {
-        throw std::runtime_error("分配帧缓冲区失败");
-    }
+    frame_pool = std::make_unique<AVFramePool>(width, height, AV_PIX_FMT_YUV420P, 32);
 }
 
 
 // 推送一帧到 RTMP 服务器
 void RTMPStreamer::PushFrame(const cv::Mat& rgbFrame) {
+    AVFramePtr yuv = ConvertFrame(rgbFrame);
+    if (yuv) {
+        EncodeFrame(std::move(yuv));
+    }
+}
+
+AVFramePtr RTMPStreamer::ConvertFrame(const cv::Mat& rgbFrame) {
     // ——————————————————————————————————————————————————————————————
     // 1. 基本校验：确保所有上下文已正确初始化
     // ——————————————————————————————————————————————————————————————
-    if (!frame || !sws_ctx || !codec_ctx || !output_ctx) {
+    if (!frame_pool || !sws_ctx) {
         std::cerr << "[RTMPStreamer] 推流前检查失败: 初始化未完成" << std::endl;
-        return;
+        return nullptr;
     }
 
-    // std::cout << "[RTMPStreamer] 开始推送帧..." << std::endl;
+    AVFramePtr frame = frame_pool->acquire();
+    if (!frame) {
+        std::cerr << "[RTMPStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
 
     // ——————————————————————————————————————————————————————————————
-    // 2. 颜色空间转换：BGR24 (OpenCV) → YUV420P (编码器)
+    // 2. 颜色空间转换：RGB24 (OpenCV) → YUV420P (编码器)
     //    sws_scale 会将 rgbFrame.data 转换并写入到 frame->data 中
     // ——————————————————————————————————————————————————————————————
     const uint8_t* srcData[1] = { rgbFrame.data };
     const int srcLinesize[1] = { static_cast<int>(rgbFrame.step) };
     sws_scale(sws_ctx, srcData, srcLinesize, 0,
               height, frame->data, frame->linesize);
+    return frame;
+}
+
+AVFramePtr RTMPStreamer::ConvertFromYUYV(const uint8_t* yuyv, int stride) {
+    if (!frame_pool || !yuyv) {
+        std::cerr << "[RTMPStreamer] 推流前检查失败: 初始化未完成" << std::endl;
+        return nullptr;
+    }
+    AVFramePtr frame = frame_pool->acquire();
+    if (!frame) {
+        std::cerr << "[RTMPStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
+    yuyv_to_yuv420p(yuyv, stride, width, height, yuv420p_planes(frame.get()));
+    return frame;
+}
+
+AVFramePtr RTMPStreamer::ConvertFromMJPEG(JpegDecoder& decoder, const uint8_t* jpeg,
+                                          size_t size) {
+    if (!frame_pool || !jpeg) {
+        std::cerr << "[RTMPStreamer] 推流前检查失败: 初始化未完成" << std::endl;
+        return nullptr;
+    }
+    AVFramePtr frame = frame_pool->acquire();
+    if (!frame) {
+        std::cerr << "[RTMPStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
+    if (!decoder.decode_yuv420p(jpeg, size, yuv420p_planes(frame.get()), width, height)) {
+        return nullptr;
+    }
+    return frame;
+}
+
+void RTMPStreamer::ConfigureRateControl(double scale) {
+    const int64_t bit_rate = static_cast<int64_t>(config.bit_rate * scale);
+    switch (config.rate_control) {
+    case RateControl::VBV:
+        codec_ctx->bit_rate = bit_rate;
+        codec_ctx->rc_max_rate = bit_rate;
+        codec_ctx->rc_buffer_size = static_cast<int>(bit_rate * 2);
+        break;
+    case RateControl::CBR:
+        codec_ctx->bit_rate = bit_rate;
+        codec_ctx->rc_min_rate = bit_rate;
+        codec_ctx->rc_max_rate = bit_rate;
+        codec_ctx->rc_buffer_size = static_cast<int>(bit_rate);
+        break;
+    case RateControl::CRF:
+        if (bit_rate > 0) {
+            codec_ctx->rc_max_rate = bit_rate;
+            codec_ctx->rc_buffer_size = static_cast<int>(bit_rate * 2);
+        }
+        break;
+    }
+}
+
+void RTMPStreamer::SetBitRateScale(double scale) {
+    bit_rate_scale.store(std::clamp(scale, 0.1, 1.0), std::memory_order_relaxed);
+}
+
+void RTMPStreamer::EncodeFrame(AVFramePtr frame, int64_t capture_ns) {
+    if (!frame || !codec_ctx || !output_ctx) {
+        std::cerr << "[RTMPStreamer] 推流前检查失败: 初始化未完成" << std::endl;
+        return;
+    }
+    if (flushed) return;  // Flush() 之后编码器已进入排空状态
 
     // ——————————————————————————————————————————————————————————————
     // 3. 设置 PTS（Presentation Timestamp），用于同步
+    //    有采集时间时取自采集时钟，中间丢掉的帧在时间轴上保留空隙；
+    //    否则按标称帧率递增。PTS 必须严格递增
     // ——————————————————————————————————————————————————————————————
-    frame->pts = pts++;
+    frame->pts = last_pts = NextPts(capture_ns);
+    // 保留一个引用供 RepeatFrame 使用（只增加缓冲区引用计数，不拷贝像素）
+    if (!last_frame) last_frame.reset(av_frame_alloc());
+    if (last_frame) {
+        av_frame_unref(last_frame.get());
+        if (av_frame_ref(last_frame.get(), frame.get()) < 0) last_frame.reset();
+    }
 
     // ——————————————————————————————————————————————————————————————
     // 4. 发送帧到编码器（非阻塞或阻塞，取决实现）
     // ——————————————————————————————————————————————————————————————
-    int ret = avcodec_send_frame(codec_ctx, frame);
+    // 码率调整在编码线程中、两帧之间生效：libx264 在下一次 send_frame 时
+    // 发现码率/VBV 参数变化并调用 x264_encoder_reconfig，码流参数集不变
+    const double scale = bit_rate_scale.load(std::memory_order_relaxed);
+    if (scale != applied_bit_rate_scale) {
+        ConfigureRateControl(scale);
+        applied_bit_rate_scale = scale;
+    }
+    pending_frames.emplace_back(frame->pts, std::chrono::steady_clock::now());
+    int ret = avcodec_send_frame(codec_ctx, frame.get());
+    // 编码器需要时会自己增加引用，这里释放后缓冲区在编码器用完时回到池中
+    frame.reset();
     if (ret < 0) {
+        pending_frames.pop_back();
         char errbuf[256];
         av_strerror(ret, errbuf, sizeof(errbuf));
         std::cerr << "[RTMPStreamer] avcodec_send_frame 错误: " << errbuf << std::endl;
         return;
     }
+    {
+        std::lock_guard<std::mutex> lock(encode_stats_mutex);
+        encode_stats.in_flight = pending_frames.size();
+        encode_stats.in_flight_max = std::max(encode_stats.in_flight_max, pending_frames.size());
+    }
 
     // ——————————————————————————————————————————————————————————————
-    // 5. 从编码器接收 packet 并写到 RTMP 服务器
-    //    一帧可能对应多个 packet，需要循环发送
+    // 5. 从编码器接收 packet 并交给写出线程发送到 RTMP 服务器
+    //    帧线程模型下这一帧的包可能要在之后几帧才出来
     // ——————————————————————————————————————————————————————————————
-    while (ret >= 0) {
-        AVPacket* pkt = av_packet_alloc();
+    ReceivePackets();
+}
+
+int64_t RTMPStreamer::NextPts(int64_t capture_ns) {
+    int64_t next_pts;
+    if (capture_ns > 0) {
+        int64_t origin = clock_origin_ns.load(std::memory_order_relaxed);
+        if (!origin) {
+            origin = capture_ns;
+            clock_origin_ns.store(origin, std::memory_order_release);
+        }
+        next_pts = av_rescale_q(capture_ns - origin, {1, 1000000000}, codec_ctx->time_base);
+    } else {
+        next_pts = last_pts == AV_NOPTS_VALUE
+                       ? 0
+                       : last_pts + av_rescale_q(1, {1, fps}, codec_ctx->time_base);
+    }
+    if (last_pts != AV_NOPTS_VALUE && next_pts <= last_pts) next_pts = last_pts + 1;
+    return next_pts;
+}
 
-        ret = avcodec_receive_packet(codec_ctx, pkt);
+bool RTMPStreamer::RepeatFrame(int64_t capture_ns) {
+    // 还没有编过帧时没有可重复的画面
+    if (!last_frame || !last_frame->buf[0] || !codec_ctx || flushed) return false;
+    const int64_t pts = NextPts(capture_ns);
+    const int64_t interval =
+        av_rescale_q(config.repeat_interval_ms, {1, 1000}, codec_ctx->time_base);
+    if (capture_ns > 0 && pts - last_pts < interval) {
+        std::lock_guard<std::mutex> lock(encode_stats_mutex);
+        ++encode_stats.repeat_skipped;
+        return false;
+    }
+    AVFramePtr frame(av_frame_clone(last_frame.get()));
+    if (!frame) return false;
+    const int64_t gop_ticks = av_rescale_q(config.gop_size, {1, fps}, codec_ctx->time_base);
+    frame->pict_type = last_key_pts != AV_NOPTS_VALUE && pts - last_key_pts >= gop_ticks
+                           ? AV_PICTURE_TYPE_I
+                           : AV_PICTURE_TYPE_NONE;
+    EncodeFrame(std::move(frame), capture_ns);
+    std::lock_guard<std::mutex> lock(encode_stats_mutex);
+    ++encode_stats.repeated;
+    return true;
+}
+
+void RTMPStreamer::ReceivePackets() {
+    for (;;) {
+        AVPacketPtr pkt(av_packet_alloc());
+
+        int ret = avcodec_receive_packet(codec_ctx, pkt.get());
         if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            av_packet_free(&pkt);
             break;
         } else if (ret < 0) {
             char errbuf[256];
             av_strerror(ret, errbuf, sizeof(errbuf));
             std::cerr << "[RTMPStreamer] avcodec_receive_packet 错误: " << errbuf << std::endl;
-            av_packet_free(&pkt);
             break;
         }
 
         // ———— 设置 packet 属于哪个流 —————————————————
         pkt->stream_index = video_stream->index;
-        // ———— 设置时间戳 ————————————————————————
-        pkt->pts = frame->pts;
-        pkt->dts = pkt->pts;
-        // 可选：pkt->duration = 1;
-
-        // ———— 实际写包到 RTMP —————————————————————
-        ret = av_interleaved_write_frame(output_ctx, pkt);
-        if (ret < 0) {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            std::cerr << "[RTMPStreamer] 推送帧失败 av_interleaved_write_frame: "
-                      << errbuf << std::endl;
+        // ———— 时间戳：沿用编码器给出的帧 PTS（没有 B 帧，DTS 与 PTS 相同）————
+        //      出包可能晚于送入，不能用当前送入帧的 PTS
+        if (pkt->dts == AV_NOPTS_VALUE) pkt->dts = pkt->pts;
+
+        // ———— 编码延迟：从送入到出包 ——————————————————
+        const auto now = std::chrono::steady_clock::now();
+        while (!pending_frames.empty() && pending_frames.front().first < pkt->pts) {
+            pending_frames.pop_front();  // 被编码器丢弃的帧
         }
+        if (!pending_frames.empty() && pending_frames.front().first == pkt->pts) {
+            const double latency_ms = std::chrono::duration<double, std::milli>(
+                now - pending_frames.front().second).count();
+            pending_frames.pop_front();
+            {
+                std::lock_guard<std::mutex> lock(encode_stats_mutex);
+                ++encode_stats.frames;
+                encode_stats.latency_ms_last = latency_ms;
+                encode_stats.latency_ms_max = std::max(encode_stats.latency_ms_max, latency_ms);
+                latency_ms_total += latency_ms;
+                encode_stats.in_flight = pending_frames.size();
+            }
+            if (latency_callback) latency_callback(pkt->pts, latency_ms);
+        }
+
+        // ———— 旁路给录像（只增加引用计数）————————————
+        if (recorder) recorder->OnPacket(*pkt);
 
-        av_packet_unref(pkt);
-        av_packet_free(&pkt);
+        // ———— 交给写出线程，队列满时按 GOP 丢包 ——————————
+        const bool keyframe = pkt->flags & AV_PKT_FLAG_KEY;
+        if (keyframe) last_key_pts = pkt->pts;
+        const size_t bytes = static_cast<size_t>(pkt->size);
+        writer->push(std::move(pkt), keyframe, bytes);
     }
+}
+
+RTMPStreamer::EncodeStats RTMPStreamer::GetEncodeStats() const {
+    std::lock_guard<std::mutex> lock(encode_stats_mutex);
+    EncodeStats s = encode_stats;
+    if (s.frames) s.latency_ms_avg = latency_ms_total / s.frames;
+    return s;
+}
+
+std::vector<std::string> RTMPStreamer::AvailableEncoders() {
+    std::vector<std::string> names;
+    void* it = nullptr;
+    while (const AVCodec* codec = av_codec_iterate(&it)) {
+        if (codec->id == AV_CODEC_ID_H264 && av_codec_is_encoder(codec) &&
+            !(codec->capabilities & AV_CODEC_CAP_HARDWARE)) {
+            names.emplace_back(codec->name);
+        }
+    }
+    return names;
+}
 
-    // std::cout << "[RTMPStreamer] 推送完成一帧" << std::endl;
+void RTMPStreamer::Flush() {
+    if (flushed) return;
+    flushed = true;
+    // 取出编码器缓存的帧（帧线程模型下可能有多帧），包照常交给录像与写出线程
+    if (codec_ctx && writer && avcodec_send_frame(codec_ctx, nullptr) >= 0) {
+        ReceivePackets();
+    }
 }
 
 RTMPStreamer::~RTMPStreamer() {
+    // 调用方没有 Flush 时在这里排空编码器，再写完排队中的包和 trailer
+    Flush();
+    if (writer) writer->stop();
     if (output_ctx) {
         av_write_trailer(output_ctx);
         if (output_ctx && !(output_ctx->oformat->flags & AVFMT_NOFILE) && output_ctx->pb) {
@@ -228,7 +499,7 @@ RTMPStreamer::~RTMPStreamer() {
         avformat_free_context(output_ctx);
     }
     if (codec_ctx) avcodec_free_context(&codec_ctx);
-    if (frame) av_frame_free(&frame);
+    frame_pool.reset();
     if (sws_ctx) sws_freeContext(sws_ctx);
     avformat_network_deinit();
 }
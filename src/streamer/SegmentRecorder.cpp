@@ -0,0 +1,240 @@
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include "streamer/SegmentRecorder.hpp"
+
+SegmentRecorder::SegmentRecorder(const AVCodecParameters* params, AVRational tb,
+                                 RecorderConfig recorder_config)
+    : config(std::move(recorder_config)), time_base(tb) {
+    std::error_code ec;
+    std::filesystem::create_directories(config.output_dir, ec);
+    if (ec) {
+        throw std::runtime_error("无法创建录像目录 " + config.output_dir + ": " + ec.message());
+    }
+    codecpar = avcodec_parameters_alloc();
+    if (!codecpar || avcodec_parameters_copy(codecpar, params) < 0) {
+        avcodec_parameters_free(&codecpar);
+        throw std::runtime_error("复制编码参数失败");
+    }
+
+    const double tick = av_q2d(time_base);
+    pre_event_ticks = static_cast<int64_t>(config.pre_event_seconds / tick);
+    post_event_ticks = static_cast<int64_t>(config.post_event_seconds / tick);
+    segment_ticks = static_cast<int64_t>(config.segment_seconds / tick);
+    ring.set_options({pre_event_ticks, config.max_ring_bytes});
+
+    if (config.continuous) {
+        recording = true;
+        waiting_keyframe = true;
+        record_until = std::numeric_limits<int64_t>::max();
+    }
+
+    queue = std::make_unique<PacketWriter<AVPacketPtr>>(
+        [this](AVPacketPtr& pkt) { return HandlePacket(pkt); }, config.queue);
+}
+
+SegmentRecorder::~SegmentRecorder() {
+    Stop();
+    avcodec_parameters_free(&codecpar);
+}
+
+void SegmentRecorder::OnPacket(const AVPacket& pkt) {
+    // 只增加数据缓冲区的引用计数，与推流共享同一份码流
+    AVPacketPtr copy(av_packet_clone(&pkt));
+    if (!copy) return;
+    const bool keyframe = copy->flags & AV_PKT_FLAG_KEY;
+    const size_t bytes = static_cast<size_t>(copy->size);
+    queue->push(std::move(copy), keyframe, bytes);
+}
+
+void SegmentRecorder::Trigger() {
+    trigger_pending.store(true, std::memory_order_release);
+}
+
+void SegmentRecorder::Stop() {
+    if (queue) queue->stop();
+    // 录像线程已退出，可以安全地关闭文件
+    CloseSegment();
+}
+
+SegmentRecorder::Stats SegmentRecorder::GetStats() const {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        s = stats;
+    }
+    s.queue = queue->stats();
+    return s;
+}
+
+bool SegmentRecorder::HandlePacket(AVPacketPtr& pkt) {
+    const int64_t ts = pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+    const bool keyframe = pkt->flags & AV_PKT_FLAG_KEY;
+    const size_t bytes = static_cast<size_t>(pkt->size);
+    bool ok = true;
+
+    if (trigger_pending.exchange(false, std::memory_order_acq_rel)) {
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            ++stats.events;
+        }
+        if (!config.continuous) record_until = ts + post_event_ticks;
+        if (!recording) {
+            recording = true;
+            event_stamp.clear();
+            segment_index = 0;
+            if (ring.empty()) {
+                waiting_keyframe = true;
+            } else {
+                // 事件前的包：缓冲从关键帧开始，可以直接作为新文件的开头
+                waiting_keyframe = false;
+                ok = OpenSegment();
+                bool first = true;
+                ring.for_each([&](const auto& e) {
+                    if (first) segment_start = segment_cut = e.timestamp;
+                    first = false;
+                    if (segment_ctx) ok = WriteToSegment(*e.packet) && ok;
+                });
+            }
+        }
+    }
+
+    if (recording && ts > record_until) {
+        CloseSegment();
+        recording = false;
+    }
+
+    if (recording) {
+        if (waiting_keyframe && keyframe) {
+            waiting_keyframe = false;
+            ok = OpenSegment() && ok;
+            segment_start = segment_cut = ts;
+        } else if (keyframe && segment_ctx && config.format != RecordFormat::HLS &&
+                   ts - segment_cut >= segment_ticks) {
+            // HLS 由封装器自己按 hls_time 切分
+            CloseSegment();
+            ok = OpenSegment() && ok;
+            segment_start = segment_cut = ts;
+        }
+        if (segment_ctx) ok = WriteToSegment(*pkt) && ok;
+    }
+
+    ring.push(std::move(pkt), ts, keyframe, bytes);
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.ring_packets = ring.size();
+        stats.ring_bytes = ring.bytes();
+        stats.ring_seconds = ring.duration() * av_q2d(time_base);
+        stats.recording = recording;
+    }
+    return ok;
+}
+
+std::string SegmentRecorder::SegmentPath() const {
+    const char* ext = config.format == RecordFormat::HLS ? ".m3u8" : ".mp4";
+    char index[16];
+    std::snprintf(index, sizeof(index), "_%03d", segment_index);
+    return (std::filesystem::path(config.output_dir) /
+            (config.prefix + "_" + event_stamp + index + ext)).string();
+}
+
+bool SegmentRecorder::OpenSegment() {
+    CloseSegment();
+    if (event_stamp.empty()) {
+        char buf[32];
+        const std::time_t now = std::time(nullptr);
+        std::tm tm{};
+        localtime_r(&now, &tm);
+        std::strftime(buf, sizeof(buf), "%Y%m%d-%H%M%S", &tm);
+        event_stamp = buf;
+    }
+    const std::string path = SegmentPath();
+    ++segment_index;
+
+    const char* format_name = config.format == RecordFormat::HLS ? "hls" : "mp4";
+    if (avformat_alloc_output_context2(&segment_ctx, nullptr, format_name, path.c_str()) < 0) {
+        std::cerr << "[SegmentRecorder] 创建输出上下文失败: " << path << std::endl;
+        segment_ctx = nullptr;
+        return false;
+    }
+    AVStream* stream = avformat_new_stream(segment_ctx, nullptr);
+    if (!stream || avcodec_parameters_copy(stream->codecpar, codecpar) < 0) {
+        std::cerr << "[SegmentRecorder] 创建输出流失败" << std::endl;
+        avformat_free_context(segment_ctx);
+        segment_ctx = nullptr;
+        return false;
+    }
+    // FLV 的 codec_tag 对 MP4/TS 无效，交给封装器重新选择
+    stream->codecpar->codec_tag = 0;
+    stream->time_base = time_base;
+
+    AVDictionary* options = nullptr;
+    if (config.format == RecordFormat::FragmentedMP4) {
+        av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+    } else if (config.format == RecordFormat::HLS) {
+        const std::string ts_pattern =
+            (std::filesystem::path(config.output_dir) /
+             (config.prefix + "_" + event_stamp + "_%05d.ts")).string();
+        av_dict_set(&options, "hls_time", std::to_string(config.segment_seconds).c_str(), 0);
+        av_dict_set(&options, "hls_list_size", "0", 0);
+        av_dict_set(&options, "hls_playlist_type", "event", 0);
+        av_dict_set(&options, "hls_segment_filename", ts_pattern.c_str(), 0);
+    }
+
+    if (!(segment_ctx->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&segment_ctx->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+        std::cerr << "[SegmentRecorder] 无法打开文件: " << path << std::endl;
+        av_dict_free(&options);
+        avformat_free_context(segment_ctx);
+        segment_ctx = nullptr;
+        return false;
+    }
+    const int ret = avformat_write_header(segment_ctx, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char errbuf[256];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        std::cerr << "[SegmentRecorder] 写入头部失败: " << errbuf << std::endl;
+        if (!(segment_ctx->oformat->flags & AVFMT_NOFILE)) avio_closep(&segment_ctx->pb);
+        avformat_free_context(segment_ctx);
+        segment_ctx = nullptr;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    ++stats.segments;
+    return true;
+}
+
+void SegmentRecorder::CloseSegment() {
+    if (!segment_ctx) return;
+    av_write_trailer(segment_ctx);
+    if (!(segment_ctx->oformat->flags & AVFMT_NOFILE)) avio_closep(&segment_ctx->pb);
+    avformat_free_context(segment_ctx);
+    segment_ctx = nullptr;
+}
+
+bool SegmentRecorder::WriteToSegment(const AVPacket& src) {
+    // 缓冲中的包之后还可能被下一次事件使用，这里写出一份引用
+    AVPacketPtr pkt(av_packet_clone(&src));
+    if (!pkt) return false;
+    AVStream* stream = segment_ctx->streams[0];
+    pkt->stream_index = 0;
+    if (pkt->pts != AV_NOPTS_VALUE) pkt->pts -= segment_start;
+    if (pkt->dts != AV_NOPTS_VALUE) pkt->dts -= segment_start;
+    av_packet_rescale_ts(pkt.get(), time_base, stream->time_base);
+
+    const size_t bytes = static_cast<size_t>(pkt->size);
+    const int ret = av_write_frame(segment_ctx, pkt.get());
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    if (ret < 0) {
+        ++stats.write_errors;
+        return false;
+    }
+    ++stats.packets_written;
+    stats.bytes_written += bytes;
+    return true;
+}
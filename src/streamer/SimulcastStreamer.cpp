@@ -0,0 +1,245 @@
+#include "streamer/SimulcastStreamer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+SwsContext* make_scaler(int src_w, int src_h, int dst_w, int dst_h) {
+    // 逐级缩小比例不超过 2:1 左右，双线性足够；SWS_AREA 在大比例下更好但更慢
+    SwsContext* ctx = sws_getContext(src_w, src_h, AV_PIX_FMT_YUV420P, dst_w, dst_h,
+                                     AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr,
+                                     nullptr, nullptr);
+    if (!ctx) throw std::runtime_error("初始化缩放器失败");
+    return ctx;
+}
+
+uint64_t elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+SimulcastStreamer::SimulcastStreamer(int src_w, int src_h, int fps,
+                                     std::vector<Rendition> ladder)
+    : src_width(src_w), src_height(src_h),
+      source_pool(src_w, src_h, AV_PIX_FMT_YUV420P, 32) {
+    ValidateLadder(src_w, src_h, ladder);
+
+    sws_rgb = sws_getContext(src_w, src_h, AV_PIX_FMT_RGB24, src_w, src_h,
+                             AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!sws_rgb) throw std::runtime_error("初始化颜色转换器失败");
+    if (ladder[0].width != src_w || ladder[0].height != src_h) {
+        sws_from_source = make_scaler(src_w, src_h, ladder[0].width, ladder[0].height);
+    }
+    for (size_t i = 0; i < ladder.size(); ++i) {
+        auto rung = std::make_unique<Rung>();
+        rung->config = ladder[i];
+        rung->streamer = std::make_unique<RTMPStreamer>(
+            ladder[i].width, ladder[i].height, fps, ladder[i].url.c_str(), ladder[i].encoder);
+        if (i + 1 < ladder.size()) {
+            rung->sws_to_next = make_scaler(ladder[i].width, ladder[i].height,
+                                            ladder[i + 1].width, ladder[i + 1].height);
+        }
+        std::cout << "[SimulcastStreamer] " << ladder[i].name << " " << ladder[i].width
+                  << "x" << ladder[i].height << " @ " << ladder[i].encoder.bit_rate / 1000
+                  << " kbit/s, GOP " << ladder[i].encoder.gop_size << " → " << ladder[i].url
+                  << std::endl;
+        rungs.push_back(std::move(rung));
+    }
+    // 全部初始化成功后再启动线程，构造失败时不需要回收线程
+    for (size_t i = 0; i < rungs.size(); ++i) {
+        rungs[i]->thread = std::thread([this, i] { RunRung(i); });
+    }
+}
+
+void SimulcastStreamer::ValidateLadder(int src_w, int src_h,
+                                       const std::vector<Rendition>& ladder) {
+    if (ladder.empty()) throw std::runtime_error("SimulcastStreamer: 输出阶梯为空");
+    int min_gop = ladder[0].encoder.gop_size;
+    for (const auto& r : ladder) min_gop = std::min(min_gop, r.encoder.gop_size);
+    int prev_w = src_w, prev_h = src_h;
+    for (const auto& r : ladder) {
+        if (r.width <= 0 || r.height <= 0 || (r.width | r.height) & 1) {
+            throw std::runtime_error("SimulcastStreamer: " + r.name + " 分辨率必须为正偶数");
+        }
+        if (r.width > prev_w || r.height > prev_h) {
+            throw std::runtime_error("SimulcastStreamer: " + r.name +
+                                     " 高于上一级，阶梯必须从高到低排列");
+        }
+        if (min_gop <= 0 || r.encoder.gop_size % min_gop != 0) {
+            throw std::runtime_error("SimulcastStreamer: " + r.name +
+                                     " 的 gop_size 不是最小 GOP 的整数倍，关键帧无法对齐");
+        }
+        prev_w = r.width;
+        prev_h = r.height;
+    }
+}
+
+SimulcastStreamer::~SimulcastStreamer() {
+    Stop();
+    for (auto& rung : rungs) {
+        if (rung->sws_to_next) sws_freeContext(rung->sws_to_next);
+    }
+    if (sws_from_source) sws_freeContext(sws_from_source);
+    if (sws_rgb) sws_freeContext(sws_rgb);
+}
+
+AVFramePtr SimulcastStreamer::ConvertFrame(const cv::Mat& rgbFrame) {
+    AVFramePtr frame = source_pool.acquire();
+    if (!frame) {
+        std::cerr << "[SimulcastStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
+    const uint8_t* srcData[1] = { rgbFrame.data };
+    const int srcLinesize[1] = { static_cast<int>(rgbFrame.step) };
+    sws_scale(sws_rgb, srcData, srcLinesize, 0, src_height, frame->data, frame->linesize);
+    return frame;
+}
+
+AVFramePtr SimulcastStreamer::ConvertFromYUYV(const uint8_t* yuyv, int stride) {
+    AVFramePtr frame = source_pool.acquire();
+    if (!frame || !yuyv) {
+        std::cerr << "[SimulcastStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
+    yuyv_to_yuv420p(yuyv, stride, src_width, src_height, yuv420p_planes(frame.get()));
+    return frame;
+}
+
+AVFramePtr SimulcastStreamer::ConvertFromMJPEG(JpegDecoder& decoder, const uint8_t* jpeg,
+                                               size_t size) {
+    AVFramePtr frame = source_pool.acquire();
+    if (!frame || !jpeg) {
+        std::cerr << "[SimulcastStreamer] 从帧池获取 AVFrame 失败" << std::endl;
+        return nullptr;
+    }
+    if (!decoder.decode_yuv420p(jpeg, size, yuv420p_planes(frame.get()), src_width,
+                                src_height)) {
+        return nullptr;
+    }
+    return frame;
+}
+
+void SimulcastStreamer::PushFrame(AVFramePtr frame, int64_t capture_ns) {
+    if (!frame || stopped) return;
+    const uint64_t source_index = next_source_index++;
+    if (sws_from_source) {
+        AVFramePtr scaled = rungs[0]->streamer->AcquireFrame();
+        if (scaled) {
+            sws_scale(sws_from_source, frame->data, frame->linesize, 0, src_height,
+                      scaled->data, scaled->linesize);
+        }
+        // 帧池耗尽时以重复帧下发，源帧序号不出现空洞
+        frame = std::move(scaled);
+    }
+    rungs[0]->input.push({std::move(frame), capture_ns, source_index});
+}
+
+void SimulcastStreamer::RepeatFrame(int64_t capture_ns) {
+    if (stopped) return;
+    rungs[0]->input.push({nullptr, capture_ns, next_source_index++});
+}
+
+void SimulcastStreamer::RunRung(size_t index) {
+    Rung& rung = *rungs[index];
+    Rung* next = index + 1 < rungs.size() ? rungs[index + 1].get() : nullptr;
+    KeyframeSchedule keyframes(rung.config.encoder.gop_size);
+    TimedFrame item;
+    while (rung.input.pop(item)) {
+        AVFramePtr& frame = item.frame;
+        // 所有级别收到相同的源帧序号，按它而不是本级已编码帧数强制关键帧
+        const bool force_keyframe = keyframes.next(item.source_index, frame != nullptr);
+        if (!frame) {
+            if (next) next->input.push({nullptr, item.capture_ns, item.source_index});
+            if (rung.streamer->RepeatFrame(item.capture_ns)) ++rung.repeated;
+            continue;
+        }
+        // 先为下一级缩放，让下一级的编码与本级编码并行
+        if (next) {
+            const auto start = std::chrono::steady_clock::now();
+            AVFramePtr scaled = next->streamer->AcquireFrame();
+            if (scaled) {
+                sws_scale(rung.sws_to_next, frame->data, frame->linesize, 0,
+                          rung.config.height, scaled->data, scaled->linesize);
+            }
+            // 计时不含入队：下一级跟不上时 push 会阻塞，那是下一级的背压而不是缩放耗时
+            rung.scale_us += elapsed_us(start);
+            // 帧池耗尽时 scaled 为空，下一级按重复帧处理，源帧序号仍然连续
+            next->input.push({std::move(scaled), item.capture_ns, item.source_index});
+        }
+        if (force_keyframe) frame->pict_type = AV_PICTURE_TYPE_I;
+        const auto start = std::chrono::steady_clock::now();
+        rung.streamer->EncodeFrame(std::move(frame), item.capture_ns);
+        rung.encode_us += elapsed_us(start);
+        ++rung.frames;
+    }
+    // 输入已关闭：排空本级编码器，Stop() 返回时延迟帧的包已交给 recorder
+    rung.streamer->Flush();
+    if (next) next->input.close();
+}
+
+void SimulcastStreamer::Stop() {
+    if (stopped) return;
+    stopped = true;
+    // 关闭第一级，各级处理完剩余帧后依次关闭下一级
+    rungs[0]->input.close();
+    for (auto& rung : rungs) {
+        if (rung->thread.joinable()) rung->thread.join();
+    }
+}
+
+std::vector<SimulcastStreamer::RungStats> SimulcastStreamer::GetStats() const {
+    std::vector<RungStats> result;
+    for (const auto& rung : rungs) {
+        RungStats s;
+        s.name = rung->config.name;
+        s.width = rung->config.width;
+        s.height = rung->config.height;
+        s.frames = rung->frames.load();
+        s.repeated = rung->repeated.load();
+        if (s.frames) {
+            s.scale_ms_avg = rung->scale_us.load() / 1000.0 / s.frames;
+            s.encode_ms_avg = rung->encode_us.load() / 1000.0 / s.frames;
+        }
+        s.queue_depth = rung->input.size();
+        s.writer = rung->streamer->GetWriterStats();
+        s.capture_latency = rung->streamer->GetCaptureLatency();
+        result.push_back(std::move(s));
+    }
+    return result;
+}
+
+std::vector<Rendition> SimulcastStreamer::DefaultLadder(const std::string& url_prefix,
+                                                        int src_width, int src_height) {
+    struct Preset { const char* name; int height; int64_t bit_rate; };
+    const Preset presets[] = {{"1080p", 1080, 4500000},
+                              {"720p", 720, 2500000},
+                              {"360p", 360, 800000}};
+    std::vector<Rendition> ladder;
+    for (const auto& p : presets) {
+        if (p.height > src_height) continue;
+        Rendition r;
+        r.name = p.name;
+        r.height = p.height;
+        // 按源宽高比计算宽度，取偶数
+        r.width = static_cast<int>(static_cast<int64_t>(src_width) * p.height / src_height) & ~1;
+        r.encoder.bit_rate = p.bit_rate;
+        r.encoder.gop_size = 60;
+        r.url = url_prefix + "_" + p.name;
+        ladder.push_back(std::move(r));
+    }
+    if (ladder.empty()) {
+        // 源分辨率低于所有预设：只输出源分辨率一路
+        Rendition r;
+        r.name = "source";
+        r.width = src_width & ~1;
+        r.height = src_height & ~1;
+        r.url = url_prefix;
+        ladder.push_back(std::move(r));
+    }
+    return ladder;
+}
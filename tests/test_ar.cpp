@@ -5,21 +5,21 @@
 #include <opencv2/core/utils/logger.hpp>
 #include <string>
 
-#include "vision/OpenCVProcessor.hpp"
-#include "vision/V4L2Capture.hpp"
+#include "capture/SyntheticSource.hpp"
+#include "processor/OpenCVProcessor.hpp"
 
+// 使用合成帧源，不需要摄像头，可在构建机上运行
 class ARTest : public ::testing::Test {
    protected:
-    const std::string TEST_DEVICE = "/dev/video0";
-
-    const std::string TEST_OUTPUT_PATH =
-        "/home/lzk/Desktop/MiniCommStack/output";
+    const std::string TEST_OUTPUT_PATH = ::testing::TempDir() + "vision_ar_output";
     const OpenCVProcessor::PixelFormat TEST_FMT =
         OpenCVProcessor::PixelFormat::YUYV;
 
     void SetUp() override {
-        capture = new V4L2Capture(TEST_DEVICE);
-        ASSERT_TRUE(capture->initialize());
+        FrameSourceOptions options;
+        options.pacing = Pacing::Unpaced;
+        capture = new SyntheticSource(options);
+        ASSERT_TRUE(capture->initialize(640, 480));
         processor = new OpenCVProcessor(TEST_FMT, capture->get_width(),
                                         capture->get_height());
     }
@@ -28,7 +28,7 @@ class ARTest : public ::testing::Test {
         delete capture;
         delete processor;
     }
-    V4L2Capture* capture;
+    FrameSource* capture;
     OpenCVProcessor* processor;
 };
 TEST_F(ARTest, ProcessFrame) {
@@ -44,12 +44,53 @@ TEST_F(ARTest, ProcessFrame) {
             processor->apply_algorithm(RGBFrame);
             std::string path =
                 processor->process_and_save(TEST_OUTPUT_PATH, RGBFrame);
-            // std::cout << "第" << i << "个图片保存的路径为:" << path <<
-            // std::endl;
+            EXPECT_FALSE(path.empty()) << "第 " << i << " 帧保存失败";
         } catch (const cv::Exception& e) {
             FAIL() << "OpenCV 异常: " << e.what();
         } catch (const std::exception& e) {
             FAIL() << "标准异常: " << e.what();
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_F(ARTest, ReducedResolutionKeepsPlanes) {
+    // 降级处理：算法在 1/2 尺寸上运行，结果原地写回原尺寸的 Y 平面
+    cv::Mat y(480, 640, CV_8UC1, cv::Scalar(40));
+    y(cv::Rect(200, 150, 160, 120)).setTo(cv::Scalar(220));
+    cv::Mat u(240, 320, CV_8UC1, cv::Scalar(90));
+    cv::Mat v(240, 320, CV_8UC1, cv::Scalar(160));
+    const uint8_t* data = y.data;
+    processor->set_pyramid_level(1);
+    EXPECT_EQ(processor->pyramid_level(), 1);
+    processor->apply_algorithm_luma(y, u, v);
+    EXPECT_EQ(y.data, data);
+    EXPECT_EQ(y.size(), cv::Size(640, 480));
+    EXPECT_GT(cv::countNonZero(y), 0);                  // 方块边缘
+    EXPECT_EQ(y.at<uint8_t>(240, 320), 0);              // 方块内部没有边缘
+    EXPECT_EQ(cv::countNonZero(u != 128), 0);
+    EXPECT_EQ(cv::countNonZero(v != 128), 0);
+
+    processor->set_pyramid_level(7);
+    EXPECT_EQ(processor->pyramid_level(), 3);
+}
+
+TEST_F(ARTest, NoneChainPassesThrough) {
+    // "none" 链不改变画面：RGB 保留颜色，YUV 保留色度，降级时也一样
+    ASSERT_TRUE(processor->set_algorithm("none"));
+    cv::Mat rgb(480, 640, CV_8UC3, cv::Scalar(200, 30, 90));
+    cv::Mat y(480, 640, CV_8UC1, cv::Scalar(120));
+    cv::Mat u(240, 320, CV_8UC1, cv::Scalar(90));
+    cv::Mat v(240, 320, CV_8UC1, cv::Scalar(160));
+    for (int level : {0, 1}) {
+        processor->set_pyramid_level(level);
+        processor->apply_algorithm(rgb);
+        processor->apply_algorithm_luma(y, u, v);
+        cv::Mat diff;
+        cv::absdiff(rgb, cv::Scalar(200, 30, 90), diff);
+        const cv::Scalar total = cv::sum(diff);
+        EXPECT_EQ(total[0] + total[1] + total[2], 0.0);
+        EXPECT_EQ(cv::countNonZero(y != 120), 0);
+        EXPECT_EQ(cv::countNonZero(u != 90), 0);
+        EXPECT_EQ(cv::countNonZero(v != 160), 0);
+    }
+}
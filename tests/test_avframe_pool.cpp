@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+
+#include "streamer/AVFramePool.hpp"
+
+TEST(AVFramePoolTest, ReleasedBufferIsReused) {
+    AVFramePool pool(640, 480, AV_PIX_FMT_YUV420P);
+    AVFramePtr first = pool.acquire();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->width, 640);
+    EXPECT_EQ(first->height, 480);
+    EXPECT_EQ(first->format, AV_PIX_FMT_YUV420P);
+    EXPECT_TRUE(av_frame_is_writable(first.get()));
+    const uint8_t* data = first->buf[0]->data;
+
+    first.reset();
+    // 缓冲区回到池中，下一帧拿到同一块
+    AVFramePtr second = pool.acquire();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->buf[0]->data, data);
+    EXPECT_EQ(second->data[0], data);
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+
+    // 仍被持有时只能新分配
+    AVFramePtr third = pool.acquire();
+    ASSERT_TRUE(third);
+    EXPECT_NE(third->buf[0]->data, data);
+    stats = pool.stats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.hits, 1u);
+}
+
+TEST(AVFramePoolTest, ExtraReferenceKeepsBufferOut) {
+    AVFramePool pool(320, 240, AV_PIX_FMT_YUV420P);
+    AVFramePtr frame = pool.acquire();
+    ASSERT_TRUE(frame);
+    const uint8_t* data = frame->buf[0]->data;
+    // 模拟编码器持有的引用：帧本身释放后缓冲区仍不可复用
+    AVFramePtr ref(av_frame_clone(frame.get()));
+    ASSERT_TRUE(ref);
+    frame.reset();
+    AVFramePtr other = pool.acquire();
+    ASSERT_TRUE(other);
+    EXPECT_NE(other->buf[0]->data, data);
+    ref.reset();
+    other.reset();
+    // 两块都已归还，下一帧命中其中之一
+    AVFramePtr again = pool.acquire();
+    ASSERT_TRUE(again);
+    EXPECT_EQ(pool.stats().misses, 2u);
+    EXPECT_EQ(pool.stats().hits, 1u);
+}
+
+TEST(AVFramePoolTest, FramesOutliveThePool) {
+    auto pool = std::make_unique<AVFramePool>(320, 240, AV_PIX_FMT_YUV420P);
+    AVFramePtr frame = pool->acquire();
+    ASSERT_TRUE(frame);
+    pool.reset();
+    // 池析构后帧仍然有效，可正常写入；最后释放时才真正回收缓冲区
+    Yuv420pPlanes planes = yuv420p_planes(frame.get());
+    std::memset(planes.y, 16, static_cast<size_t>(planes.y_stride) * 240);
+    std::memset(planes.u, 128, static_cast<size_t>(planes.u_stride) * 120);
+    std::memset(planes.v, 128, static_cast<size_t>(planes.v_stride) * 120);
+    EXPECT_EQ(planes.y[planes.y_stride * 239 + 319], 16);
+    frame.reset();
+}
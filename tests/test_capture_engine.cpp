@@ -0,0 +1,112 @@
+#include "capture/CaptureEngine.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+// 查找所有 vivid 采集节点（modprobe vivid n_devs=2 可得到两个）
+std::vector<std::string> find_vivid_devices() {
+    std::vector<std::string> devices;
+    for (int i = 0; i < 64; ++i) {
+        std::string path = "/dev/video" + std::to_string(i);
+        int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd < 0) continue;
+        v4l2_capability cap{};
+        bool is_vivid = ioctl(fd, VIDIOC_QUERYCAP, &cap) == 0 &&
+                        std::strcmp(reinterpret_cast<const char*>(cap.driver), "vivid") == 0 &&
+                        (cap.device_caps & V4L2_CAP_VIDEO_CAPTURE);
+        close(fd);
+        if (is_vivid) devices.push_back(path);
+    }
+    return devices;
+}
+}  // namespace
+
+TEST(CaptureEngineTest, DispatchesFramesToEachCamera) {
+    const auto devices = find_vivid_devices();
+    if (devices.empty()) {
+        GTEST_SKIP() << "未找到 vivid 虚拟设备，请先 modprobe vivid n_devs=2";
+    }
+    // 有两个节点时验证多摄像头共享一个事件循环
+    const size_t count = devices.size() >= 2 ? 2 : 1;
+    std::vector<std::unique_ptr<V4L2Capture>> captures;
+    std::atomic<uint64_t> delivered[2] = {{0}, {0}};
+    std::atomic<int> misrouted{0};
+
+    CaptureEngine engine(1);
+    for (size_t i = 0; i < count; ++i) {
+        captures.push_back(std::make_unique<V4L2Capture>(devices[i]));
+        ASSERT_TRUE(captures[i]->initialize(640, 480));
+        const int expected = static_cast<int>(i);
+        const int id = engine.add_camera(*captures[i], [&, expected](int camera_id, FrameLease frame) {
+            if (camera_id != expected || !frame || frame->bytesused == 0) {
+                misrouted.fetch_add(1);
+                return;
+            }
+            delivered[camera_id].fetch_add(1);
+        });
+        EXPECT_EQ(id, expected);
+    }
+    ASSERT_EQ(engine.camera_count(), count);
+    ASSERT_TRUE(engine.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_TRUE(engine.is_alive(static_cast<int>(i)));
+    }
+    engine.stop();
+
+    EXPECT_EQ(misrouted.load(), 0);
+    for (size_t i = 0; i < count; ++i) {
+        const auto stats = engine.get_stats(static_cast<int>(i));
+        EXPECT_GT(delivered[i].load(), 0u) << "摄像头 " << i << " 没有收到帧";
+        EXPECT_EQ(stats.frames, delivered[i].load());
+        EXPECT_EQ(stats.errors, 0u);
+        EXPECT_GT(stats.fps, 0.0);
+    }
+}
+
+TEST(CaptureEngineTest, CountsDriverDropsWhileBuffersAreHeld) {
+    const auto devices = find_vivid_devices();
+    if (devices.empty()) {
+        GTEST_SKIP() << "未找到 vivid 虚拟设备，请先 modprobe vivid";
+    }
+    V4L2Capture capture(devices[0]);
+    capture.set_buffer_count(4);
+    ASSERT_TRUE(capture.initialize(640, 480));
+
+    // 回调扣住所有租约，驱动没有空闲缓冲区，只能丢帧并让 sequence 跳号
+    std::mutex mutex;
+    std::vector<FrameLease> held;
+    std::atomic<bool> holding{true};
+    CaptureEngine engine(1);
+    const int id = engine.add_camera(capture, [&](int, FrameLease frame) {
+        if (!holding.load()) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        held.push_back(std::move(frame));
+    });
+    ASSERT_TRUE(engine.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    {
+        // 在测试线程归还缓冲区，驱动恢复出帧
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(held.size(), capture.get_buffer_count());
+        holding = false;
+        held.clear();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    engine.stop();
+
+    const auto stats = engine.get_stats(id);
+    EXPECT_GT(stats.frames, capture.get_buffer_count());
+    EXPECT_GT(stats.driver_drops, 0u);
+    EXPECT_TRUE(engine.is_alive(id));
+}
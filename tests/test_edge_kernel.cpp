@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "processor/EdgeKernel.hpp"
+#include "processor/TileScheduler.hpp"
+
+namespace {
+// 灰度背景上一个亮方块
+std::vector<uint8_t> make_square(int w, int h, int x0, int y0, int size) {
+    std::vector<uint8_t> img(static_cast<size_t>(w) * h, 30);
+    for (int y = y0; y < y0 + size; ++y) {
+        for (int x = x0; x < x0 + size; ++x) img[y * w + x] = 220;
+    }
+    return img;
+}
+}  // namespace
+
+TEST(EdgeKernelTest, FindsSquareOutline) {
+    const int w = 64, h = 48;
+    auto luma = make_square(w, h, 20, 10, 20);
+    std::vector<uint8_t> edges(luma.size());
+    EdgeKernel kernel;
+    kernel.detect(luma.data(), w, 1, w, h, edges.data(), w);
+
+    // 方块内部和远处背景没有边缘，边界附近有边缘
+    EXPECT_EQ(edges[20 * w + 30], 0);
+    EXPECT_EQ(edges[2 * w + 2], 0);
+    int edge_pixels = 0;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (edges[y * w + x] == 0) continue;
+            EXPECT_EQ(edges[y * w + x], 255);
+            ++edge_pixels;
+            bool near_border = (x >= 18 && x <= 41 && y >= 8 && y <= 31) &&
+                               !(x >= 22 && x <= 37 && y >= 12 && y <= 27);
+            EXPECT_TRUE(near_border) << "意外的边缘点 (" << x << ", " << y << ")";
+        }
+    }
+    EXPECT_GE(edge_pixels, 4 * 18);
+}
+
+// 从 YUYV（步长 2）读取亮度、以及原地写回 Y 平面，结果都必须与独立灰度输入一致
+TEST(EdgeKernelTest, YuyvAndInPlaceMatchPlanarInput) {
+    const int w = 96, h = 40;
+    std::mt19937 rng(7);
+    auto luma = make_square(w, h, 30, 8, 24);
+    for (auto& p : luma) p = static_cast<uint8_t>(p + rng() % 24);
+
+    std::vector<uint8_t> yuyv(luma.size() * 2);
+    for (size_t i = 0; i < luma.size(); ++i) {
+        yuyv[2 * i] = luma[i];
+        yuyv[2 * i + 1] = static_cast<uint8_t>(rng());
+    }
+
+    EdgeKernel kernel;
+    std::vector<uint8_t> planar(luma.size()), from_yuyv(luma.size());
+    kernel.detect(luma.data(), w, 1, w, h, planar.data(), w);
+    kernel.detect(yuyv.data(), w * 2, 2, w, h, from_yuyv.data(), w);
+    EXPECT_EQ(planar, from_yuyv);
+
+    std::vector<uint8_t> in_place = luma;
+    kernel.detect(in_place.data(), w, 1, w, h, in_place.data(), w);
+    EXPECT_EQ(planar, in_place);
+}
+
+// 分块执行必须与整帧执行逐字节一致（包括跨条带的滞后连接和奇数高度）
+TEST(EdgeKernelTest, TiledMatchesFullFrame) {
+    std::mt19937 rng(11);
+    for (auto [w, h] : {std::pair{160, 90}, std::pair{97, 61}, std::pair{32, 3}}) {
+        std::vector<uint8_t> luma(static_cast<size_t>(w) * h);
+        // 斜向渐变叠加噪声，产生大量跨越条带边界的弱边缘链
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                luma[y * w + x] = static_cast<uint8_t>(((x * 3 + y * 5) & 0xFF) ^ (rng() % 64));
+            }
+        }
+        EdgeKernel reference;
+        std::vector<uint8_t> expected(luma.size());
+        reference.detect(luma.data(), w, 1, w, h, expected.data(), w);
+
+        for (unsigned threads : {2u, 3u, 8u}) {
+            TileScheduler scheduler(threads);
+            EdgeKernel kernel;
+            std::vector<uint8_t> tiled(luma.size());
+            kernel.detect(luma.data(), w, 1, w, h, tiled.data(), w, &scheduler);
+            EXPECT_EQ(expected, tiled) << w << "x" << h << " threads " << threads;
+
+            std::vector<uint8_t> in_place = luma;
+            kernel.detect(in_place.data(), w, 1, w, h, in_place.data(), w, &scheduler);
+            EXPECT_EQ(expected, in_place) << w << "x" << h << " threads " << threads;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "processor/FilterChain.hpp"
+
+namespace {
+std::vector<uint8_t> make_noise(int w, int h, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> img(static_cast<size_t>(w) * h);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            img[y * w + x] = static_cast<uint8_t>((x * 2 + y) + rng() % 48);
+        }
+    }
+    return img;
+}
+
+LumaPlane plane_of(std::vector<uint8_t>& img, int w, int h) {
+    return {img.data(), w, w, h};
+}
+}  // namespace
+
+// 融合后的一次遍历与逐个算子分别遍历结果一致
+TEST(FilterChainTest, FusedMatchesSequentialPasses) {
+    const int w = 64, h = 32;
+    auto fused_img = make_noise(w, h, 1);
+    auto separate_img = fused_img;
+
+    FilterChain fused;
+    fused.then(fuse(Contrast(1.4f, -30), Gamma(0.7f), Posterize(5), Invert()));
+    FilterChain separate;
+    separate.then(fuse(Contrast(1.4f, -30)))
+        .then(fuse(Gamma(0.7f)))
+        .then(fuse(Posterize(5)))
+        .then(fuse(Invert()));
+
+    fused.apply(plane_of(fused_img, w, h));
+    separate.apply(plane_of(separate_img, w, h));
+    EXPECT_EQ(fused_img, separate_img);
+    EXPECT_EQ(fused.stage_count(), 1u);
+    EXPECT_EQ(fused.describe(), "[contrast+gamma+posterize+invert]");
+}
+
+// 所有内置链在分块执行时与整帧执行逐字节一致
+TEST(FilterChainTest, NamedChainsTiledMatchFullFrame) {
+    const int w = 120, h = 67;
+    TileScheduler scheduler(3);
+    for (const auto& name : FilterChain::names()) {
+        auto full = FilterChain::create(name);
+        auto tiled = FilterChain::create(name);
+        ASSERT_TRUE(full && tiled) << name;
+        auto a = make_noise(w, h, 5);
+        auto b = a;
+        full->apply(plane_of(a, w, h));
+        tiled->apply(plane_of(b, w, h), &scheduler);
+        EXPECT_EQ(a, b) << name;
+    }
+}
+
+TEST(FilterChainTest, RegistryAndColorMap) {
+    EXPECT_EQ(FilterChain::create("no-such-chain"), nullptr);
+    auto names = FilterChain::names();
+    EXPECT_NE(std::find(names.begin(), names.end(), "canny"), names.end());
+
+    FilterChain::register_chain("test-threshold", [] {
+        auto chain = std::make_unique<FilterChain>();
+        chain->then(fuse(Threshold(100))).set_color_map(ColorMap::heat());
+        return chain;
+    });
+    auto chain = FilterChain::create("test-threshold");
+    ASSERT_NE(chain, nullptr);
+    EXPECT_TRUE(chain->has_color_map());
+
+    std::vector<uint8_t> img = {0, 99, 101, 255};
+    LumaPlane plane = plane_of(img, 4, 1);
+    chain->apply(plane);
+    EXPECT_EQ(img, (std::vector<uint8_t>{0, 0, 255, 255}));
+
+    std::vector<uint8_t> rgb(12);
+    chain->expand_rgb(plane, rgb.data(), 12);
+    EXPECT_EQ(rgb[0], 0);                                   // 黑
+    EXPECT_EQ(rgb[6], 255); EXPECT_EQ(rgb[8], 255);         // 白
+}
+
+// 高斯阶段保持常数图像不变
+TEST(FilterChainTest, GaussianKeepsFlatImage) {
+    const int w = 17, h = 9;
+    std::vector<uint8_t> img(w * h, 77);
+    FilterChain chain;
+    chain.then(std::make_unique<GaussianStage>());
+    chain.apply(plane_of(img, w, h));
+    EXPECT_TRUE(std::all_of(img.begin(), img.end(), [](uint8_t v) { return v == 77; }));
+}
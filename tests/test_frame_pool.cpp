@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/core.hpp>
+
+#include "processor/FramePool.hpp"
+
+TEST(FramePoolTest, ReleasedBlockIsReused) {
+    FramePool pool;
+    cv::Mat first = pool.acquire(480, 640, CV_8UC3);
+    ASSERT_FALSE(first.empty());
+    const uchar* data = first.data;
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.outstanding, 1u);
+    EXPECT_EQ(stats.cached_bytes, 0u);
+
+    first.release();
+    stats = pool.stats();
+    EXPECT_EQ(stats.outstanding, 0u);
+    EXPECT_EQ(stats.cached_bytes, 640u * 480u * 3u);
+
+    // 同样大小的下一帧直接拿回刚释放的块
+    cv::Mat second = pool.acquire(480, 640, CV_8UC3);
+    EXPECT_EQ(second.data, data);
+    stats = pool.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.outstanding, 1u);
+    EXPECT_EQ(stats.cached_bytes, 0u);
+
+    // 大小不同的帧不能复用
+    cv::Mat gray = pool.acquire(480, 640, CV_8UC1);
+    EXPECT_NE(gray.data, data);
+    EXPECT_EQ(pool.stats().misses, 2u);
+}
+
+TEST(FramePoolTest, BlockReturnsWhenLastMatReleases) {
+    FramePool pool;
+    cv::Mat frame = pool.acquire(120, 160, CV_8UC3);
+    cv::Mat copy = frame;                      // 共享同一块内存
+    cv::Mat roi = frame(cv::Rect(0, 0, 80, 60));
+    frame.release();
+    copy.release();
+    EXPECT_EQ(pool.stats().outstanding, 1u);
+    roi.release();
+    EXPECT_EQ(pool.stats().outstanding, 0u);
+    EXPECT_GT(pool.stats().cached_bytes, 0u);
+
+    // adopt() 之后 create() 同样从池中取内存
+    cv::Mat adopted;
+    pool.adopt(adopted);
+    adopted.create(120, 160, CV_8UC3);
+    EXPECT_EQ(pool.stats().hits, 1u);
+}
+
+TEST(FramePoolTest, CachesAtMostLimitPerSizeAndTrims) {
+    FramePool pool(1);
+    cv::Mat a = pool.acquire(100, 100, CV_8UC1);
+    cv::Mat b = pool.acquire(100, 100, CV_8UC1);
+    a.release();
+    b.release();
+    // 只缓存一块，另一块直接释放
+    EXPECT_EQ(pool.stats().cached_bytes, 100u * 100u);
+    pool.trim();
+    EXPECT_EQ(pool.stats().cached_bytes, 0u);
+    cv::Mat c = pool.acquire(100, 100, CV_8UC1);
+    EXPECT_EQ(pool.stats().misses, 3u);
+}
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture/FrameSource.hpp"
+#include "capture/ReplaySource.hpp"
+#include "capture/SyntheticSource.hpp"
+
+namespace {
+constexpr unsigned kWidth = 64;
+constexpr unsigned kHeight = 48;
+constexpr size_t kFrameBytes = kWidth * kHeight * 2;
+
+FrameSourceOptions unpaced(uint64_t frame_limit = 0) {
+    FrameSourceOptions options;
+    options.pacing = Pacing::Unpaced;
+    options.frame_limit = frame_limit;
+    return options;
+}
+
+FrameSourceOptions paced(Pacing pacing, double fps) {
+    FrameSourceOptions options;
+    options.pacing = pacing;
+    options.fps = fps;
+    return options;
+}
+
+std::vector<uint8_t> lease_bytes(const FrameLease& frame) {
+    return std::vector<uint8_t>(frame->data, frame->data + frame->bytesused);
+}
+
+// 一个最小的“JPEG”：SOI + SOF0（只含尺寸）+ 负载 + EOI。
+// 负载中故意放一个后面不跟 SOI 的 FF D9，不能被当作帧结尾
+std::vector<uint8_t> fake_jpeg(unsigned width, unsigned height, uint8_t fill) {
+    std::vector<uint8_t> jpeg = {0xFF, 0xD8, 0xFF, 0xC0, 0x00, 0x0B, 0x08,
+                                 static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height),
+                                 static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width),
+                                 0x01, 0x01, 0x11, 0x00};
+    jpeg.insert(jpeg.end(), 16, fill);
+    jpeg.insert(jpeg.end(), {0xFF, 0xD9, 0x12, 0x34});
+    jpeg.insert(jpeg.end(), {0xFF, 0xD9});
+    return jpeg;
+}
+
+std::string write_temp(const std::string& name, const std::vector<uint8_t>& bytes) {
+    const std::string path = ::testing::TempDir() + name;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+}  // namespace
+
+TEST(FrameSourceTest, ParsesPacingNames) {
+    for (Pacing p : {Pacing::RealTime, Pacing::FixedRate, Pacing::Unpaced}) {
+        Pacing parsed = Pacing::RealTime;
+        ASSERT_TRUE(parse_pacing(pacing_name(p), parsed));
+        EXPECT_EQ(parsed, p);
+    }
+    Pacing parsed;
+    EXPECT_FALSE(parse_pacing("fast", parsed));
+}
+
+TEST(FrameSourceTest, OpensSourcesBySpec) {
+    EXPECT_NE(dynamic_cast<SyntheticSource*>(open_frame_source("synthetic").get()), nullptr);
+    EXPECT_NE(dynamic_cast<SyntheticSource*>(open_frame_source("synthetic:static").get()), nullptr);
+    EXPECT_NE(dynamic_cast<ReplaySource*>(open_frame_source("replay:/tmp/x.yuyv").get()), nullptr);
+}
+
+TEST(SyntheticSourceTest, DeliversMovingYuyvFrames) {
+    SyntheticSource source(unpaced(5));
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    EXPECT_EQ(source.get_pixel_format(), static_cast<uint32_t>(V4L2_PIX_FMT_YUYV));
+
+    std::vector<uint8_t> previous, expected(kFrameBytes);
+    for (uint32_t i = 0; i < 5; ++i) {
+        FrameLease frame = source.acquire_frame(100);
+        ASSERT_TRUE(frame) << "第 " << i << " 帧";
+        EXPECT_EQ(frame->bytesused, kFrameBytes);
+        EXPECT_EQ(frame->sequence, i);
+        EXPECT_GT(frame->capture_ns, 0);
+        source.render_yuyv(i, expected.data());
+        const auto bytes = lease_bytes(frame);
+        EXPECT_EQ(bytes, expected);
+        EXPECT_NE(bytes, previous);  // 画面在移动
+        previous = bytes;
+    }
+    EXPECT_TRUE(source.finished());
+    EXPECT_FALSE(source.acquire_frame(10));
+    EXPECT_EQ(source.delivered(), 5u);
+}
+
+TEST(SyntheticSourceTest, StaticSceneRepeatsTheSameFrame) {
+    SyntheticSource source(unpaced(), false);
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    const auto first = lease_bytes(source.acquire_frame(100));
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(lease_bytes(source.acquire_frame(100)), first);
+    EXPECT_FALSE(source.finished());
+}
+
+TEST(SyntheticSourceTest, RejectsOddWidth) {
+    SyntheticSource source(unpaced());
+    EXPECT_FALSE(source.initialize(63, 48));
+}
+
+TEST(SyntheticSourceTest, LeasesAreBoundedByBufferCount) {
+    auto source = std::make_unique<SyntheticSource>(unpaced());
+    source->set_buffer_count(2);
+    ASSERT_TRUE(source->initialize(kWidth, kHeight));
+    FrameLease a = source->acquire_frame(100);
+    FrameLease b = source->acquire_frame(100);
+    ASSERT_TRUE(a && b);
+    EXPECT_NE(a->index, b->index);
+    EXPECT_EQ(source->get_leased_count(), 2u);
+    // 像驱动一样：缓冲区全被下游持有时取不到新帧
+    EXPECT_FALSE(source->acquire_frame(20));
+
+    a.reset();
+    FrameLease c = source->acquire_frame(100);
+    ASSERT_TRUE(c);
+    EXPECT_EQ(c->sequence, b->sequence + 1);
+
+    // 租约可以比帧源活得更久
+    const auto bytes = lease_bytes(c);
+    source.reset();
+    EXPECT_EQ(lease_bytes(c), bytes);
+}
+
+TEST(SyntheticSourceTest, RealTimeSkipsFramesWhenConsumerIsSlow) {
+    SyntheticSource source(paced(Pacing::RealTime, 200));  // 5 ms 一帧
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    ASSERT_TRUE(source.acquire_frame(100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    FrameLease late = source.acquire_frame(100);
+    ASSERT_TRUE(late);
+    EXPECT_GE(late->sequence, 5u);
+    EXPECT_EQ(source.skipped(), late->sequence - 1);
+}
+
+TEST(SyntheticSourceTest, FixedRateNeverSkipsAndKeepsPace) {
+    SyntheticSource source(paced(Pacing::FixedRate, 200));
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    const auto start = std::chrono::steady_clock::now();
+    int64_t last_capture = 0;
+    for (uint32_t i = 0; i < 5; ++i) {
+        FrameLease frame = source.acquire_frame(100);
+        ASSERT_TRUE(frame);
+        EXPECT_EQ(frame->sequence, i);
+        if (i > 0) {
+            EXPECT_EQ(frame->capture_ns - last_capture, 5000000);
+        }
+        last_capture = frame->capture_ns;
+        if (i == 1) std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(source.skipped(), 0u);
+}
+
+TEST(SyntheticSourceTest, PacedAcquireTimesOutWithoutConsumingFrame) {
+    SyntheticSource source(paced(Pacing::FixedRate, 2));  // 500 ms 一帧
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    ASSERT_TRUE(source.acquire_frame(100));
+    EXPECT_FALSE(source.acquire_frame(10));
+    EXPECT_EQ(source.get_leased_count(), 0u);
+    FrameLease next = source.acquire_frame(1000);
+    ASSERT_TRUE(next);
+    EXPECT_EQ(next->sequence, 1u);
+}
+
+TEST(FrameSourceTest, CaptureFrameCopiesPixelsAndMetadata) {
+    SyntheticSource source(unpaced());
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    std::vector<uint8_t> buffer, expected(kFrameBytes);
+    V4L2FrameView info;
+    ASSERT_TRUE(source.capture_frame(buffer, &info));
+    source.render_yuyv(0, expected.data());
+    EXPECT_EQ(buffer, expected);
+    EXPECT_EQ(info.data, nullptr);
+    EXPECT_EQ(info.bytesused, kFrameBytes);
+    EXPECT_EQ(source.get_leased_count(), 0u);
+}
+
+TEST(ReplaySourceTest, ReplaysYuyvDumpZeroCopy) {
+    SyntheticSource synthetic(unpaced());
+    ASSERT_TRUE(synthetic.initialize(kWidth, kHeight));
+    std::vector<uint8_t> dump;
+    std::vector<std::vector<uint8_t>> frames;
+    for (uint64_t i = 0; i < 3; ++i) {
+        std::vector<uint8_t> frame(kFrameBytes);
+        synthetic.render_yuyv(i, frame.data());
+        dump.insert(dump.end(), frame.begin(), frame.end());
+        frames.push_back(std::move(frame));
+    }
+    dump.insert(dump.end(), 100, 0);  // 末尾不足一帧的数据被忽略
+    const std::string path = write_temp("vision_replay.yuyv", dump);
+
+    ReplaySource source(path, unpaced());
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    EXPECT_EQ(source.frame_count(), 3u);
+    std::vector<FrameLease> leases;
+    for (uint32_t i = 0; i < 3; ++i) {
+        FrameLease frame = source.acquire_frame(100);
+        ASSERT_TRUE(frame);
+        EXPECT_EQ(frame->sequence, i);
+        EXPECT_EQ(lease_bytes(frame), frames[i]);
+        leases.push_back(std::move(frame));
+    }
+    // 租约直接指向映射内存，相邻帧首尾相接
+    EXPECT_EQ(leases[1]->data, leases[0]->data + kFrameBytes);
+    EXPECT_TRUE(source.finished());
+    EXPECT_FALSE(source.acquire_frame(10));
+    EXPECT_EQ(source.delivered(), 3u);
+    // 删除文件后映射仍然有效
+    std::remove(path.c_str());
+    EXPECT_EQ(lease_bytes(leases[0]), frames[0]);
+}
+
+TEST(ReplaySourceTest, LoopsUntilFrameLimit) {
+    std::vector<uint8_t> dump;
+    for (uint8_t i = 0; i < 3; ++i) dump.insert(dump.end(), kFrameBytes, i);
+    const std::string path = write_temp("vision_replay_loop.yuyv", dump);
+
+    ReplaySource source(path, unpaced(7));
+    ASSERT_TRUE(source.initialize(kWidth, kHeight));
+    for (uint32_t i = 0; i < 7; ++i) {
+        FrameLease frame = source.acquire_frame(100);
+        ASSERT_TRUE(frame);
+        EXPECT_EQ(frame->data[0], i % 3);
+    }
+    EXPECT_TRUE(source.finished());
+    std::remove(path.c_str());
+}
+
+TEST(ReplaySourceTest, SplitsMjpegDumpAndDetectsFormat) {
+    const auto a = fake_jpeg(32, 16, 0x11);
+    const auto b = fake_jpeg(32, 16, 0x22);
+    std::vector<uint8_t> dump = a;
+    dump.insert(dump.end(), b.begin(), b.end());
+    dump.insert(dump.end(), {0xFF, 0xD8, 0xFF, 0xC0, 0x00});  // 截断的最后一帧
+    const std::string path = write_temp("vision_replay.mjpeg", dump);
+
+    ReplaySource source(path, unpaced());
+    source.set_pixel_format(V4L2_PIX_FMT_YUYV);
+    ASSERT_TRUE(source.initialize(640, 480));
+    EXPECT_EQ(source.get_pixel_format(), static_cast<uint32_t>(V4L2_PIX_FMT_MJPEG));
+    EXPECT_EQ(source.get_width(), 32u);
+    EXPECT_EQ(source.get_height(), 16u);
+    ASSERT_EQ(source.frame_count(), 2u);
+    EXPECT_EQ(lease_bytes(source.acquire_frame(100)), a);
+    EXPECT_EQ(lease_bytes(source.acquire_frame(100)), b);
+    EXPECT_FALSE(source.acquire_frame(10));
+    std::remove(path.c_str());
+}
+
+TEST(ReplaySourceTest, SkipsPaddingAfterEoi) {
+    const auto a = fake_jpeg(32, 16, 0x11);
+    const auto b = fake_jpeg(32, 16, 0x22);
+    const auto c = fake_jpeg(32, 16, 0x33);
+    // 帧间与文件末尾的 0x00/0xFF 填充（UVC 按缓冲区大小补齐）
+    std::vector<uint8_t> dump = a;
+    dump.insert(dump.end(), 13, 0x00);
+    dump.insert(dump.end(), b.begin(), b.end());
+    dump.insert(dump.end(), {0xFF, 0xFF, 0x00, 0xFF});
+    dump.insert(dump.end(), c.begin(), c.end());
+    dump.insert(dump.end(), 64, 0x00);
+    const std::string path = write_temp("vision_replay_padded.mjpeg", dump);
+
+    ReplaySource source(path, unpaced());
+    ASSERT_TRUE(source.initialize(640, 480));
+    EXPECT_EQ(source.get_pixel_format(), static_cast<uint32_t>(V4L2_PIX_FMT_MJPEG));
+    ASSERT_EQ(source.frame_count(), 3u);
+    // 每帧只包含到 EOI 为止的字节，不带填充
+    EXPECT_EQ(lease_bytes(source.acquire_frame(100)), a);
+    EXPECT_EQ(lease_bytes(source.acquire_frame(100)), b);
+    EXPECT_EQ(lease_bytes(source.acquire_frame(100)), c);
+    EXPECT_FALSE(source.acquire_frame(10));
+    std::remove(path.c_str());
+}
+
+TEST(ReplaySourceTest, MissingFileFailsToInitialize) {
+    ReplaySource source(::testing::TempDir() + "does_not_exist.yuyv");
+    EXPECT_FALSE(source.initialize(kWidth, kHeight));
+    EXPECT_FALSE(source.acquire_frame(10));
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "processor/JpegDecoder.hpp"
+
+namespace {
+std::vector<uint8_t> encode_test_frame(int width, int height, cv::Mat& bgr) {
+    bgr.create(height, width, CV_8UC3);
+    bgr.setTo(cv::Scalar(30, 60, 90));
+    cv::rectangle(bgr, {width / 4, height / 4}, {width * 3 / 4, height * 3 / 4},
+                  {220, 120, 20}, -1);
+    std::vector<uint8_t> jpeg;
+    cv::imencode(".jpg", bgr, jpeg, {cv::IMWRITE_JPEG_QUALITY, 95});
+    return jpeg;
+}
+
+// 左上角红色、其余蓝色，按指定色度采样方式编码
+std::vector<uint8_t> encode_quadrant_frame(int width, int height, int sampling) {
+    cv::Mat bgr(height, width, CV_8UC3, cv::Scalar(255, 0, 0));
+    bgr(cv::Rect(0, 0, width / 2, height / 2)).setTo(cv::Scalar(0, 0, 255));
+    std::vector<uint8_t> jpeg;
+    cv::imencode(".jpg", bgr, jpeg,
+                 {cv::IMWRITE_JPEG_QUALITY, 95, cv::IMWRITE_JPEG_SAMPLING_FACTOR, sampling});
+    return jpeg;
+}
+}  // namespace
+
+// 直接输出 RGB 与现有 imdecode + BGR2RGB 路径一致（允许 IDCT 实现的微小差异）
+TEST(JpegDecoderTest, RgbMatchesImdecode) {
+    cv::Mat bgr;
+    auto jpeg = encode_test_frame(320, 240, bgr);
+
+    JpegDecoder decoder;
+    int width = 0, height = 0;
+    ASSERT_TRUE(decoder.read_header(jpeg.data(), jpeg.size(), width, height));
+    EXPECT_EQ(width, 320);
+    EXPECT_EQ(height, 240);
+
+    cv::Mat rgb, reference;
+    ASSERT_TRUE(decoder.decode_rgb(jpeg.data(), jpeg.size(), rgb));
+    cv::cvtColor(cv::imdecode(jpeg, cv::IMREAD_COLOR), reference, cv::COLOR_BGR2RGB);
+    ASSERT_EQ(rgb.size(), reference.size());
+    EXPECT_LE(cv::norm(rgb, reference, cv::NORM_INF), 2.0);
+}
+
+// DCT 缩放解码得到向上取整的尺寸
+TEST(JpegDecoderTest, ScaledDecodeSizes) {
+    cv::Mat bgr;
+    auto jpeg = encode_test_frame(642, 362, bgr);
+    JpegDecoder decoder;
+    for (auto scale : {JpegDecoder::Scale::Half, JpegDecoder::Scale::Quarter,
+                       JpegDecoder::Scale::Eighth}) {
+        cv::Mat rgb, gray;
+        ASSERT_TRUE(decoder.decode_rgb(jpeg.data(), jpeg.size(), rgb, scale));
+        ASSERT_TRUE(decoder.decode_gray(jpeg.data(), jpeg.size(), gray, scale));
+        EXPECT_EQ(rgb.cols, JpegDecoder::scaled(642, scale));
+        EXPECT_EQ(rgb.rows, JpegDecoder::scaled(362, scale));
+        EXPECT_EQ(gray.size(), rgb.size());
+        EXPECT_EQ(gray.type(), CV_8UC1);
+    }
+}
+
+// YUV420P 输出的 Y 平面与灰度解码一致，色度落在预期范围
+TEST(JpegDecoderTest, Yuv420pPlanes) {
+    cv::Mat bgr;
+    const int w = 320, h = 240;
+    auto jpeg = encode_test_frame(w, h, bgr);
+    JpegDecoder decoder;
+
+    std::vector<uint8_t> y(w * h), u(w / 2 * h / 2), v(u.size());
+    Yuv420pPlanes planes{y.data(), w, u.data(), w / 2, v.data(), w / 2};
+    ASSERT_TRUE(decoder.decode_yuv420p(jpeg.data(), jpeg.size(), planes, w, h));
+    EXPECT_FALSE(decoder.decode_yuv420p(jpeg.data(), jpeg.size(), planes, w * 2, h));
+
+    cv::Mat gray;
+    ASSERT_TRUE(decoder.decode_gray(jpeg.data(), jpeg.size(), gray));
+    cv::Mat y_mat(h, w, CV_8UC1, y.data());
+    EXPECT_LE(cv::norm(y_mat, gray, cv::NORM_INF), 2.0);
+
+    // 背景 BGR(30, 60, 90) 偏红：V > 128，U < 128
+    EXPECT_GT(v[0], 128);
+    EXPECT_LT(u[0], 128);
+}
+
+// 4:2:2 / 4:4:4 的 JPEG 重采样为 4:2:0 后色度位置不变，奇数尺寸同样适用
+TEST(JpegDecoderTest, Yuv420pFromOtherSubsampling) {
+    struct Case {
+        int sampling;
+        int width;
+        int height;
+    };
+    const Case cases[] = {
+        {cv::IMWRITE_JPEG_SAMPLING_FACTOR_422, 320, 240},
+        {cv::IMWRITE_JPEG_SAMPLING_FACTOR_422, 321, 240},
+        {cv::IMWRITE_JPEG_SAMPLING_FACTOR_444, 320, 240},
+        {cv::IMWRITE_JPEG_SAMPLING_FACTOR_444, 321, 241},
+    };
+    JpegDecoder decoder;
+    for (const Case& c : cases) {
+        // imdecode 回退实现只支持偶数尺寸
+        if (((c.width | c.height) & 1) && !JpegDecoder::uses_turbojpeg()) continue;
+        SCOPED_TRACE(::testing::Message() << std::hex << c.sampling << std::dec << " "
+                                          << c.width << "x" << c.height);
+        const int w = c.width, h = c.height;
+        const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+        auto jpeg = encode_quadrant_frame(w, h, c.sampling);
+        std::vector<uint8_t> y(w * h), u(cw * ch), v(u.size());
+        Yuv420pPlanes planes{y.data(), w, u.data(), cw, v.data(), cw};
+        ASSERT_TRUE(decoder.decode_yuv420p(jpeg.data(), jpeg.size(), planes, w, h));
+
+        cv::Mat gray;
+        ASSERT_TRUE(decoder.decode_gray(jpeg.data(), jpeg.size(), gray));
+        EXPECT_LE(cv::norm(cv::Mat(h, w, CV_8UC1, y.data()), gray, cv::NORM_INF), 2.0);
+
+        // 取离分界 1/8 画面的位置：色度按错误的比例取样时会落到另一种颜色上。
+        // 红色 U≈85 V≈255，蓝色 U≈255 V≈107
+        auto at = [&](const std::vector<uint8_t>& plane, int row, int col) {
+            return static_cast<int>(plane[static_cast<size_t>(row) * cw + col]);
+        };
+        const int near_x = cw * 3 / 8, far_x = cw * 7 / 8;
+        const int near_y = ch * 3 / 8, far_y = ch * 7 / 8;
+        EXPECT_NEAR(at(u, near_y, near_x), 85, 12);
+        EXPECT_NEAR(at(v, near_y, near_x), 255, 12);
+        EXPECT_NEAR(at(u, near_y, far_x), 255, 12);
+        EXPECT_NEAR(at(v, near_y, far_x), 107, 12);
+        EXPECT_NEAR(at(u, far_y, near_x), 255, 12);
+        EXPECT_NEAR(at(v, far_y, near_x), 107, 12);
+        // 最后一列/行（奇数尺寸时只覆盖半个亮度样本）同样有效
+        EXPECT_NEAR(at(u, ch - 1, cw - 1), 255, 12);
+        EXPECT_NEAR(at(v, ch - 1, cw - 1), 107, 12);
+    }
+}
+
+// 文件头扫描认得所有 SOFn（例如算术编码 SOF9），跳过 DHT 与填充字节
+TEST(JpegDecoderTest, ParseSofAcceptsAllFrameTypes) {
+    cv::Mat bgr;
+    auto jpeg = encode_test_frame(320, 240, bgr);
+    int width = 0, height = 0;
+    ASSERT_TRUE(JpegDecoder::parse_sof(jpeg.data(), jpeg.size(), width, height));
+    EXPECT_EQ(width, 320);
+    EXPECT_EQ(height, 240);
+
+    // SOI, 填充, DHT(长度 2), SOF9 1281x721
+    const std::vector<uint8_t> header = {0xFF, 0xD8, 0xFF, 0xFF, 0xC4, 0x00, 0x02,
+                                         0xFF, 0xC9, 0x00, 0x0B, 0x08, 0x02, 0xD1,
+                                         0x05, 0x01, 0x01, 0x01, 0x11, 0x00};
+    ASSERT_TRUE(JpegDecoder::parse_sof(header.data(), header.size(), width, height));
+    EXPECT_EQ(width, 1281);
+    EXPECT_EQ(height, 721);
+    EXPECT_FALSE(JpegDecoder::parse_sof(header.data(), 9, width, height));
+}
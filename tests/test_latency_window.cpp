@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "pipeline/LatencyWindow.hpp"
+
+TEST(LatencyWindowTest, EmptyWindowReportsZero) {
+    LatencyWindow window(16);
+    auto s = window.summary();
+    EXPECT_EQ(s.count, 0u);
+    EXPECT_EQ(s.window, 0u);
+    EXPECT_DOUBLE_EQ(s.p99, 0.0);
+}
+
+TEST(LatencyWindowTest, NearestRankPercentiles) {
+    LatencyWindow window(100);
+    // 倒序写入，结果不依赖写入顺序
+    for (int i = 100; i >= 1; --i) window.add(i);
+    auto s = window.summary();
+    EXPECT_EQ(s.count, 100u);
+    EXPECT_EQ(s.window, 100u);
+    EXPECT_DOUBLE_EQ(s.p50, 50.0);
+    EXPECT_DOUBLE_EQ(s.p90, 90.0);
+    EXPECT_DOUBLE_EQ(s.p99, 99.0);
+    EXPECT_DOUBLE_EQ(s.max, 100.0);
+    EXPECT_DOUBLE_EQ(s.avg, 50.5);
+}
+
+TEST(LatencyWindowTest, OldSamplesSlideOut) {
+    LatencyWindow window(10);
+    for (int i = 0; i < 10; ++i) window.add(1000.0);  // 早期的一段高延迟
+    for (int i = 0; i < 10; ++i) window.add(5.0);
+    auto s = window.summary();
+    EXPECT_EQ(s.count, 20u);
+    EXPECT_EQ(s.window, 10u);
+    // 累计总和包含已滑出窗口的样本
+    EXPECT_DOUBLE_EQ(s.sum, 10 * 1000.0 + 10 * 5.0);
+    EXPECT_DOUBLE_EQ(s.max, 5.0);
+    EXPECT_DOUBLE_EQ(s.p99, 5.0);
+}
+
+TEST(LatencyWindowTest, ConcurrentAddAndSummary) {
+    LatencyWindow window(64);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) window.add(i % 10);
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        auto s = window.summary();
+        EXPECT_LE(s.window, 64u);
+        EXPECT_LE(s.max, 9.0);
+    }
+    for (auto& w : writers) w.join();
+    auto s = window.summary();
+    EXPECT_EQ(s.count, 4000u);
+    EXPECT_DOUBLE_EQ(s.sum, 4 * 100 * 45.0);
+    EXPECT_EQ(s.window, 64u);
+}
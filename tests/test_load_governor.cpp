@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "pipeline/LoadGovernor.hpp"
+
+namespace {
+using Level = LoadGovernor::Level;
+using namespace std::chrono_literals;
+
+// 模拟一个阶段的累计统计：每次 tick 以给定的单帧耗时再处理 frames 帧（200ms 内 30fps 的帧数）
+class FakeStage {
+public:
+    FakeStage(std::string name, unsigned workers) { sample_.name = name; sample_.workers = workers; }
+
+    std::vector<LoadGovernor::StageSample> tick(double frame_ms, uint64_t frames = 6) {
+        sample_.processed += frames;
+        sample_.busy_ms += frame_ms * frames;
+        return {sample_};
+    }
+
+private:
+    LoadGovernor::StageSample sample_;
+};
+
+LoadGovernor::Options fast_options() {
+    LoadGovernor::Options options;
+    options.target_fps = 30;
+    options.degrade_seconds = 1.0;
+    options.recover_seconds = 2.0;
+    return options;
+}
+}  // namespace
+
+TEST(LoadGovernorTest, StaysAtFullWithinDeadline) {
+    LoadGovernor governor(fast_options());
+    FakeStage stage("algorithm", 1);
+    auto now = LoadGovernor::Clock::time_point{};
+    for (int i = 0; i < 50; ++i, now += 200ms) {
+        EXPECT_FALSE(governor.update(stage.tick(20.0), now));
+    }
+    const auto stats = governor.stats();
+    EXPECT_EQ(stats.level, Level::Full);
+    EXPECT_EQ(stats.transitions, 0u);
+    EXPECT_NEAR(stats.load, 20.0 / 33.33, 0.01);
+    EXPECT_EQ(stats.bottleneck, "algorithm");
+    EXPECT_NEAR(stats.level_seconds[0], 49 * 0.2, 1e-6);
+}
+
+TEST(LoadGovernorTest, DegradesOneLevelPerHoldPeriod) {
+    LoadGovernor governor(fast_options());
+    FakeStage stage("algorithm", 1);
+    auto now = LoadGovernor::Clock::time_point{};
+    std::vector<int> changes;
+    for (int i = 0; i < 30; ++i, now += 200ms) {
+        if (governor.update(stage.tick(50.0), now)) changes.push_back(i);
+    }
+    // 第一次调用只建立基线；持续时间从第一次观察到过载算起，每 1 秒升一级，到 max_level 为止
+    EXPECT_EQ(changes, (std::vector<int>{6, 12, 18}));
+    EXPECT_EQ(governor.level(), Level::EncoderReduced);
+    EXPECT_EQ(governor.stats().transitions, 3u);
+}
+
+TEST(LoadGovernorTest, WorkersExtendTheDeadline) {
+    LoadGovernor governor(fast_options());
+    FakeStage stage("algorithm", 2);
+    auto now = LoadGovernor::Clock::time_point{};
+    // 两个线程各 50ms/帧，平均每 25ms 出一帧，仍在 33ms 期限内
+    for (int i = 0; i < 30; ++i, now += 200ms) governor.update(stage.tick(50.0), now);
+    EXPECT_EQ(governor.level(), Level::Full);
+    EXPECT_NEAR(governor.stats().load, 0.75, 0.01);
+}
+
+TEST(LoadGovernorTest, RecoversAfterSustainedIdle) {
+    LoadGovernor governor(fast_options());
+    FakeStage stage("encode", 1);
+    auto now = LoadGovernor::Clock::time_point{};
+    for (int i = 0; i < 8; ++i, now += 200ms) governor.update(stage.tick(50.0), now);
+    ASSERT_EQ(governor.level(), Level::ReducedResolution);
+    // 中等负载（在两个阈值之间）既不升也不降
+    for (int i = 0; i < 30; ++i, now += 200ms) governor.update(stage.tick(26.0), now);
+    EXPECT_EQ(governor.level(), Level::ReducedResolution);
+    int recovered_at = -1;
+    for (int i = 0; i < 30 && recovered_at < 0; ++i, now += 200ms) {
+        if (governor.update(stage.tick(10.0), now)) recovered_at = i;
+    }
+    EXPECT_EQ(recovered_at, 10);  // 持续空闲 2 秒
+    EXPECT_EQ(governor.level(), Level::Full);
+    const auto stats = governor.stats();
+    EXPECT_EQ(stats.transitions, 2u);
+    EXPECT_GT(stats.level_seconds[1], 7.0);
+}
+
+TEST(LoadGovernorTest, BacksOffRecoveryWhenFlapping) {
+    LoadGovernor governor(fast_options());
+    FakeStage stage("algorithm", 1);
+    auto now = LoadGovernor::Clock::time_point{};
+    auto run_until_change = [&](double frame_ms) {
+        for (int i = 0; i < 200; ++i) {
+            now += 200ms;
+            if (governor.update(stage.tick(frame_ms), now)) return i;
+        }
+        return -1;
+    };
+    governor.update(stage.tick(50.0), now);
+    // 全速时过载、降一级后空闲：恢复后马上又过载
+    EXPECT_GE(run_until_change(50.0), 0);
+    EXPECT_EQ(run_until_change(10.0), 10);  // 持续空闲 2 秒
+    EXPECT_EQ(run_until_change(50.0), 5);   // 恢复后 1 秒内再次过载
+    EXPECT_EQ(run_until_change(10.0), 20);  // 恢复等待加倍为 4 秒
+    EXPECT_EQ(run_until_change(50.0), 5);
+    EXPECT_EQ(run_until_change(10.0), 40);  // 8 秒
+}
+
+TEST(LoadGovernorTest, RespectsMaxLevelAndIgnoresIdleStages) {
+    auto options = fast_options();
+    options.max_level = 1;
+    LoadGovernor governor(options);
+    LoadGovernor::StageSample busy{"algorithm", 1, 0.0, 0};
+    LoadGovernor::StageSample idle{"encode", 1, 0.0, 0};
+    auto now = LoadGovernor::Clock::time_point{};
+    for (int i = 0; i < 30; ++i, now += 200ms) {
+        busy.busy_ms += 6 * 60.0;
+        busy.processed += 6;
+        governor.update({busy, idle}, now);  // idle 没有新帧，不参与
+    }
+    EXPECT_EQ(governor.level(), Level::ReducedResolution);
+    EXPECT_EQ(governor.stats().bottleneck, "algorithm");
+    EXPECT_STREQ(LoadGovernor::level_name(Level::FrameSkip), "frame_skip");
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "processor/MotionGate.hpp"
+
+namespace {
+constexpr unsigned kWidth = 320;
+constexpr unsigned kHeight = 240;
+
+// 带传感器噪声（±3）的静态场景：水平渐变
+std::vector<uint8_t> scene_yuyv(std::mt19937& rng) {
+    std::uniform_int_distribution<int> noise(-3, 3);
+    std::vector<uint8_t> frame(kWidth * kHeight * 2);
+    for (unsigned y = 0; y < kHeight; ++y) {
+        for (unsigned x = 0; x < kWidth; ++x) {
+            const int luma = 40 + static_cast<int>(x * 150 / kWidth) + noise(rng);
+            frame[(y * kWidth + x) * 2] = static_cast<uint8_t>(luma);
+            frame[(y * kWidth + x) * 2 + 1] = 128;
+        }
+    }
+    return frame;
+}
+
+// 在 (x, y) 处画一个 w x h 的白块
+void draw_box(std::vector<uint8_t>& yuyv, unsigned x, unsigned y, unsigned w, unsigned h) {
+    for (unsigned r = y; r < y + h; ++r) {
+        for (unsigned c = x; c < x + w; ++c) yuyv[(r * kWidth + c) * 2] = 250;
+    }
+}
+}  // namespace
+
+TEST(MotionGateTest, FirstFrameIsAlwaysProcessed) {
+    std::mt19937 rng(1);
+    MotionGate gate(kWidth, kHeight);
+    const auto frame = scene_yuyv(rng);
+    EXPECT_TRUE(gate.analyze_yuyv(frame.data(), kWidth * 2).changed);
+    EXPECT_FALSE(gate.analyze_yuyv(frame.data(), kWidth * 2).changed);
+}
+
+TEST(MotionGateTest, IgnoresSensorNoiseAndDetectsObjects) {
+    std::mt19937 rng(2);
+    MotionGate gate(kWidth, kHeight);
+    gate.analyze_yuyv(scene_yuyv(rng).data(), kWidth * 2);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_FALSE(gate.analyze_yuyv(scene_yuyv(rng).data(), kWidth * 2).changed) << i;
+    }
+    auto moved = scene_yuyv(rng);
+    draw_box(moved, 100, 100, 40, 40);
+    const auto decision = gate.analyze_yuyv(moved.data(), kWidth * 2);
+    EXPECT_TRUE(decision.changed);
+    EXPECT_GT(decision.changed_fraction, 0.0);
+
+    const auto stats = gate.stats();
+    EXPECT_EQ(stats.frames, 22u);
+    EXPECT_EQ(stats.static_frames, 20u);
+}
+
+TEST(MotionGateTest, ComparesAgainstLastProcessedFrame) {
+    // 每帧只亮 1，单看相邻两帧永远低于阈值，但累积到阈值后必须触发
+    MotionGate::Options options;
+    options.threshold = 6;
+    MotionGate gate(kWidth, kHeight, options);
+    std::vector<uint8_t> gray(kWidth * kHeight, 100);
+    gate.analyze(gray.data(), kWidth, 1, kWidth, kHeight);
+    int triggered_at = -1;
+    for (int step = 1; step <= 10 && triggered_at < 0; ++step) {
+        std::fill(gray.begin(), gray.end(), static_cast<uint8_t>(100 + step));
+        if (gate.analyze(gray.data(), kWidth, 1, kWidth, kHeight).changed) triggered_at = step;
+    }
+    EXPECT_EQ(triggered_at, 7);
+}
+
+TEST(MotionGateTest, RegionsAndIgnoreMasks) {
+    std::mt19937 rng(3);
+    const auto base = scene_yuyv(rng);
+    auto clock = base;
+    draw_box(clock, 0, 0, 80, 32);  // 左上角的时间水印在变
+
+    MotionGate ignoring(kWidth, kHeight);
+    ignoring.set_ignore_regions({{0, 0, 96, 48}});
+    ignoring.analyze_yuyv(base.data(), kWidth * 2);
+    EXPECT_FALSE(ignoring.analyze_yuyv(clock.data(), kWidth * 2).changed);
+
+    // 只关注右半边
+    MotionGate watching(kWidth, kHeight);
+    watching.set_regions({{kWidth / 2, 0, kWidth / 2, kHeight}});
+    watching.analyze_yuyv(base.data(), kWidth * 2);
+    EXPECT_FALSE(watching.analyze_yuyv(clock.data(), kWidth * 2).changed);
+    auto right = base;
+    draw_box(right, 240, 120, 32, 32);
+    EXPECT_TRUE(watching.analyze_yuyv(right.data(), kWidth * 2).changed);
+}
+
+TEST(MotionGateTest, AcceptsDownscaledLuma) {
+    // MJPEG 按 1/8 解码得到的亮度：尺寸与源分辨率不同，区域仍按源坐标生效
+    MotionGate gate(kWidth, kHeight);
+    gate.set_ignore_regions({{0, 0, kWidth / 2, kHeight}});
+    std::vector<uint8_t> small(kWidth / 8 * kHeight / 8, 90);
+    gate.analyze(small.data(), kWidth / 8, 1, kWidth / 8, kHeight / 8);
+    auto left = small;
+    left[4 * (kWidth / 8) + 2] = 250;  // 左半边（被忽略）
+    EXPECT_FALSE(gate.analyze(left.data(), kWidth / 8, 1, kWidth / 8, kHeight / 8).changed);
+    auto right = small;
+    right[4 * (kWidth / 8) + 30] = 250;
+    EXPECT_TRUE(gate.analyze(right.data(), kWidth / 8, 1, kWidth / 8, kHeight / 8).changed);
+}
+
+TEST(MotionGateTest, RefreshesAfterLongStaticRun) {
+    MotionGate::Options options;
+    options.refresh_frames = 5;
+    MotionGate gate(kWidth, kHeight, options);
+    std::vector<uint8_t> gray(kWidth * kHeight, 100);
+    std::vector<bool> changed;
+    for (int i = 0; i < 12; ++i) {
+        changed.push_back(gate.analyze(gray.data(), kWidth, 1, kWidth, kHeight).changed);
+    }
+    EXPECT_EQ(changed, (std::vector<bool>{true, false, false, false, false, true, false, false,
+                                          false, false, true, false}));
+    EXPECT_EQ(gate.stats().refreshes, 2u);
+}
+
+TEST(MotionGateTest, EstimatesCpuSaved) {
+    MotionGate gate(kWidth, kHeight);
+    std::vector<uint8_t> gray(kWidth * kHeight, 100);
+    for (int i = 0; i < 10; ++i) gate.analyze(gray.data(), kWidth, 1, kWidth, kHeight);
+    gate.record_processing(20000000);  // 唯一处理过的一帧用了 20ms
+    const auto stats = gate.stats();
+    EXPECT_EQ(stats.static_frames, 9u);
+    EXPECT_DOUBLE_EQ(stats.process_ms_avg, 20.0);
+    EXPECT_NEAR(stats.cpu_saved_ms, 180.0 - stats.detect_ms_avg * 10, 1e-6);
+}
+
+TEST(MotionGateTest, ParsesRegions) {
+    std::vector<MotionRegion> regions;
+    ASSERT_TRUE(parse_motion_regions("0,0,100,50;200,10,30,40", regions));
+    ASSERT_EQ(regions.size(), 2u);
+    EXPECT_EQ(regions[1].x, 200);
+    EXPECT_EQ(regions[1].height, 40);
+    EXPECT_TRUE(parse_motion_regions("", regions));
+    EXPECT_TRUE(regions.empty());
+    EXPECT_FALSE(parse_motion_regions("0,0,100", regions));
+    EXPECT_FALSE(parse_motion_regions("0,0,-1,5", regions));
+}
+
+TEST(MotionGateTest, InvalidatedReferenceForcesReprocessing) {
+    std::mt19937 rng(5);
+    MotionGate gate(kWidth, kHeight);
+    const auto frame = scene_yuyv(rng);
+    ASSERT_TRUE(gate.analyze_yuyv(frame.data(), kWidth * 2).changed);
+    // 这一帧没有到达编码器：同样的画面必须重新处理一次，之后恢复静止判定
+    gate.invalidate_reference();
+    EXPECT_TRUE(gate.analyze_yuyv(frame.data(), kWidth * 2).changed);
+    EXPECT_FALSE(gate.analyze_yuyv(frame.data(), kWidth * 2).changed);
+}
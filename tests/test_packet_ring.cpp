@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "streamer/PacketRing.hpp"
+
+namespace {
+// 包编号 n 同时作为时间戳，每 gop 个包一个关键帧
+void push_packets(PacketRing<int>& ring, int begin, int end, int gop, size_t bytes = 100) {
+    for (int i = begin; i < end; ++i) ring.push(int(i), i, i % gop == 0, bytes);
+}
+
+std::vector<int> contents(const PacketRing<int>& ring) {
+    std::vector<int> out;
+    ring.for_each([&](const auto& e) { out.push_back(e.packet); });
+    return out;
+}
+}  // namespace
+
+TEST(PacketRingTest, DropsPacketsBeforeFirstKeyframe) {
+    PacketRing<int> ring;
+    push_packets(ring, 5, 25, 10);
+    auto got = contents(ring);
+    ASSERT_FALSE(got.empty());
+    EXPECT_EQ(got.front(), 10);
+    EXPECT_EQ(got.back(), 24);
+    EXPECT_EQ(ring.gop_count(), 2u);
+}
+
+TEST(PacketRingTest, KeepsAtLeastMaxDurationAndStartsOnKeyframe) {
+    PacketRing<int> ring({25, 0});
+    for (int i = 0; i < 200; ++i) {
+        ring.push(int(i), i, i % 10 == 0, 100);
+        if (i >= 25) {
+            // 覆盖至少 25 个时间单位，但不超过 25 + 一个 GOP
+            EXPECT_GE(ring.duration(), 25);
+            EXPECT_LT(ring.duration(), 25 + 10);
+        }
+        auto got = contents(ring);
+        EXPECT_EQ(got.front() % 10, 0);
+    }
+}
+
+TEST(PacketRingTest, EvictsWholeGopsWhenOverByteLimit) {
+    PacketRing<int> ring({0, 2500});
+    push_packets(ring, 0, 100, 10);  // 每个 GOP 1000 字节
+    EXPECT_LE(ring.bytes(), 2500u);
+    auto got = contents(ring);
+    EXPECT_EQ(got.front(), 80);
+    EXPECT_EQ(got.back(), 99);
+    EXPECT_EQ(ring.size(), got.size());
+    EXPECT_EQ(ring.bytes(), got.size() * 100);
+}
+
+TEST(PacketRingTest, ClearsWhenSingleGopExceedsByteLimit) {
+    PacketRing<int> ring({0, 500});
+    push_packets(ring, 0, 6, 100);  // 一个 GOP 超过上限
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.bytes(), 0u);
+    // 非关键帧不会重新开始缓冲
+    push_packets(ring, 6, 20, 100);
+    EXPECT_TRUE(ring.empty());
+    push_packets(ring, 100, 103, 100);
+    EXPECT_EQ(contents(ring), (std::vector<int>{100, 101, 102}));
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "streamer/PacketWriter.hpp"
+
+namespace {
+// 写出端的替身：记录写出的包，可以通过 gate 模拟网络阻塞
+struct FakeSink {
+    std::mutex mutex;
+    std::vector<int> written;
+    std::atomic<bool> blocked{false};
+
+    bool write(int& packet) {
+        while (blocked) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(mutex);
+        written.push_back(packet);
+        return true;
+    }
+};
+
+// 包编号 n，每 gop 个包一个关键帧
+bool is_key(int n, int gop) { return n % gop == 0; }
+}  // namespace
+
+TEST(PacketWriterTest, WritesInOrderAndDrainsOnStop) {
+    FakeSink sink;
+    PacketWriter<int> writer([&](int& p) { return sink.write(p); });
+    for (int i = 0; i < 50; ++i) EXPECT_TRUE(writer.push(int(i), is_key(i, 10), 100));
+    writer.stop();
+
+    ASSERT_EQ(sink.written.size(), 50u);
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(sink.written[i], i);
+    auto stats = writer.stats();
+    EXPECT_EQ(stats.written, 50u);
+    EXPECT_EQ(stats.dropped_packets, 0u);
+    EXPECT_EQ(stats.queue_depth, 0u);
+    // 停止后的包直接丢弃
+    EXPECT_FALSE(writer.push(99, true, 100));
+}
+
+// 网络阻塞时：丢掉 GOP 剩余部分直到下一个关键帧，写出的码流中每个 GOP 都是完整前缀
+TEST(PacketWriterTest, DropsRestOfGopUnderBackpressure) {
+    FakeSink sink;
+    sink.blocked = true;
+    PacketWriter<int> writer([&](int& p) { return sink.write(p); }, {8, 0});
+
+    const int gop = 5;
+    // 写出线程可能已取走第一个包并阻塞在 write 上，所以多推一些
+    for (int i = 0; i < 40; ++i) writer.push(int(i), is_key(i, gop), 100);
+    sink.blocked = false;
+    writer.stop();
+
+    auto stats = writer.stats();
+    EXPECT_GT(stats.dropped_packets, 0u);
+    EXPECT_GT(stats.dropped_gops, 0u);
+    EXPECT_EQ(stats.written + stats.dropped_packets, 40u);
+    EXPECT_LE(stats.queue_high_water, 8u);
+
+    // 每个非关键帧的前一个写出包必须是同一 GOP 的前一帧
+    for (size_t i = 0; i < sink.written.size(); ++i) {
+        const int p = sink.written[i];
+        if (is_key(p, gop)) continue;
+        ASSERT_GT(i, 0u);
+        EXPECT_EQ(sink.written[i - 1], p - 1) << "GOP 中间出现缺口: " << p;
+    }
+    // 阻塞期间最新的关键帧一定被保留
+    EXPECT_NE(std::find(sink.written.begin(), sink.written.end(), 35), sink.written.end());
+}
+
+// 字节上限与写出失败计数
+TEST(PacketWriterTest, ByteLimitAndWriteErrors) {
+    std::atomic<bool> blocked{true};
+    PacketWriter<int> writer(
+        [&](int& p) {
+            while (blocked) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return p % 2 == 0;
+        },
+        {100, 1000});
+    // 关键帧 400 字节，写出线程取走第一个后队列最多再放 2 个
+    for (int i = 0; i < 6; ++i) writer.push(int(i), true, 400);
+    auto stats = writer.stats();
+    EXPECT_LE(stats.queue_bytes, 1000u);
+    blocked = false;
+    writer.stop();
+    stats = writer.stats();
+    EXPECT_EQ(stats.written + stats.write_errors + stats.dropped_packets, 6u);
+    EXPECT_GT(stats.write_errors, 0u);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "pipeline/Pipeline.hpp"
+
+namespace {
+struct TestFrame {
+    uint64_t seq = 0;
+    int value = 0;
+};
+}  // namespace
+
+TEST(PipelineTest, OrderedStageRestoresSequenceAfterParallelStage) {
+    constexpr int kFrames = 200;
+    int produced = 0;
+    Pipeline<TestFrame> pipeline("source", [&](TestFrame& f) {
+        if (produced == kFrames) return false;
+        f.value = produced++;
+        return true;
+    });
+
+    std::vector<uint64_t> order;
+    pipeline
+        .add_stage({"work", 4},
+                   [](TestFrame& f) {
+                       // 不同帧耗时不同，使并行阶段的输出乱序
+                       std::this_thread::sleep_for(
+                           std::chrono::microseconds((f.seq * 37) % 500));
+                       f.value *= 2;
+                       return true;
+                   })
+        .add_stage({"filter", 2},
+                   [](TestFrame& f) { return f.value % 3 != 0; })
+        .add_stage({"sink", 1, true}, [&](TestFrame& f) {
+            order.push_back(f.seq);
+            EXPECT_EQ(f.value, static_cast<int>(f.seq) * 2);
+            return true;
+        });
+    pipeline.start();
+    pipeline.wait();
+
+    // 被 filter 丢弃的帧不会到达 sink，其余帧必须严格按序号递增
+    ASSERT_FALSE(order.empty());
+    for (size_t i = 1; i < order.size(); ++i) {
+        EXPECT_LT(order[i - 1], order[i]);
+    }
+    auto stats = pipeline.stats();
+    ASSERT_EQ(stats.size(), 4u);
+    EXPECT_EQ(stats[1].processed, uint64_t(kFrames));
+    EXPECT_EQ(stats[2].processed + stats[2].dropped, uint64_t(kFrames));
+    EXPECT_EQ(stats[3].processed, order.size());
+    EXPECT_EQ(stats[3].processed, stats[2].processed);
+}
+
+TEST(PipelineTest, StopDrainsInFlightFrames) {
+    std::atomic<uint64_t> sunk{0};
+    Pipeline<TestFrame> pipeline("source", [](TestFrame&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return true;
+    });
+    pipeline.add_stage({"sink", 1, true}, [&](TestFrame&) {
+        sunk.fetch_add(1);
+        return true;
+    });
+    pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    pipeline.stop();
+    pipeline.wait();
+    auto stats = pipeline.stats();
+    EXPECT_EQ(sunk.load(), stats[0].processed);
+    EXPECT_GT(sunk.load(), 0u);
+}
+
+TEST(PipelineTest, DropOldestStageDoesNotStallOrderedStage) {
+    constexpr int kBursts = 5;
+    constexpr int kBurst = 20;
+    int produced = 0;
+    int stalls = 0;
+    std::atomic<int64_t> last_sunk{-1};
+    Pipeline<TestFrame> pipeline("source", [&](TestFrame& f) {
+        if (produced == kBursts * kBurst) return false;
+        if (produced > 0 && produced % kBurst == 0) {
+            // 每批之间等 sink 收到上一批的最后一帧；被挤掉的序号若让 ordered
+            // 阶段一直等待重排窗口溢出，这里会超时
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (last_sunk.load() != produced - 1 &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            if (last_sunk.load() != produced - 1) ++stalls;
+        }
+        f.value = produced++;
+        return true;
+    });
+
+    std::vector<uint64_t> order;
+    Pipeline<TestFrame>::StageOptions slow{"slow", 1};
+    slow.queue_capacity = 2;
+    slow.policy = OverflowPolicy::DropOldest;
+    pipeline
+        .add_stage(slow,
+                   [](TestFrame&) {
+                       std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                       return true;
+                   })
+        .add_stage({"sink", 1, true}, [&](TestFrame& f) {
+            order.push_back(f.seq);
+            last_sunk.store(static_cast<int64_t>(f.seq));
+            return true;
+        });
+    pipeline.start();
+    pipeline.wait();
+
+    EXPECT_EQ(stalls, 0);
+    ASSERT_FALSE(order.empty());
+    EXPECT_EQ(order.back(), uint64_t(kBursts * kBurst - 1));
+    for (size_t i = 1; i < order.size(); ++i) {
+        EXPECT_LT(order[i - 1], order[i]);
+    }
+    auto stats = pipeline.stats();
+    EXPECT_GT(stats[1].queue_drops, 0u);
+    EXPECT_EQ(stats[1].processed + stats[1].queue_drops, uint64_t(kBursts * kBurst));
+    EXPECT_EQ(stats[2].processed, stats[1].processed);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "capture/RawCapture.hpp"
+#include "capture/ReplaySource.hpp"
+
+namespace {
+constexpr unsigned kWidth = 32;
+constexpr unsigned kHeight = 16;
+
+// 长度不一的负载（模拟 MJPEG），内容由帧号决定
+std::vector<uint8_t> payload(unsigned i) {
+    std::vector<uint8_t> bytes(100 + i * 37);
+    for (size_t k = 0; k < bytes.size(); ++k) bytes[k] = static_cast<uint8_t>(i * 31 + k);
+    return bytes;
+}
+
+V4L2FrameView view_of(const std::vector<uint8_t>& bytes, uint32_t sequence, int64_t capture_ns) {
+    V4L2FrameView view;
+    view.data = bytes.data();
+    view.bytesused = bytes.size();
+    view.sequence = sequence;
+    view.capture_ns = capture_ns;
+    return view;
+}
+
+// 写 count 帧：驱动序号从 100 开始且第 3 帧处跳号，采集时间间隔 10ms
+std::string record(const std::string& name, unsigned count, RawCaptureWriter::Options options = {}) {
+    const std::string path = ::testing::TempDir() + name;
+    RawCaptureWriter writer(path, V4L2_PIX_FMT_MJPEG, kWidth, kHeight, options);
+    uint64_t rejected = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        const auto bytes = payload(i);
+        const auto view = view_of(bytes, 100 + i + (i >= 3 ? 1 : 0), 1000000000LL + i * 10000000LL);
+        // 块很小时写出线程可能来不及，等它腾出块再重试，保证每帧都录下来
+        while (!writer.append(view)) {
+            ++rejected;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    EXPECT_TRUE(writer.close());
+    EXPECT_EQ(writer.stats().frames, count);
+    EXPECT_EQ(writer.stats().dropped, rejected);
+    return path;
+}
+
+RawCaptureWriter::Options small_chunks() {
+    RawCaptureWriter::Options options;
+    options.preallocate_bytes = 64 * 1024;
+    options.chunk_bytes = 1024;  // 每块只放得下几帧，覆盖换块与单帧扩块
+    options.chunks = 3;
+    return options;
+}
+}  // namespace
+
+TEST(RawCaptureTest, RoundTripsFramesWithAlignedPayloads) {
+    const std::string path = record("raw_roundtrip.vraw", 20, small_chunks());
+    ASSERT_TRUE(RawCaptureReader::probe(path));
+
+    RawCaptureReader reader(path);
+    EXPECT_TRUE(reader.finalized());
+    EXPECT_EQ(reader.fourcc(), static_cast<uint32_t>(V4L2_PIX_FMT_MJPEG));
+    EXPECT_EQ(reader.width(), kWidth);
+    EXPECT_EQ(reader.height(), kHeight);
+    ASSERT_EQ(reader.frame_count(), 20u);
+    // 倒序访问：随机访问不依赖顺序
+    for (unsigned i = 20; i-- > 0;) {
+        const auto f = reader.frame(i);
+        const auto expected = payload(i);
+        ASSERT_EQ(f.bytes, expected.size());
+        EXPECT_EQ(std::memcmp(f.data, expected.data(), f.bytes), 0) << "frame " << i;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(f.data) % kRawRecordAlign, 0u);
+        EXPECT_EQ(f.sequence, 100 + i + (i >= 3 ? 1u : 0u));
+        EXPECT_EQ(f.capture_ns, 1000000000LL + i * 10000000LL);
+    }
+}
+
+TEST(RawCaptureTest, SeeksByCaptureTime) {
+    RawCaptureReader reader(record("raw_seek.vraw", 10));
+    EXPECT_EQ(reader.seek_time(0), 0u);
+    EXPECT_EQ(reader.seek_time(1000000000LL + 30000000LL), 3u);
+    EXPECT_EQ(reader.seek_time(1000000000LL + 30000001LL), 4u);
+    EXPECT_EQ(reader.seek_time(INT64_MAX), 10u);
+}
+
+TEST(RawCaptureTest, RecoversUnfinalizedRecording) {
+    const std::string path = record("raw_recover.vraw", 8);
+    // 模拟写到一半进程退出：没有索引、文件头未完成，最后一帧只写了一半。
+    // 截断位置直接取自索引中最后一帧的负载偏移
+    RawCaptureHeader header{};
+    RawIndexEntry last{};
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        file.seekg(static_cast<std::streamoff>(header.index_offset + 7 * sizeof(RawIndexEntry)));
+        file.read(reinterpret_cast<char*>(&last), sizeof(last));
+        ASSERT_TRUE(file.good());
+        header.flags = 0;
+        header.frame_count = 0;
+        header.index_offset = 0;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    ASSERT_EQ(last.bytes, payload(7).size());
+    ASSERT_EQ(truncate(path.c_str(), static_cast<off_t>(last.offset + last.bytes / 2)), 0);
+
+    RawCaptureReader reader(path);
+    EXPECT_FALSE(reader.finalized());
+    ASSERT_EQ(reader.frame_count(), 7u);
+    for (unsigned i = 0; i < 7; ++i) {
+        const auto expected = payload(i);
+        ASSERT_EQ(reader.frame(i).bytes, expected.size());
+        EXPECT_EQ(std::memcmp(reader.frame(i).data, expected.data(), expected.size()), 0);
+    }
+}
+
+TEST(RawCaptureTest, FallsBackToScanWhenIndexIsCorrupt) {
+    const std::string path = record("raw_bad_index.vraw", 8);
+    {
+        // 索引项指向文件之外：按索引读会越界，必须改为扫描帧记录
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        RawCaptureHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        const auto entry_at = static_cast<std::streamoff>(header.index_offset + 3 * sizeof(RawIndexEntry));
+        RawIndexEntry entry{};
+        file.seekg(entry_at);
+        file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        entry.offset = header.index_offset;
+        entry.bytes = 1u << 30;
+        file.seekp(entry_at);
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        ASSERT_TRUE(file.good());
+    }
+
+    RawCaptureReader reader(path);
+    EXPECT_FALSE(reader.finalized());
+    ASSERT_EQ(reader.frame_count(), 8u);
+    for (unsigned i = 0; i < 8; ++i) {
+        const auto expected = payload(i);
+        ASSERT_EQ(reader.frame(i).bytes, expected.size());
+        EXPECT_EQ(std::memcmp(reader.frame(i).data, expected.data(), expected.size()), 0);
+    }
+}
+
+TEST(RawCaptureTest, DropsInsteadOfBlockingWhenWriterFallsBehind) {
+    const std::string path = ::testing::TempDir() + "raw_drop.vraw";
+    RawCaptureWriter::Options options = small_chunks();
+    options.chunks = 2;
+    RawCaptureWriter writer(path, V4L2_PIX_FMT_MJPEG, kWidth, kHeight, options);
+    unsigned accepted = 0;
+    for (unsigned i = 0; i < 500; ++i) {
+        const auto bytes = payload(i % 16);
+        if (writer.append(view_of(bytes, i, i * 1000LL))) ++accepted;
+    }
+    ASSERT_TRUE(writer.close());
+    const auto stats = writer.stats();
+    EXPECT_EQ(stats.frames, accepted);
+    EXPECT_EQ(stats.frames + stats.dropped, 500u);
+    EXPECT_FALSE(writer.append(view_of(payload(0), 0, 0)));  // 关闭后不再接受
+
+    // 文件中恰好是被接受的那些帧，序号保持递增
+    RawCaptureReader reader(path);
+    ASSERT_EQ(reader.frame_count(), accepted);
+    for (size_t i = 1; i < reader.frame_count(); ++i) {
+        EXPECT_LT(reader.frame(i - 1).sequence, reader.frame(i).sequence);
+    }
+}
+
+TEST(RawCaptureTest, RejectsOtherFiles) {
+    const std::string path = ::testing::TempDir() + "raw_not_a_recording.bin";
+    std::ofstream(path, std::ios::binary) << std::string(8192, 'x');
+    EXPECT_FALSE(RawCaptureReader::probe(path));
+    EXPECT_THROW(RawCaptureReader reader(path), std::runtime_error);
+    EXPECT_THROW(RawCaptureReader reader(path + ".missing"), std::runtime_error);
+}
+
+TEST(RawCaptureTest, ReplaySourceKeepsRecordedSequenceWhenLooping) {
+    FrameSourceOptions options;
+    options.pacing = Pacing::Unpaced;
+    options.frame_limit = 12;  // 循环一遍半
+    ReplaySource source(record("raw_replay.vraw", 8), options);
+    source.set_pixel_format(V4L2_PIX_FMT_YUYV);
+    ASSERT_TRUE(source.initialize());
+    // 格式与分辨率取自录制文件
+    EXPECT_EQ(source.get_pixel_format(), static_cast<uint32_t>(V4L2_PIX_FMT_MJPEG));
+    EXPECT_EQ(source.get_width(), kWidth);
+    EXPECT_EQ(source.get_height(), kHeight);
+    EXPECT_EQ(source.frame_count(), 8u);
+
+    std::vector<uint32_t> sequences;
+    while (auto frame = source.acquire_frame(100)) {
+        const auto expected = payload(static_cast<unsigned>(sequences.size() % 8));
+        ASSERT_EQ(frame->bytesused, expected.size());
+        EXPECT_EQ(std::memcmp(frame->data, expected.data(), expected.size()), 0);
+        sequences.push_back(frame->sequence);
+    }
+    ASSERT_EQ(sequences.size(), 12u);
+    EXPECT_TRUE(source.finished());
+    EXPECT_EQ(sequences[2], 102u);
+    EXPECT_EQ(sequences[3], 104u);  // 录制时的跳号保留下来
+    EXPECT_EQ(sequences[7], 108u);
+    EXPECT_EQ(sequences[8], 109u);  // 第二遍接着往后编号
+}
+
+TEST(RawCaptureTest, ReplaySourcePacesByRecordedTimestamps) {
+    const std::string path = ::testing::TempDir() + "raw_timing.vraw";
+    const int64_t offsets_ms[] = {0, 20, 60, 80};
+    {
+        RawCaptureWriter writer(path, V4L2_PIX_FMT_MJPEG, kWidth, kHeight);
+        for (unsigned i = 0; i < 4; ++i) {
+            const auto bytes = payload(i);
+            writer.append(view_of(bytes, i, 5000000000LL + offsets_ms[i] * 1000000LL));
+        }
+    }
+    FrameSourceOptions options;
+    options.pacing = Pacing::RealTime;
+    options.frame_limit = 5;
+    ReplaySource source(path, options);
+    ASSERT_TRUE(source.initialize());
+
+    std::vector<int64_t> due;
+    while (auto frame = source.acquire_frame(500)) due.push_back(frame->capture_ns);
+    ASSERT_EQ(due.size(), 5u);
+    EXPECT_EQ(source.skipped(), 0u);
+    for (unsigned i = 1; i < 4; ++i) {
+        EXPECT_EQ(due[i] - due[0], offsets_ms[i] * 1000000LL) << "frame " << i;
+    }
+    // 循环回第一帧：最后一帧之后隔一个平均帧间隔（80ms / 3）
+    EXPECT_EQ(due[4] - due[3], 80000000LL / 3);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "queue/FrameRing.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(FrameRingTest, MoveOnlyPushPop) {
+    SpscRing<std::unique_ptr<int>> ring(4);
+    EXPECT_EQ(ring.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(std::make_unique<int>(i)));
+    }
+    EXPECT_FALSE(ring.try_push(std::make_unique<int>(99))) << "队列已满";
+    std::unique_ptr<int> out;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_pop(out));
+        EXPECT_EQ(*out, i);
+    }
+    EXPECT_FALSE(ring.try_pop(out));
+}
+
+TEST(FrameRingTest, DropOldestKeepsNewest) {
+    SpscRing<int> ring(4, OverflowPolicy::DropOldest);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(ring.push(int(i)));
+    }
+    auto stats = ring.stats();
+    EXPECT_EQ(stats.dropped, 6u);
+    EXPECT_EQ(stats.high_water, 4u);
+    int out = -1;
+    for (int expected = 6; expected < 10; ++expected) {
+        ASSERT_TRUE(ring.try_pop(out));
+        EXPECT_EQ(out, expected);
+    }
+}
+
+TEST(FrameRingTest, DropNewestRejectsIncoming) {
+    MpmcRing<int> ring(2, OverflowPolicy::DropNewest);
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push(3));
+    EXPECT_EQ(ring.stats().dropped, 1u);
+    int out = 0;
+    ASSERT_TRUE(ring.try_pop(out));
+    EXPECT_EQ(out, 1);
+}
+
+TEST(FrameRingTest, TimedVariantsTimeOut) {
+    SpscRing<int> ring(2);
+    int out = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    EXPECT_FALSE(ring.pop_for(out, 20ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - t0, 20ms);
+
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_TRUE(ring.push(2));
+    EXPECT_FALSE(ring.push_for(3, 20ms));
+}
+
+TEST(FrameRingTest, CloseWakesBlockedConsumerAfterDrain) {
+    SpscRing<int> ring(4);
+    ASSERT_TRUE(ring.push(7));
+    std::thread closer([&] {
+        std::this_thread::sleep_for(20ms);
+        ring.close();
+    });
+    int out = 0;
+    EXPECT_TRUE(ring.pop(out));   // 关闭前放入的元素仍可取出
+    EXPECT_EQ(out, 7);
+    EXPECT_FALSE(ring.pop(out));  // 关闭后不再阻塞
+    EXPECT_FALSE(ring.push(8));
+    closer.join();
+}
+
+TEST(FrameRingTest, MpmcDeliversEveryItemOnce) {
+    constexpr int kProducers = 4, kConsumers = 4, kPerProducer = 20000;
+    MpmcRing<int> ring(64);
+    std::vector<std::atomic<int>> seen(kProducers * kPerProducer);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ASSERT_TRUE(ring.push(p * kPerProducer + i));
+            }
+        });
+    }
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kConsumers; ++c) {
+        consumers.emplace_back([&] {
+            int v;
+            while (ring.pop(v)) seen[v].fetch_add(1);
+        });
+    }
+    for (auto& t : threads) t.join();
+    ring.close();
+    for (auto& t : consumers) t.join();
+    for (auto& count : seen) EXPECT_EQ(count.load(), 1);
+    EXPECT_EQ(ring.stats().popped, uint64_t(kProducers * kPerProducer));
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "streamer/SegmentRecorder.hpp"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace {
+// 10fps、时间基 1ms：第 n 个包的时间戳为 n * 100，每 10 个包（1 秒）一个关键帧
+constexpr AVRational kTimeBase{1, 1000};
+constexpr int kFrameTicks = 100;
+constexpr int kGop = 10;
+
+std::string fresh_dir(const std::string& name) {
+    const std::string dir = ::testing::TempDir() + "vision_segments_" + name;
+    fs::remove_all(dir);
+    return dir;
+}
+
+// 合成码流的参数：MJPEG 不需要 extradata，MP4 封装器不检查负载内容
+struct TestCodec {
+    AVCodecParameters* par = avcodec_parameters_alloc();
+    TestCodec() {
+        par->codec_type = AVMEDIA_TYPE_VIDEO;
+        par->codec_id = AV_CODEC_ID_MJPEG;
+        par->width = 320;
+        par->height = 240;
+    }
+    ~TestCodec() { avcodec_parameters_free(&par); }
+};
+
+// 把编号 [begin, end) 的合成包送进 tee
+void feed(SegmentRecorder& recorder, int begin, int end) {
+    for (int n = begin; n < end; ++n) {
+        AVPacketPtr pkt(av_packet_alloc());
+        ASSERT_EQ(av_new_packet(pkt.get(), 64), 0);
+        std::memset(pkt->data, n & 0xFF, pkt->size);
+        pkt->pts = pkt->dts = static_cast<int64_t>(n) * kFrameTicks;
+        pkt->duration = kFrameTicks;
+        if (n % kGop == 0) pkt->flags |= AV_PKT_FLAG_KEY;
+        recorder.OnPacket(*pkt);
+    }
+}
+
+// 等录像线程处理完 count 个包，使 Trigger() 落在确定的包上
+void wait_handled(const SegmentRecorder& recorder, uint64_t count) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (recorder.GetStats().queue.written + recorder.GetStats().queue.write_errors < count &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// 读出分段文件中的包：返回包数，first_key 为第一个包是否关键帧
+int count_packets(const std::string& path, bool& first_key) {
+    AVFormatContext* ctx = nullptr;
+    if (avformat_open_input(&ctx, path.c_str(), nullptr, nullptr) < 0) return -1;
+    int count = 0;
+    AVPacket* pkt = av_packet_alloc();
+    while (av_read_frame(ctx, pkt) >= 0) {
+        if (count++ == 0) first_key = pkt->flags & AV_PKT_FLAG_KEY;
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    avformat_close_input(&ctx);
+    return count;
+}
+
+std::vector<std::string> segment_files(const std::string& dir) {
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.path().extension() == ".mp4") files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());  // 文件名以 _000、_001 结尾
+    return files;
+}
+}  // namespace
+
+TEST(SegmentRecorderTest, EventKeepsPreRollAndStopsAfterPostWindow) {
+    const std::string dir = fresh_dir("event");
+    RecorderConfig config;
+    config.output_dir = dir;
+    config.format = RecordFormat::FragmentedMP4;
+    config.pre_event_seconds = 2.0;
+    config.post_event_seconds = 3.0;
+    config.segment_seconds = 2.0;
+    config.queue.max_packets = 1000;  // 测试中不应因背压丢包
+    TestCodec codec;
+    SegmentRecorder recorder(codec.par, kTimeBase, config);
+
+    // 事件前：只缓冲，不写文件。缓冲至少 2 秒且从关键帧开始 → 第 20..49 包
+    feed(recorder, 0, 50);
+    wait_handled(recorder, 50);
+    auto stats = recorder.GetStats();
+    EXPECT_FALSE(stats.recording);
+    EXPECT_EQ(stats.segments, 0u);
+    EXPECT_EQ(stats.packets_written, 0u);
+    EXPECT_EQ(stats.ring_packets, 30u);
+    EXPECT_NEAR(stats.ring_seconds, 2.9, 1e-6);
+
+    // 第 50 包（t=5s，关键帧）处触发：先写出缓冲的 30 个包，第 50 包距分段起点
+    // 已满 segment_seconds，在这个关键帧处切到第二个分段
+    recorder.Trigger();
+    feed(recorder, 50, 51);
+    wait_handled(recorder, 51);
+    stats = recorder.GetStats();
+    EXPECT_TRUE(stats.recording);
+    EXPECT_EQ(stats.events, 1u);
+    EXPECT_EQ(stats.segments, 2u);
+    EXPECT_EQ(stats.packets_written, 31u);
+
+    // 录到 t=8s（第 80 包）为止，第 70 包处再切一次；之后的包只进缓冲
+    feed(recorder, 51, 100);
+    wait_handled(recorder, 100);
+    stats = recorder.GetStats();
+    EXPECT_FALSE(stats.recording);
+    EXPECT_EQ(stats.segments, 3u);
+    EXPECT_EQ(stats.packets_written, 31u + 30u);
+    EXPECT_EQ(stats.write_errors, 0u);
+    EXPECT_EQ(stats.queue.dropped_packets, 0u);
+    recorder.Stop();
+
+    // 每个分段从关键帧开始：[20, 50) [50, 70) [70, 81)
+    const auto files = segment_files(dir);
+    ASSERT_EQ(files.size(), 3u);
+    const int expected[] = {30, 20, 11};
+    for (size_t i = 0; i < files.size(); ++i) {
+        bool first_key = false;
+        EXPECT_EQ(count_packets(files[i], first_key), expected[i]) << files[i];
+        EXPECT_TRUE(first_key) << files[i];
+    }
+    fs::remove_all(dir);
+}
+
+TEST(SegmentRecorderTest, TriggerWithEmptyRingWaitsForKeyframe) {
+    const std::string dir = fresh_dir("cold");
+    RecorderConfig config;
+    config.output_dir = dir;
+    config.format = RecordFormat::FragmentedMP4;
+    config.post_event_seconds = 1.0;
+    config.queue.max_packets = 1000;
+    TestCodec codec;
+    SegmentRecorder recorder(codec.par, kTimeBase, config);
+
+    // 还没有任何包时触发：第 5..9 包不是关键帧，从第 10 包开始写
+    recorder.Trigger();
+    feed(recorder, 5, 30);
+    wait_handled(recorder, 25);
+    auto stats = recorder.GetStats();
+    EXPECT_EQ(stats.segments, 1u);
+    // 截止时间 = 触发包 t=0.5s + 1s，包含第 10..15 包
+    EXPECT_EQ(stats.packets_written, 6u);
+    EXPECT_FALSE(stats.recording);
+    recorder.Stop();
+    fs::remove_all(dir);
+}
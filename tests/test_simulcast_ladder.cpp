@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "streamer/SimulcastStreamer.hpp"
+
+TEST(SimulcastLadderTest, DefaultLadderFollowsSourceAspect) {
+    const auto ladder = SimulcastStreamer::DefaultLadder("out", 1920, 1080);
+    ASSERT_EQ(ladder.size(), 3u);
+    EXPECT_EQ(ladder[0].name, "1080p");
+    EXPECT_EQ(ladder[0].width, 1920);
+    EXPECT_EQ(ladder[1].width, 1280);
+    EXPECT_EQ(ladder[2].width, 640);
+    EXPECT_EQ(ladder[2].height, 360);
+    EXPECT_EQ(ladder[1].url, "out_720p");
+    EXPECT_NO_THROW(SimulcastStreamer::ValidateLadder(1920, 1080, ladder));
+
+    // 4:3 源只保留不高于源的级别，宽度取偶数
+    const auto small = SimulcastStreamer::DefaultLadder("out", 640, 480);
+    ASSERT_EQ(small.size(), 1u);
+    EXPECT_EQ(small[0].name, "360p");
+    EXPECT_EQ(small[0].width, 480);
+    EXPECT_NO_THROW(SimulcastStreamer::ValidateLadder(640, 480, small));
+
+    // 低于所有预设时只输出源分辨率
+    const auto tiny = SimulcastStreamer::DefaultLadder("out", 321, 240);
+    ASSERT_EQ(tiny.size(), 1u);
+    EXPECT_EQ(tiny[0].name, "source");
+    EXPECT_EQ(tiny[0].width, 320);
+    EXPECT_EQ(tiny[0].url, "out");
+}
+
+TEST(SimulcastLadderTest, ValidateRejectsBadLadders) {
+    EXPECT_THROW(SimulcastStreamer::ValidateLadder(1280, 720, {}), std::runtime_error);
+
+    auto ladder = SimulcastStreamer::DefaultLadder("out", 1280, 720);
+    ASSERT_EQ(ladder.size(), 2u);
+    // 高于源分辨率
+    EXPECT_THROW(SimulcastStreamer::ValidateLadder(640, 360, ladder), std::runtime_error);
+
+    // 从低到高排列
+    auto ascending = ladder;
+    std::swap(ascending[0], ascending[1]);
+    EXPECT_THROW(SimulcastStreamer::ValidateLadder(1280, 720, ascending), std::runtime_error);
+
+    // 奇数尺寸
+    auto odd = ladder;
+    odd[1].width = 639;
+    EXPECT_THROW(SimulcastStreamer::ValidateLadder(1280, 720, odd), std::runtime_error);
+
+    // GOP 不是最小 GOP 的整数倍时关键帧无法对齐；整数倍可以
+    auto gop = ladder;
+    gop[0].encoder.gop_size = 90;
+    EXPECT_THROW(SimulcastStreamer::ValidateLadder(1280, 720, gop), std::runtime_error);
+    gop[0].encoder.gop_size = 120;
+    EXPECT_NO_THROW(SimulcastStreamer::ValidateLadder(1280, 720, gop));
+}
+
+TEST(SimulcastLadderTest, KeyframesAlignOnSourceFrameIndex) {
+    // 三级 GOP 分别为 30 / 60 / 30；源帧 90..99 为静止画面（重复帧），
+    // 第三级在第 60 帧缩放失败，只收到一个重复帧
+    constexpr uint64_t kFrames = 200;
+    SimulcastStreamer::KeyframeSchedule top(30), mid(60), low(30);
+    std::vector<uint64_t> top_keys, mid_keys, low_keys;
+    for (uint64_t i = 0; i < kFrames; ++i) {
+        const bool repeat = i >= 90 && i < 100;
+        if (top.next(i, !repeat)) top_keys.push_back(i);
+        if (mid.next(i, !repeat)) mid_keys.push_back(i);
+        if (low.next(i, !repeat && i != 60)) low_keys.push_back(i);
+    }
+    // GOP 边界落在重复帧上时顺延到下一个新帧，之后仍按源帧序号对齐
+    EXPECT_EQ(top_keys, (std::vector<uint64_t>{0, 30, 60, 100, 120, 150, 180}));
+    EXPECT_EQ(mid_keys, (std::vector<uint64_t>{0, 60, 120, 180}));
+    // 缺帧只影响当前 GOP，下一个边界与其余各级重新对齐
+    EXPECT_EQ(low_keys, (std::vector<uint64_t>{0, 30, 61, 100, 120, 150, 180}));
+}
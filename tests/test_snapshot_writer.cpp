@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+#include <sys/resource.h>
+
+#include "processor/SnapshotWriter.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+// 每个测试一个干净的输出目录
+std::string fresh_dir(const std::string& name) {
+    const std::string dir = ::testing::TempDir() + "vision_snapshots_" + name;
+    fs::remove_all(dir);
+    return dir;
+}
+
+// 左半红、右半蓝的 RGB 帧，用来检查通道顺序
+cv::Mat test_frame() {
+    cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(255, 0, 0));
+    frame(cv::Rect(32, 0, 32, 48)).setTo(cv::Scalar(0, 0, 255));
+    return frame;
+}
+}  // namespace
+
+TEST(SnapshotWriterTest, WritesRawFramesInOrder) {
+    const std::string dir = fresh_dir("raw");
+    SnapshotWriter::Options options;
+    options.format = SnapshotFormat::Raw;
+    SnapshotWriter writer(dir, options);  // 目录由构造函数创建
+
+    std::vector<std::future<std::string>> results;
+    cv::Mat frame = test_frame();
+    for (int i = 0; i < 3; ++i) {
+        frame.at<cv::Vec3b>(0, 0)[1] = static_cast<uint8_t>(i);
+        results.push_back(writer.submit(frame));
+    }
+    // 提交时已拷贝，之后修改调用方的帧不影响写出的内容
+    frame.setTo(cv::Scalar(7, 7, 7));
+
+    for (int i = 0; i < 3; ++i) {
+        const std::string path = results[i].get();
+        ASSERT_EQ(path, dir + "/frame_000" + std::to_string(i) + "_64x48_rgb24.raw");
+        std::ifstream in(path, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                      std::istreambuf_iterator<char>());
+        ASSERT_EQ(bytes.size(), 64u * 48u * 3u);
+        EXPECT_EQ(static_cast<uint8_t>(bytes[0]), 255);
+        EXPECT_EQ(static_cast<uint8_t>(bytes[1]), i);
+    }
+    writer.flush();
+    const auto stats = writer.stats();
+    EXPECT_EQ(stats.submitted, 3u);
+    EXPECT_EQ(stats.written, 3u);
+    EXPECT_EQ(stats.bytes_written, 3u * 64u * 48u * 3u);
+    EXPECT_GE(stats.fsyncs, 1u);
+}
+
+TEST(SnapshotWriterTest, EncodesPngAndJpegAsRgb) {
+    for (const auto format : {SnapshotFormat::PNG, SnapshotFormat::JPEG}) {
+        const std::string dir = fresh_dir(format == SnapshotFormat::PNG ? "png" : "jpeg");
+        SnapshotWriter::Options options;
+        options.format = format;
+        options.jpeg_quality = 95;
+        SnapshotWriter writer(dir, options);
+        const std::string path = writer.submit(test_frame()).get();
+        ASSERT_FALSE(path.empty());
+        // imread 返回 BGR：左半的红色应在下标 2 的通道，说明编码前做了 RGB→BGR
+        const cv::Mat read = cv::imread(path);
+        ASSERT_EQ(read.size(), cv::Size(64, 48));
+        EXPECT_GT(read.at<cv::Vec3b>(24, 8)[2], 200);
+        EXPECT_LT(read.at<cv::Vec3b>(24, 8)[0], 50);
+        EXPECT_GT(read.at<cv::Vec3b>(24, 56)[0], 200);
+        EXPECT_GT(writer.stats().encode_ms_avg, 0.0);
+    }
+}
+
+TEST(SnapshotWriterTest, DropsWhenQueueIsFull) {
+    const std::string dir = fresh_dir("drop");
+    SnapshotWriter::Options options;
+    options.format = SnapshotFormat::Raw;
+    options.workers = 1;
+    options.queue_capacity = 1;
+    SnapshotWriter writer(dir, options);
+
+    // 回调中阻塞唯一的工作线程，后续提交只能排队或被放弃
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> callbacks{0};
+    auto first = writer.submit(test_frame(), [&](const std::string&) {
+        released.wait();
+        ++callbacks;
+    });
+    while (writer.stats().queue_depth != 0) std::this_thread::yield();
+    auto queued = writer.submit(test_frame(), [&](const std::string&) { ++callbacks; });
+    auto dropped = writer.submit(test_frame(), [&](const std::string& path) {
+        EXPECT_TRUE(path.empty());
+        ++callbacks;
+    });
+    EXPECT_EQ(dropped.get(), "");
+    release.set_value();
+    EXPECT_FALSE(first.get().empty());
+    EXPECT_FALSE(queued.get().empty());
+    writer.flush();
+    EXPECT_EQ(callbacks, 3);
+    const auto stats = writer.stats();
+    EXPECT_EQ(stats.dropped, 1u);
+    EXPECT_EQ(stats.written, 2u);
+    EXPECT_GT(stats.queue_wait_ms_max, 0.0);
+}
+
+TEST(SnapshotWriterTest, UnbatchedSyncDoesNotHoldFiles) {
+    // 文件描述符上限压低到 64：未同步的快照如果保持打开，远不到 300 张就会 EMFILE
+    rlimit saved{};
+    ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit low = saved;
+    low.rlim_cur = 64;
+    ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &low), 0);
+    {
+        SnapshotWriter::Options options;
+        options.format = SnapshotFormat::Raw;
+        options.block_when_full = true;
+        options.fsync_batch = 0;  // 只在 flush 时同步
+        SnapshotWriter writer(fresh_dir("unbatched"), options);
+        const cv::Mat frame = test_frame();
+        for (int i = 0; i < 300; ++i) writer.submit(frame);
+        writer.flush();
+        const auto stats = writer.stats();
+        EXPECT_EQ(stats.written, 300u);
+        EXPECT_EQ(stats.failed, 0u);
+        EXPECT_EQ(stats.fsyncs, 1u);
+    }
+    setrlimit(RLIMIT_NOFILE, &saved);
+}
+
+TEST(SnapshotWriterTest, RejectsUnsupportedFrames) {
+    SnapshotWriter writer(fresh_dir("reject"));
+    EXPECT_EQ(writer.submit(cv::Mat()).get(), "");
+    EXPECT_EQ(writer.submit(cv::Mat(8, 8, CV_32FC1, cv::Scalar(0))).get(), "");
+    EXPECT_EQ(writer.stats().written, 0u);
+}
+
+TEST(SnapshotWriterTest, ParsesFormatNames) {
+    SnapshotFormat format;
+    ASSERT_TRUE(parse_snapshot_format("jpg", format));
+    EXPECT_EQ(format, SnapshotFormat::JPEG);
+    ASSERT_TRUE(parse_snapshot_format("raw", format));
+    EXPECT_EQ(format, SnapshotFormat::Raw);
+    EXPECT_FALSE(parse_snapshot_format("bmp", format));
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "processor/TileScheduler.hpp"
+
+// 每一行恰好属于一个条带，halo 裁剪到图像范围内
+TEST(TileSchedulerTest, CoversEveryRowOnce) {
+    TileScheduler scheduler(4);
+    for (int height : {1, 3, 7, 720, 1081}) {
+        std::vector<std::atomic<int>> hits(height);
+        std::atomic<int> tiles{0};
+        scheduler.run(height, 2, [&](const TileScheduler::Tile& tile) {
+            EXPECT_EQ(tile.halo_begin, std::max(0, tile.row_begin - 2));
+            EXPECT_EQ(tile.halo_end, std::min(height, tile.row_end + 2));
+            for (int r = tile.row_begin; r < tile.row_end; ++r) hits[r]++;
+            tiles++;
+        }, 6);
+        EXPECT_EQ(tiles.load(), std::min(height, 6));
+        for (int r = 0; r < height; ++r) EXPECT_EQ(hits[r].load(), 1) << "row " << r;
+    }
+}
+
+// 线程池常驻：多轮 run() 之间复用同一批线程，且异常能传回调用方
+TEST(TileSchedulerTest, RepeatedRunsAndExceptions) {
+    TileScheduler scheduler(3);
+    EXPECT_EQ(scheduler.thread_count(), 3u);
+    for (int round = 0; round < 200; ++round) {
+        std::atomic<int> sum{0};
+        scheduler.run(64, 0, [&](const TileScheduler::Tile& tile) {
+            sum += tile.row_end - tile.row_begin;
+        });
+        ASSERT_EQ(sum.load(), 64);
+    }
+    EXPECT_THROW(scheduler.run(16, 0, [](const TileScheduler::Tile& tile) {
+        if (tile.index == 1) throw std::runtime_error("tile failed");
+    }), std::runtime_error);
+    // 异常之后调度器仍然可用
+    std::atomic<int> rows{0};
+    scheduler.run(16, 0, [&](const TileScheduler::Tile& tile) {
+        rows += tile.row_end - tile.row_begin;
+    });
+    EXPECT_EQ(rows.load(), 16);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pipeline/MetricsExporter.hpp"
+#include "pipeline/Tracer.hpp"
+
+namespace {
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// 每个测试从干净、关闭的状态开始
+class TracerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Tracer::instance().disable();
+        Tracer::instance().clear();
+    }
+    void TearDown() override {
+        Tracer::instance().disable();
+        Tracer::instance().clear();
+    }
+};
+}  // namespace
+
+TEST_F(TracerTest, DisabledSpansRecordNothing) {
+    { TraceSpan span("decode", 1); }
+    EXPECT_TRUE(Tracer::instance().snapshot().empty());
+}
+
+TEST_F(TracerTest, RecordsSpansPerThread) {
+    Tracer::instance().enable();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([t] {
+            Tracer::set_thread_name("worker" + std::to_string(t));
+            for (uint64_t i = 0; i < 100; ++i) TraceSpan span("encode", i);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto events = Tracer::instance().snapshot();
+    ASSERT_EQ(events.size(), 300u);
+    for (const auto& e : events) {
+        EXPECT_STREQ(e.name, "encode");
+        EXPECT_LE(e.begin_ns, e.end_ns);
+        EXPECT_GT(e.tid, 0u);
+    }
+}
+
+TEST_F(TracerTest, RingKeepsNewestEvents) {
+    Tracer::instance().enable(16);
+    // 新线程才会按新的容量分配缓冲区
+    std::thread([] {
+        for (uint64_t i = 0; i < 100; ++i) Tracer::instance().record("mux", i, 0, 1);
+    }).join();
+
+    std::vector<uint64_t> ids;
+    for (const auto& e : Tracer::instance().snapshot()) {
+        if (std::string(e.name) == "mux") ids.push_back(e.id);
+    }
+    ASSERT_EQ(ids.size(), 16u);
+    EXPECT_EQ(ids.front(), 84u);
+    EXPECT_EQ(ids.back(), 99u);
+}
+
+TEST_F(TracerTest, SnapshotWhileRecording) {
+    Tracer::instance().enable(64);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        uint64_t i = 0;
+        while (!done) Tracer::instance().record("algorithm", i++, 10, 20);
+    });
+    for (int i = 0; i < 200; ++i) {
+        for (const auto& e : Tracer::instance().snapshot()) {
+            // 被覆盖的槽位不会以半条事件的形式出现
+            if (std::string(e.name) == "algorithm") {
+                EXPECT_EQ(e.begin_ns, 10);
+                EXPECT_EQ(e.end_ns, 20);
+            }
+        }
+    }
+    done = true;
+    writer.join();
+}
+
+TEST_F(TracerTest, WritesChromeTraceJson) {
+    Tracer::instance().enable();
+    std::thread([] {
+        Tracer::set_thread_name("capture");
+        Tracer::instance().record("capture", 7, 1000000, 3000000);
+    }).join();
+
+    const std::string path = ::testing::TempDir() + "vision_trace.json";
+    ASSERT_TRUE(Tracer::instance().write_chrome_trace(path));
+    const std::string json = read_file(path);
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"thread_name\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"capture\""), std::string::npos);
+    EXPECT_NE(json.find("\"dur\":2000.000"), std::string::npos);
+    EXPECT_NE(json.find("\"frame\":7"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(MetricsTextTest, PrometheusTextFormat) {
+    MetricsText text;
+    text.counter("vision_frames_total", "Frames processed", 42, "stage=\"encode\"");
+    text.counter("vision_frames_total", "Frames processed", 40, "stage=\"mux\"");
+    text.gauge("vision_fps", "Output frame rate", 29.5);
+    LatencyWindow window(8);
+    for (int i = 1; i <= 4; ++i) window.add(i);
+    text.summary("vision_stage_ms", "Stage latency", window.summary(), "stage=\"encode\"");
+
+    const std::string& out = text.str();
+    // HELP/TYPE 每个指标只出现一次
+    EXPECT_EQ(out.find("# TYPE vision_frames_total counter"),
+              out.rfind("# TYPE vision_frames_total counter"));
+    EXPECT_NE(out.find("vision_frames_total{stage=\"encode\"} 42\n"), std::string::npos);
+    EXPECT_NE(out.find("vision_frames_total{stage=\"mux\"} 40\n"), std::string::npos);
+    EXPECT_NE(out.find("vision_fps 29.5\n"), std::string::npos);
+    EXPECT_NE(out.find("vision_stage_ms{stage=\"encode\",quantile=\"0.5\"} 2\n"), std::string::npos);
+    EXPECT_NE(out.find("vision_stage_ms_sum{stage=\"encode\"} 10\n"), std::string::npos);
+    EXPECT_NE(out.find("vision_stage_ms_count{stage=\"encode\"} 4\n"), std::string::npos);
+}
+
+TEST(MetricsExporterTest, WritesTextFile) {
+    const std::string path = ::testing::TempDir() + "vision_metrics.prom";
+    {
+        MetricsExporter::Options options;
+        options.file_path = path;
+        options.interval_s = 0.05;
+        MetricsExporter exporter([](MetricsText& t) { t.gauge("vision_up", "Exporter alive", 1); },
+                                 options);
+        EXPECT_TRUE(exporter.write_file());
+        EXPECT_EQ(read_file(path), exporter.render());
+    }
+    EXPECT_NE(read_file(path).find("vision_up 1\n"), std::string::npos);
+    std::remove(path.c_str());
+}
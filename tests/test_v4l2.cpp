@@ -1,6 +1,29 @@
-#include "vision/V4L2Capture.hpp"
+#include "capture/V4L2Capture.hpp"
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// 查找 vivid 虚拟摄像头（modprobe vivid），找不到返回空字符串
+static std::string find_vivid_device() {
+    for (int i = 0; i < 64; ++i) {
+        std::string path = "/dev/video" + std::to_string(i);
+        int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd < 0) continue;
+        v4l2_capability cap{};
+        bool is_vivid = ioctl(fd, VIDIOC_QUERYCAP, &cap) == 0 &&
+                        std::strcmp(reinterpret_cast<const char*>(cap.driver), "vivid") == 0 &&
+                        (cap.device_caps & V4L2_CAP_VIDEO_CAPTURE);
+        close(fd);
+        if (is_vivid) return path;
+    }
+    return "";
+}
+
 class V4L2Test : public ::testing::Test {
 protected:
     const std::string TEST_DEVICE = "/dev/video0";
@@ -31,4 +54,80 @@ TEST_F(V4L2Test, CapturesFramesConsistently) {
         EXPECT_FALSE(frameBuffer.empty())
             << "Frame " << i << " is empty";
     }
-}
\ No newline at end of file
+}
+
+TEST(V4L2LeaseTest, LeasesRequeueOnRelease) {
+    const std::string device = find_vivid_device();
+    if (device.empty()) {
+        GTEST_SKIP() << "未找到 vivid 虚拟设备，请先 modprobe vivid";
+    }
+    V4L2Capture capture(device);
+    capture.set_buffer_count(6);
+    ASSERT_TRUE(capture.initialize(640, 480));
+    ASSERT_GE(capture.get_buffer_count(), 2u);
+
+    FrameLease first = capture.acquire_frame();
+    ASSERT_TRUE(first) << "获取第一帧租约失败";
+    EXPECT_GT(first->bytesused, 0u);
+    EXPECT_EQ(capture.get_leased_count(), 1u);
+
+    // 持有第一帧的同时仍可继续取帧，序号应递增
+    FrameLease second = capture.acquire_frame();
+    ASSERT_TRUE(second) << "获取第二帧租约失败";
+    EXPECT_GT(second->sequence, first->sequence);
+    EXPECT_NE(second->index, first->index);
+    EXPECT_EQ(capture.get_leased_count(), 2u);
+
+    // 多个持有者共享同一租约，最后一个释放时才归还
+    FrameLease shared = first;
+    first.reset();
+    EXPECT_EQ(capture.get_leased_count(), 2u);
+    shared.reset();
+    second.reset();
+    EXPECT_EQ(capture.get_leased_count(), 0u);
+}
+
+TEST(V4L2LatestFrameTest, DropsStaleBuffers) {
+    const std::string device = find_vivid_device();
+    if (device.empty()) {
+        GTEST_SKIP() << "未找到 vivid 虚拟设备，请先 modprobe vivid";
+    }
+    V4L2Capture capture(device);
+    capture.set_buffer_count(4);
+    ASSERT_TRUE(capture.set_latest_frame_mode(true));
+    ASSERT_TRUE(capture.initialize(640, 480));
+
+    FrameLease first = capture.acquire_frame();
+    ASSERT_TRUE(first);
+    const uint32_t first_sequence = first->sequence;
+    first.reset();
+    // 消费者停顿约 5 帧，驱动把空闲缓冲区都填满
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    FrameLease latest = capture.acquire_frame();
+    ASSERT_TRUE(latest);
+    EXPECT_GT(capture.stale_dropped(), 0u);
+    EXPECT_GT(latest->sequence, first_sequence + capture.stale_dropped());
+    // 旧缓冲区已全部还给驱动，只借出了最新的一帧
+    EXPECT_EQ(capture.get_leased_count(), 1u);
+}
+
+TEST(V4L2UserPtrTest, DriverFillsCallerOwnedPool) {
+    const std::string device = find_vivid_device();
+    if (device.empty()) {
+        GTEST_SKIP() << "未找到 vivid 虚拟设备，请先 modprobe vivid";
+    }
+    V4L2Capture capture(device);
+    // 640x480 YUYV 一帧 614400 字节
+    auto pool = std::make_shared<UserBufferPool>(4, 640 * 480 * 2);
+    capture.set_memory_mode(V4L2Capture::MemoryMode::USERPTR, pool);
+    ASSERT_TRUE(capture.initialize(640, 480));
+    ASSERT_EQ(capture.get_memory_mode(), V4L2Capture::MemoryMode::USERPTR);
+
+    for (int i = 0; i < 5; ++i) {
+        FrameLease frame = capture.acquire_frame();
+        ASSERT_TRUE(frame) << "Failed to capture frame " << i;
+        // 数据必须落在调用方的缓冲池里，而不是驱动内存
+        EXPECT_EQ(frame->data, pool->data(frame->index));
+        EXPECT_EQ(frame->bytesused, 640u * 480u * 2u);
+    }
+}
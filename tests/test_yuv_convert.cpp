@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "processor/YuvConvert.hpp"
+
+namespace {
+struct Yuv420pBuffer {
+    Yuv420pBuffer(int w, int h)
+        : y(static_cast<size_t>(w) * h), u(static_cast<size_t>(w / 2) * ((h + 1) / 2)),
+          v(u.size()) {
+        planes = {y.data(), w, u.data(), w / 2, v.data(), w / 2};
+    }
+    std::vector<uint8_t> y, u, v;
+    Yuv420pPlanes planes;
+};
+}  // namespace
+
+// 各 SIMD 实现必须与标量参考实现逐字节一致，包括非 32/64 对齐的宽度和奇数高度
+TEST(YuvConvertTest, SimdMatchesScalarReference) {
+    std::mt19937 rng(42);
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}, {2, 1},
+                            {30, 7},    {94, 33},    {130, 5},     {322, 241}};
+    for (auto [w, h] : sizes) {
+        std::vector<uint8_t> yuyv(static_cast<size_t>(w) * h * 2);
+        for (auto& b : yuyv) b = static_cast<uint8_t>(rng());
+
+        Yuv420pBuffer ref(w, h);
+        yuyv_to_yuv420p_scalar(yuyv.data(), w * 2, w, h, ref.planes);
+
+        for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+            if (level > detect_simd_level()) continue;
+            Yuv420pBuffer out(w, h);
+            yuyv_to_yuv420p(yuyv.data(), w * 2, w, h, out.planes, level);
+            EXPECT_EQ(out.y, ref.y) << simd_level_name(level) << " " << w << "x" << h;
+            EXPECT_EQ(out.u, ref.u) << simd_level_name(level) << " " << w << "x" << h;
+            EXPECT_EQ(out.v, ref.v) << simd_level_name(level) << " " << w << "x" << h;
+        }
+    }
+}
+
+TEST(YuvConvertTest, ScalarAveragesChromaRows) {
+    // 2x2 像素：两行 YUYV
+    const uint8_t yuyv[] = {10, 100, 20, 200,
+                            30, 101, 40, 255};
+    Yuv420pBuffer out(2, 2);
+    yuyv_to_yuv420p_scalar(yuyv, 4, 2, 2, out.planes);
+    EXPECT_EQ(out.y, (std::vector<uint8_t>{10, 20, 30, 40}));
+    EXPECT_EQ(out.u[0], 101);  // (100 + 101 + 1) >> 1
+    EXPECT_EQ(out.v[0], 228);  // (200 + 255 + 1) >> 1
+}